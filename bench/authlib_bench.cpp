@@ -0,0 +1,714 @@
+/**
+ * authlib_bench: Google Benchmark microbenchmarks
+ *
+ *   authlib_bench --benchmark_out=authlib_bench.json --benchmark_out_format=json
+ *
+ * Database benchmarks take the storage as their first argument (0 =
+ * in-memory SQLite, 1 = a WAL file in the working directory) and run at
+ * 1, 2, 4 and 8 threads against one shared Database seeded with
+ * SEED_USERS users, the way an AuthService is shared by server threads.
+ */
+
+#include <authlib/config/Config.h>
+#include <authlib/config/ConfigStore.h>
+#include <authlib/database/Database.h>
+#include <authlib/models/Session.h>
+#include <authlib/models/TokenBlacklist.h>
+#include <authlib/models/User.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/services/AuthService.h>
+#include <authlib/session/SessionStore.h>
+#include <authlib/tenant/TenantRegistry.h>
+#include <authlib/utils/BreachedPasswordIndex.h>
+#include <authlib/utils/JWTHandler.h>
+#include <authlib/utils/PasswordHandler.h>
+#include <authlib/utils/SecureRandom.h>
+#include <authlib/utils/Validators.h>
+#include <authlib/utils/exceptions.h>
+#include <benchmark/benchmark.h>
+#ifdef AUTHLIB_WITH_COROUTINES
+#include <authlib/services/AsyncAuthService.h>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#endif
+#ifdef AUTHLIB_WITH_SERVER
+#include <authlib/sidecar/VerifyClient.h>
+#include <authlib/sidecar/VerifySidecar.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace authlib;
+
+namespace {
+
+constexpr uint32_t SEED_USERS = 10000;
+constexpr uint32_t SEED_TOKENS = 10000;
+const char* const BENCH_DB_PATH = "./authlib_bench.db";
+
+std::string emailFor(uint64_t n) {
+    return "bench" + std::to_string(n) + "@example.com";
+}
+
+User makeUser(const std::string& email) {
+    User user;
+    user.email = email;
+    user.passwordHash = "$pbkdf2-sha256$i=10000$c2FsdHNhbHRzYWx0c2FsdA$aGFzaGhhc2hoYXNoaGFzaGhhc2hoYXNoaGFzaGhhc2g";
+    user.firstName = "Bench";
+    user.lastName = "User";
+    user.isActive = true;
+    return user;
+}
+
+// Shared across the threads of one benchmark run; built in Setup, which
+// runs once before the threads start, and dropped in Teardown
+struct DatabaseFixture {
+    std::unique_ptr<Database> database;
+    std::vector<uint32_t> userIds;
+    std::vector<std::string> emails; // canonical already, as findUserByEmail wants
+    std::vector<std::string> tokens;
+    std::atomic<uint64_t> next{0};   // unique suffix for inserted emails and tokens
+};
+
+DatabaseFixture fixture;
+
+void removeBenchFiles() {
+    for (const char* suffix : {"", "-wal", "-shm"}) {
+        std::remove((std::string(BENCH_DB_PATH) + suffix).c_str());
+    }
+}
+
+void setUpDatabase(const benchmark::State& state) {
+    removeBenchFiles();
+    const bool onDisk = state.range(0) == 1;
+    fixture.database = std::make_unique<Database>(onDisk ? std::string("sqlite:///") + BENCH_DB_PATH : "sqlite://");
+    fixture.database->initialize();
+
+    fixture.userIds.clear();
+    fixture.emails.clear();
+    for (uint32_t i = 0; i < SEED_USERS; ++i) {
+        fixture.emails.push_back(emailFor(i));
+        fixture.userIds.push_back(fixture.database->insertUser(makeUser(fixture.emails.back())).id);
+    }
+    fixture.next = SEED_USERS;
+
+    fixture.tokens.clear();
+    const std::time_t expires = std::time(nullptr) + 3600;
+    for (uint32_t i = 0; i < SEED_TOKENS; ++i) {
+        TokenBlacklist entry;
+        entry.token = SecureRandom::token(48);
+        entry.userId = fixture.userIds[i % SEED_USERS];
+        entry.expiresAt = expires;
+        fixture.database->blacklistToken(entry);
+        fixture.tokens.push_back(entry.token);
+    }
+}
+
+void tearDownDatabase(const benchmark::State&) {
+    fixture.database.reset();
+    fixture.userIds.clear();
+    fixture.emails.clear();
+    fixture.tokens.clear();
+    removeBenchFiles();
+}
+
+// Storage argument, 1..8 threads, wall-clock time so threaded runs report
+// throughput of the whole process
+void databaseArgs(benchmark::internal::Benchmark* bench) {
+    bench->ArgName("disk")->Arg(0)->Arg(1)
+        ->ThreadRange(1, 8)->UseRealTime()
+        ->Setup(setUpDatabase)->Teardown(tearDownDatabase);
+}
+
+const char* const BENCH_SHARDED_BASE = "./authlib_bench_sharded";
+
+std::unique_ptr<Database> shardedDatabase;
+
+void removeShardedBenchFiles(uint32_t shards) {
+    for (uint32_t i = 0; i < shards; ++i) {
+        const std::string path = std::string(BENCH_SHARDED_BASE)
+            + (shards == 1 ? ".db" : ".shard" + std::to_string(i) + ".db");
+        for (const char* suffix : {"", "-wal", "-shm"}) {
+            std::remove((path + suffix).c_str());
+        }
+    }
+}
+
+// Argument: DATABASE_SHARDS, always on disk since the point is separate
+// WAL files and write locks
+void setUpShardedDatabase(const benchmark::State& state) {
+    const uint32_t shards = static_cast<uint32_t>(state.range(0));
+    removeShardedBenchFiles(shards);
+    shardedDatabase = std::make_unique<Database>(std::string("sqlite:///") + BENCH_SHARDED_BASE + ".db", 5000, shards);
+    shardedDatabase->initialize();
+}
+
+void tearDownShardedDatabase(const benchmark::State& state) {
+    shardedDatabase.reset();
+    removeShardedBenchFiles(static_cast<uint32_t>(state.range(0)));
+}
+
+// Per-thread cursor over the seeded rows, offset so threads spread out
+size_t startIndex(const benchmark::State& state, size_t size) {
+    return (static_cast<size_t>(state.thread_index()) * 7919) % size;
+}
+
+Config benchConfig() {
+    Config config;
+    config.JWT_SECRET_KEY = "bench-secret-key-bench-secret-key";
+    return config;
+}
+
+// One AuthService shared by every thread, as server workers share it, with
+// a single registered user and an access token for it
+struct AuthFixture {
+    std::unique_ptr<Database> database;
+    std::unique_ptr<AuthService> auth;
+    std::string accessToken;
+};
+
+AuthFixture authFixture;
+
+void setUpAuth(const benchmark::State&) {
+    removeBenchFiles();
+    authFixture.database = std::make_unique<Database>(std::string("sqlite:///") + BENCH_DB_PATH);
+    authFixture.database->initialize();
+    authFixture.auth = std::make_unique<AuthService>(*authFixture.database, benchConfig());
+    authFixture.accessToken = authFixture.auth->registerUser({"login@example.com", "SecurePass123!", "Bench", "User"}).accessToken;
+}
+
+void tearDownAuth(const benchmark::State&) {
+    authFixture.auth.reset();
+    authFixture.database.reset();
+    removeBenchFiles();
+}
+
+#ifdef AUTHLIB_WITH_COROUTINES
+std::unique_ptr<AsyncAuthService> asyncAuth;
+
+void setUpAsyncAuth(const benchmark::State& state) {
+    setUpAuth(state);
+    asyncAuth = std::make_unique<AsyncAuthService>(*authFixture.database, benchConfig());
+}
+
+void tearDownAsyncAuth(const benchmark::State& state) {
+    asyncAuth.reset();
+    tearDownAuth(state);
+}
+#endif
+
+#ifdef AUTHLIB_WITH_SERVER
+const char* const BENCH_SOCKET_PATH = "./authlib_bench_verify.sock";
+
+std::unique_ptr<VerifySidecar> verifySidecar;
+
+void setUpSidecar(const benchmark::State& state) {
+    setUpAuth(state);
+    VerifySidecarOptions options;
+    options.socketPath = BENCH_SOCKET_PATH;
+    verifySidecar = std::make_unique<VerifySidecar>(
+        *authFixture.database,
+        std::make_shared<ConfigStore>(std::make_shared<const Config>(benchConfig())),
+        options
+    );
+    verifySidecar->start();
+}
+
+void tearDownSidecar(const benchmark::State& state) {
+    verifySidecar.reset();
+    tearDownAuth(state);
+}
+#endif
+
+constexpr uint32_t SEED_SESSIONS = 200000;
+
+// Memory-only store with no sweeper thread, seeded with SEED_SESSIONS
+struct SessionFixture {
+    std::unique_ptr<SessionStore> store;
+    std::vector<std::string> ids;
+};
+
+SessionFixture sessionFixture;
+
+void setUpSessions(const benchmark::State&) {
+    SessionStoreOptions options;
+    options.sweepIntervalMs = 0;
+    sessionFixture.store = std::make_unique<SessionStore>(options);
+    sessionFixture.ids.clear();
+    for (uint32_t i = 0; i < SEED_SESSIONS; ++i) {
+        sessionFixture.ids.push_back(sessionFixture.store->create(i));
+    }
+}
+
+void tearDownSessions(const benchmark::State&) {
+    sessionFixture.store.reset();
+    sessionFixture.ids.clear();
+}
+
+// The token is signed with the tenant's derived key directly, so no
+// tenant database is ever opened
+struct TenantFixture {
+    std::unique_ptr<TenantRegistry> registry;
+    std::string token;
+};
+
+TenantFixture tenantFixture;
+
+void setUpTenants(const benchmark::State&) {
+    auto base = std::make_shared<Config>(benchConfig());
+    base->DATABASE_URL = "sqlite:///./authlib_bench_tenant_{tenant}.db";
+    TenantResolver resolver = TenantRegistry::templateResolver(base);
+    JWTHandler issuer(std::make_shared<ConfigStore>(resolver("acme")), "acme");
+    tenantFixture.token = issuer.createAccessToken(42, "bench@example.com");
+    tenantFixture.registry = std::make_unique<TenantRegistry>(resolver);
+}
+
+void tearDownTenants(const benchmark::State&) {
+    tenantFixture.registry.reset();
+}
+
+const char* const BENCH_BREACHED_DUMP = "./authlib_bench_breached.txt";
+const char* const BENCH_BREACHED_INDEX = "./authlib_bench_breached.bpi";
+
+std::unique_ptr<BreachedPasswordIndex> breachedIndex;
+
+// 200k random SHA-1s plus "password", so buckets need real searching;
+// argument: bloom filter bits per entry
+void setUpBreachedIndex(const benchmark::State& state) {
+    std::vector<std::string> lines = {"5BAA61E4C9B93F3F0682250B6CF8331B7EE68FD8:9545824"};
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 200000; ++i) {
+        char hex[41];
+        std::snprintf(hex, sizeof(hex), "%016llX%016llX%08X",
+            static_cast<unsigned long long>(rng()), static_cast<unsigned long long>(rng()),
+            static_cast<unsigned>(rng()));
+        lines.push_back(std::string(hex) + ":1");
+    }
+    std::sort(lines.begin(), lines.end());
+    std::FILE* dump = std::fopen(BENCH_BREACHED_DUMP, "w");
+    for (const auto& line : lines) {
+        std::fprintf(dump, "%s\n", line.c_str());
+    }
+    std::fclose(dump);
+
+    BreachedPasswordIndex::build(BENCH_BREACHED_DUMP, BENCH_BREACHED_INDEX, static_cast<uint32_t>(state.range(0)));
+    breachedIndex = std::make_unique<BreachedPasswordIndex>(BENCH_BREACHED_INDEX);
+}
+
+void tearDownBreachedIndex(const benchmark::State&) {
+    breachedIndex.reset();
+    std::remove(BENCH_BREACHED_DUMP);
+    std::remove(BENCH_BREACHED_INDEX);
+}
+
+} // namespace
+
+// ==================== Validators ====================
+
+static void BM_EmailValidatorValid(benchmark::State& state) {
+    const std::string email = "first.last+tag@sub.example.com";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(EmailValidator::isValid(email));
+    }
+}
+BENCHMARK(BM_EmailValidatorValid);
+
+static void BM_EmailValidatorInvalid(benchmark::State& state) {
+    const std::string email = "first.last@@example";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(EmailValidator::isValid(email));
+    }
+}
+BENCHMARK(BM_EmailValidatorInvalid);
+
+static void BM_PasswordValidator(benchmark::State& state) {
+    const std::string password = "SecurePass123!";
+    for (auto _ : state) {
+        PasswordValidator::validate(password);
+    }
+}
+BENCHMARK(BM_PasswordValidator);
+
+// ==================== Breached passwords ====================
+
+// Alternates a breached and a clean password
+static void BM_BreachedPasswordContains(benchmark::State& state) {
+    bool breached = true;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(breachedIndex->contains(breached ? "password" : "SecurePass123!"));
+        breached = !breached;
+    }
+}
+BENCHMARK(BM_BreachedPasswordContains)->ArgName("bloom_bits")->Arg(0)->Arg(10)
+    ->Setup(setUpBreachedIndex)->Teardown(tearDownBreachedIndex);
+
+// ==================== Password hashing ====================
+
+// Argument: PBKDF2 iterations
+static void BM_PasswordHash(benchmark::State& state) {
+    PasswordHandler handler(static_cast<uint32_t>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.hashPassword("SecurePass123!"));
+    }
+}
+BENCHMARK(BM_PasswordHash)->ArgName("iterations")->Arg(1000)->Arg(10000)->Arg(100000)
+    ->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+static void BM_PasswordVerify(benchmark::State& state) {
+    PasswordHandler handler(static_cast<uint32_t>(state.range(0)));
+    const std::string hash = handler.hashPassword("SecurePass123!");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.verifyPassword("SecurePass123!", hash));
+    }
+}
+BENCHMARK(BM_PasswordVerify)->ArgName("iterations")->Arg(1000)->Arg(10000)->Arg(100000)
+    ->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMicrosecond);
+
+// ==================== Tokens ====================
+
+static void BM_JwtCreate(benchmark::State& state) {
+    JWTHandler handler(benchConfig());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.createAccessToken(42, "bench@example.com"));
+    }
+}
+BENCHMARK(BM_JwtCreate)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_JwtVerify(benchmark::State& state) {
+    JWTHandler handler(benchConfig());
+    const std::string token = handler.createAccessToken(42, "bench@example.com");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.verifyToken(token));
+    }
+}
+BENCHMARK(BM_JwtVerify)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_JwtDecode(benchmark::State& state) {
+    JWTHandler handler(benchConfig());
+    const std::string token = handler.createAccessToken(42, "bench@example.com");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(handler.decodeToken(token));
+    }
+}
+BENCHMARK(BM_JwtDecode);
+
+// ==================== AuthService ====================
+
+// PBKDF2 at the default cost plus the last-login write
+static void BM_Login(benchmark::State& state) {
+    const LoginInput input{"login@example.com", "SecurePass123!"};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(authFixture.auth->login(input));
+    }
+}
+BENCHMARK(BM_Login)->ThreadRange(1, 64)->UseRealTime()->Unit(benchmark::kMillisecond)
+    ->Setup(setUpAuth)->Teardown(tearDownAuth);
+
+// Logins for unknown accounts, the bulk of credential stuffing: the
+// returned error against the thrown one
+static void BM_LoginUnknownResult(benchmark::State& state) {
+    const LoginInput input{"nobody@example.com", "SecurePass123!"};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(authFixture.auth->tryLogin(input));
+    }
+}
+BENCHMARK(BM_LoginUnknownResult)->ThreadRange(1, 8)->UseRealTime()
+    ->Setup(setUpAuth)->Teardown(tearDownAuth);
+
+static void BM_LoginUnknownThrow(benchmark::State& state) {
+    const LoginInput input{"nobody@example.com", "SecurePass123!"};
+    for (auto _ : state) {
+        try {
+            authFixture.auth->login(input);
+        } catch (const UserNotFound&) {
+        }
+    }
+}
+BENCHMARK(BM_LoginUnknownThrow)->ThreadRange(1, 8)->UseRealTime()
+    ->Setup(setUpAuth)->Teardown(tearDownAuth);
+
+static void BM_Verify(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(authFixture.auth->verifyToken(authFixture.accessToken));
+    }
+}
+BENCHMARK(BM_Verify)->ThreadRange(1, 64)->UseRealTime()
+    ->Setup(setUpAuth)->Teardown(tearDownAuth);
+
+#ifdef AUTHLIB_WITH_COROUTINES
+// Argument: logins in flight at once on one event-loop thread; hashing
+// and SQLite run on the service's pools
+static void BM_LoginAsync(benchmark::State& state) {
+    const int64_t inFlight = state.range(0);
+    for (auto _ : state) {
+        boost::asio::io_context loop;
+        for (int64_t i = 0; i < inFlight; ++i) {
+            boost::asio::co_spawn(loop, []() -> boost::asio::awaitable<void> {
+                LoginInput input{"login@example.com", "SecurePass123!"};
+                AuthResponse response = co_await asyncAuth->loginAsync(std::move(input));
+                benchmark::DoNotOptimize(response);
+            }, boost::asio::detached);
+        }
+        loop.run();
+    }
+    state.SetItemsProcessed(state.iterations() * inFlight);
+}
+BENCHMARK(BM_LoginAsync)->ArgName("in_flight")->Arg(1)->Arg(64)->Arg(256)
+    ->UseRealTime()->Unit(benchmark::kMillisecond)
+    ->Setup(setUpAsyncAuth)->Teardown(tearDownAsyncAuth);
+#endif
+
+#ifdef AUTHLIB_WITH_SERVER
+// Argument: tokens per frame; one client connection per thread
+static void BM_SidecarVerify(benchmark::State& state) {
+    sidecar::VerifyClient client(BENCH_SOCKET_PATH);
+    const std::vector<std::string> batch(static_cast<size_t>(state.range(0)), authFixture.accessToken);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(client.verify(batch));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SidecarVerify)->ArgName("batch")->Arg(1)->Arg(16)->Arg(256)
+    ->ThreadRange(1, 8)->UseRealTime()
+    ->Setup(setUpSidecar)->Teardown(tearDownSidecar);
+#endif
+
+// ==================== Sessions ====================
+
+static void BM_SessionCreate(benchmark::State& state) {
+    uint32_t userId = static_cast<uint32_t>(state.thread_index());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sessionFixture.store->create(userId++));
+    }
+}
+BENCHMARK(BM_SessionCreate)->ThreadRange(1, 8)->UseRealTime()
+    ->Setup(setUpSessions)->Teardown(tearDownSessions);
+
+static void BM_SessionValidate(benchmark::State& state) {
+    size_t i = startIndex(state, sessionFixture.ids.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(sessionFixture.store->validate(sessionFixture.ids[i]));
+        i = (i + 1) % sessionFixture.ids.size();
+    }
+}
+BENCHMARK(BM_SessionValidate)->ThreadRange(1, 8)->UseRealTime()
+    ->Setup(setUpSessions)->Teardown(tearDownSessions);
+
+// ==================== Tenants ====================
+
+// Routing by the tid claim plus the LRU lookup, on top of BM_JwtVerify
+static void BM_TenantVerify(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tenantFixture.registry->verifyToken(tenantFixture.token));
+    }
+}
+BENCHMARK(BM_TenantVerify)->ThreadRange(1, 8)->UseRealTime()
+    ->Setup(setUpTenants)->Teardown(tearDownTenants);
+
+// ==================== Metrics ====================
+
+// The per-thread histogram update every timed operation pays
+static void BM_MetricsRecord(benchmark::State& state) {
+    uint64_t nanos = 0;
+    for (auto _ : state) {
+        Metrics::record(Metric::Verify, nanos++ & 0xfffff);
+    }
+}
+BENCHMARK(BM_MetricsRecord)->ThreadRange(1, 8)->UseRealTime();
+
+// ==================== Serialization ====================
+
+static void BM_UserToJson(benchmark::State& state) {
+    User user = makeUser("bench@example.com");
+    user.id = 42;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(user.toJson().dump());
+    }
+}
+BENCHMARK(BM_UserToJson);
+
+static void BM_UserAppendJson(benchmark::State& state) {
+    User user = makeUser("bench@example.com");
+    user.id = 42;
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        user.appendJson(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_UserAppendJson);
+
+// The login/register response body: user plus both tokens
+static void BM_AuthResponseToJson(benchmark::State& state) {
+    User user = makeUser("bench@example.com");
+    user.id = 42;
+    const AuthResponse response{true, user, "access.token.value", "refresh.token.value"};
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(response.toJson().dump());
+    }
+}
+BENCHMARK(BM_AuthResponseToJson);
+
+static void BM_AuthResponseAppendJson(benchmark::State& state) {
+    User user = makeUser("bench@example.com");
+    user.id = 42;
+    const AuthResponse response{true, user, "access.token.value", "refresh.token.value"};
+    std::string out;
+    for (auto _ : state) {
+        out.clear();
+        response.appendJson(out);
+        benchmark::DoNotOptimize(out.data());
+    }
+}
+BENCHMARK(BM_AuthResponseAppendJson);
+
+// ==================== Database ====================
+
+static void BM_DbInsertUser(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.database->insertUser(makeUser(emailFor(fixture.next++))));
+    }
+}
+BENCHMARK(BM_DbInsertUser)->Apply(databaseArgs);
+
+static void BM_DbInsertUserSharded(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(shardedDatabase->insertUser(makeUser(emailFor(fixture.next++))));
+    }
+}
+BENCHMARK(BM_DbInsertUserSharded)->ArgName("shards")->Arg(1)->Arg(4)
+    ->ThreadRange(1, 8)->UseRealTime()
+    ->Setup(setUpShardedDatabase)->Teardown(tearDownShardedDatabase);
+
+static void BM_DbFindUserById(benchmark::State& state) {
+    size_t i = startIndex(state, fixture.userIds.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.database->findUserById(fixture.userIds[i]));
+        i = (i + 1) % fixture.userIds.size();
+    }
+}
+BENCHMARK(BM_DbFindUserById)->Apply(databaseArgs);
+
+static void BM_DbFindUserByEmail(benchmark::State& state) {
+    size_t i = startIndex(state, fixture.emails.size());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.database->findUserByEmail(fixture.emails[i]));
+        i = (i + 1) % fixture.emails.size();
+    }
+}
+BENCHMARK(BM_DbFindUserByEmail)->Apply(databaseArgs);
+
+static void BM_DbUpdateUser(benchmark::State& state) {
+    size_t i = startIndex(state, fixture.userIds.size());
+    User user = fixture.database->findUserById(fixture.userIds[i]);
+    for (auto _ : state) {
+        user.id = fixture.userIds[i];
+        user.updatedAt = std::time(nullptr);
+        fixture.database->updateUser(user);
+        i = (i + 1) % fixture.userIds.size();
+    }
+}
+BENCHMARK(BM_DbUpdateUser)->Apply(databaseArgs);
+
+static void BM_DbUpdateLastLogin(benchmark::State& state) {
+    size_t i = startIndex(state, fixture.userIds.size());
+    for (auto _ : state) {
+        fixture.database->updateLastLogin(fixture.userIds[i], std::time(nullptr));
+        i = (i + 1) % fixture.userIds.size();
+    }
+}
+BENCHMARK(BM_DbUpdateLastLogin)->Apply(databaseArgs);
+
+static void BM_DbUpdatePasswordHash(benchmark::State& state) {
+    size_t i = startIndex(state, fixture.userIds.size());
+    const std::string hash = makeUser("").passwordHash;
+    for (auto _ : state) {
+        fixture.database->updatePasswordHash(fixture.userIds[i], hash, std::time(nullptr));
+        i = (i + 1) % fixture.userIds.size();
+    }
+}
+BENCHMARK(BM_DbUpdatePasswordHash)->Apply(databaseArgs);
+
+static void BM_DbBlacklistToken(benchmark::State& state) {
+    TokenBlacklist entry;
+    entry.userId = fixture.userIds[0];
+    entry.expiresAt = std::time(nullptr) + 3600;
+    for (auto _ : state) {
+        // Only the token's digest is stored, so any unique string will do
+        entry.token = "revoked-" + std::to_string(fixture.next++);
+        fixture.database->blacklistToken(entry);
+    }
+}
+BENCHMARK(BM_DbBlacklistToken)->Apply(databaseArgs);
+
+// Alternates revoked and unknown tokens, the two answers a check gives
+static void BM_DbIsTokenBlacklisted(benchmark::State& state) {
+    size_t i = startIndex(state, fixture.tokens.size());
+    const std::string unknown = SecureRandom::token(48);
+    bool hit = true;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.database->isTokenBlacklisted(hit ? fixture.tokens[i] : unknown));
+        hit = !hit;
+        i = (i + 1) % fixture.tokens.size();
+    }
+}
+BENCHMARK(BM_DbIsTokenBlacklisted)->Apply(databaseArgs);
+
+// Nothing has expired, so this is the cost of an empty expires_at index probe
+static void BM_DbCleanExpiredTokens(benchmark::State& state) {
+    for (auto _ : state) {
+        fixture.database->cleanExpiredTokens();
+    }
+}
+BENCHMARK(BM_DbCleanExpiredTokens)->ArgName("disk")->Arg(0)->Arg(1)
+    ->Setup(setUpDatabase)->Teardown(tearDownDatabase);
+
+// Batches of 64, the shape SessionStore's write-behind flush produces
+static void BM_DbSaveAndDeleteSessions(benchmark::State& state) {
+    constexpr size_t BATCH = 64;
+    std::vector<Session> sessions(BATCH);
+    std::vector<std::string> ids(BATCH);
+    const std::time_t now = std::time(nullptr);
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (size_t i = 0; i < BATCH; ++i) {
+            sessions[i].id = SecureRandom::bytes(32);
+            sessions[i].userId = fixture.userIds[i];
+            sessions[i].createdAt = now;
+            sessions[i].expiresAt = now + 3600;
+            ids[i] = sessions[i].id;
+        }
+        state.ResumeTiming();
+        fixture.database->saveSessions(sessions);
+        fixture.database->deleteSessions(ids, now);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * BATCH));
+}
+BENCHMARK(BM_DbSaveAndDeleteSessions)->Apply(databaseArgs);
+
+static void BM_DbLoadSessions(benchmark::State& state) {
+    constexpr size_t SESSIONS = 1000;
+    std::vector<Session> sessions(SESSIONS);
+    const std::time_t now = std::time(nullptr);
+    for (size_t i = 0; i < SESSIONS; ++i) {
+        sessions[i].id = SecureRandom::bytes(32);
+        sessions[i].userId = fixture.userIds[i];
+        sessions[i].createdAt = now;
+        sessions[i].expiresAt = now + 3600;
+    }
+    fixture.database->saveSessions(sessions);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(fixture.database->loadSessions(now));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * SESSIONS));
+}
+BENCHMARK(BM_DbLoadSessions)->ArgName("disk")->Arg(0)->Arg(1)
+    ->Setup(setUpDatabase)->Teardown(tearDownDatabase)->Unit(benchmark::kMicrosecond);
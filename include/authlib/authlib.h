@@ -7,19 +7,40 @@
 
 // Config
 #include <authlib/config/Config.h>
+#include <authlib/config/ConfigStore.h>
 
 // Models
 #include <authlib/models/User.h>
 #include <authlib/models/TokenBlacklist.h>
+#include <authlib/models/Session.h>
 
 // Services
 #include <authlib/services/AuthService.h>
 #include <authlib/services/UserService.h>
+#ifdef AUTHLIB_WITH_COROUTINES
+#include <authlib/services/AsyncAuthService.h>
+#endif
+
+// Sessions
+#include <authlib/session/SessionStore.h>
+
+// Tenants
+#include <authlib/tenant/TenantRegistry.h>
+
+// Observability
+#include <authlib/observability/Metrics.h>
+#include <authlib/observability/Tracing.h>
 
 // Utilities
 #include <authlib/utils/exceptions.h>
+#include <authlib/utils/BreachedPasswordIndex.h>
 #include <authlib/utils/JWTHandler.h>
+#include <authlib/utils/JsonWriter.h>
 #include <authlib/utils/PasswordHandler.h>
+#include <authlib/utils/PasswordHashPool.h>
+#include <authlib/utils/PasswordPolicy.h>
+#include <authlib/utils/Result.h>
+#include <authlib/utils/SecureRandom.h>
 #include <authlib/utils/Validators.h>
 
 // Database
@@ -7,6 +7,10 @@
 
 #include <string>
 #include <cstdint>
+#include <ctime>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
 
 namespace authlib {
 
@@ -16,9 +20,66 @@ public:
     std::string JWT_ALGORITHM;
     uint32_t JWT_ACCESS_TOKEN_EXPIRY_MINUTES;
     uint32_t JWT_REFRESH_TOKEN_EXPIRY_DAYS;
+    std::string JWT_PREVIOUS_SECRET_KEY;        // still accepted for verification during the grace window
+    uint32_t JWT_KEY_ROTATION_GRACE_SECONDS;    // how long a rotated-out secret stays valid
+    std::time_t JWT_PREVIOUS_SECRET_EXPIRES_AT; // set on load/rotation, 0 when there is no previous key
+
+    std::string PASSWORD_HASH_ALGORITHM; // "pbkdf2-sha256" or "argon2id"
+    uint32_t PASSWORD_HASH_ITERATIONS;
+    uint32_t PASSWORD_HASH_TARGET_MS; // 0 disables startup calibration
+    uint32_t PASSWORD_ARGON2_MEMORY_KIB;
+    uint32_t PASSWORD_ARGON2_TIME_COST;
+    uint32_t PASSWORD_ARGON2_PARALLELISM;
+    uint32_t PASSWORD_HASH_POOL_WORKERS;        // 0 = hardware concurrency
+    uint32_t PASSWORD_HASH_POOL_QUEUE_CAPACITY;
+    std::string PASSWORD_BREACHED_INDEX_PATH; // empty disables the breach check
+
+    uint32_t PASSWORD_MIN_LENGTH;
+    uint32_t PASSWORD_MAX_LENGTH;
+    bool PASSWORD_REQUIRE_UPPERCASE;
+    bool PASSWORD_REQUIRE_LOWERCASE;
+    bool PASSWORD_REQUIRE_DIGIT;
+    bool PASSWORD_REQUIRE_SPECIAL;
+    bool PASSWORD_FORBID_EMAIL;                // reject passwords containing the email local part
+    std::string PASSWORD_FORBIDDEN_SUBSTRINGS; // comma-separated, case-insensitive
+    std::string PASSWORD_DICTIONARY_PATH;      // one disallowed password per line
+
+    bool EMAIL_FOLD_LOCAL_PART; // case-insensitive local part in the lookup key
+    bool EMAIL_PROVIDER_RULES;  // Gmail dots, "+tag" suffixes and domain aliases
+
+    uint32_t ASYNC_COMPUTE_THREADS; // AsyncAuthService hashing pool, 0 = hardware concurrency
+    uint32_t ASYNC_IO_THREADS;      // AsyncAuthService database pool
+
+    // authd HTTP server
+    std::string HTTP_BIND_ADDRESS;
+    uint32_t HTTP_PORT;
+    uint32_t HTTP_THREADS;              // 0 = hardware concurrency
+    bool HTTP_REUSE_PORT;               // one SO_REUSEPORT acceptor per thread
+    uint32_t HTTP_IDLE_TIMEOUT_SECONDS; // keep-alive connections close after this long idle
+    uint32_t HTTP_MAX_BODY_BYTES;
+    bool HTTP_METRICS;                  // expose GET /metrics; keep the port private when on
+    std::string HTTP_TRACE_FILE;        // Chrome trace of every request's phases, empty = off
+
+    // authlib_verifyd token verification sidecar
+    std::string VERIFY_SOCKET_PATH;
+    uint32_t VERIFY_THREADS;
+
+    // SessionStore
+    uint32_t SESSION_SHARDS;            // rounded up to a power of two
+    uint32_t SESSION_TTL_SECONDS;
+    uint32_t SESSION_SWEEP_INTERVAL_MS; // 0 = no sweep thread
+    bool SESSION_PERSIST;               // write-behind to the sessions table
+
+    // TenantRegistry
+    uint32_t TENANT_MAX_OPEN;     // tenants kept open at once (LRU)
+    uint32_t TENANT_IDLE_SECONDS; // close tenants unused this long, 0 = never
 
     std::string DATABASE_URL;
     std::string DATABASE_TYPE;
+    uint32_t DATABASE_SHARDS; // SQLite files users are spread over; fixed once data exists
+    bool DATABASE_PROFILE;           // per-statement latency histograms and scan counters
+    uint32_t DATABASE_SLOW_QUERY_MS; // log statements at least this slow, with values; 0 = off
+    bool DATABASE_EXPLAIN_CHECK;     // warn at startup about request-path full table scans
 
     std::string SMTP_SERVER;
     std::string SMTP_USERNAME;
@@ -27,13 +88,31 @@ public:
 
     bool DEBUG;
 
+    /**
+     * Defaults, overridden by the JSON file named in AUTHLIB_CONFIG_FILE
+     * (if set), overridden by environment variables
+     */
     Config();
-    
+
+    /**
+     * Same layering with an explicit file; "" skips the file. Throws
+     * ConfigError naming the setting and its source for an unknown key,
+     * a wrongly typed value or one outside its allowed range.
+     */
+    explicit Config(const std::string& configFile);
+
     void validate() const;
     bool isProductionMode() const;
 
+    /**
+     * Effective settings keyed by name; secrets read "<redacted>" unless
+     * `includeSecrets`, in which case the output loads back as a config
+     * file.
+     */
+    json toJson(bool includeSecrets = false) const;
+
 private:
-    std::string getEnv(const std::string& key, const std::string& defaultValue = "");
+    static std::string getEnv(const std::string& key, const std::string& defaultValue = "");
 };
 
 } // namespace authlib
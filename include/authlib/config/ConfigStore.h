@@ -0,0 +1,72 @@
+/**
+ * Hot-reloadable, immutable configuration snapshots
+ */
+
+#ifndef AUTHLIB_CONFIG_STORE_H
+#define AUTHLIB_CONFIG_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <authlib/config/Config.h>
+
+namespace authlib {
+
+class ConfigStore {
+public:
+    explicit ConfigStore(std::shared_ptr<const Config> initial = std::make_shared<const Config>());
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    /**
+     * The current snapshot. Each thread caches the last snapshot it saw of
+     * up to 16 stores (one per tenant under a TenantRegistry) and only
+     * reloads the shared pointer after a publish or once the store drops
+     * out of that cache, but the copy returned here still bumps the shared
+     * reference count. The returned snapshot never changes; hold it for
+     * the duration of one request so every setting comes from the same
+     * version.
+     */
+    std::shared_ptr<const Config> snapshot() const;
+
+    /**
+     * The calling thread's cached snapshot, by reference: an atomic load
+     * of the version and nothing written to shared memory. The reference
+     * stays valid until this thread's next snapshot() or view() on any
+     * ConfigStore, so don't keep it across calls that might make one.
+     */
+    const Config& view() const;
+
+    /**
+     * Atomically replace the snapshot. When JWT_SECRET_KEY changes, the
+     * outgoing key becomes JWT_PREVIOUS_SECRET_KEY for
+     * JWT_KEY_ROTATION_GRACE_SECONDS so tokens already issued keep
+     * verifying.
+     */
+    void publish(std::shared_ptr<const Config> next);
+
+    /**
+     * Re-read AUTHLIB_CONFIG_FILE and the environment and publish the
+     * result. Throws ConfigError, leaving the current snapshot in place,
+     * if the new settings don't load.
+     */
+    std::shared_ptr<const Config> reload();
+
+    /**
+     * Increases on every publish
+     */
+    uint64_t version() const;
+
+private:
+    std::shared_ptr<const Config> current;
+    std::atomic<uint64_t> currentVersion;
+    std::mutex publishMutex;
+
+    const std::shared_ptr<const Config>& cachedSnapshot() const;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_CONFIG_STORE_H
@@ -5,18 +5,83 @@
 #ifndef AUTHLIB_DATABASE_H
 #define AUTHLIB_DATABASE_H
 
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iosfwd>
 #include <string>
 #include <memory>
+#include <optional>
+#include <vector>
+#include <authlib/models/Session.h>
 #include <authlib/models/User.h>
 #include <authlib/models/TokenBlacklist.h>
 #include <authlib/config/Config.h>
+#include <authlib/observability/Metrics.h>
 
 namespace authlib {
 
+namespace detail {
+struct SqliteConnection;
+class SqliteConnectionPool;
+class StatementProfiler;
+}
+
+/**
+ * Statement profiling, off by default. See Database::setProfiling.
+ */
+struct DatabaseProfileOptions {
+    bool enabled = false;       // per-statement latency histograms and scan counters
+    uint32_t slowQueryMs = 0;   // log statements taking at least this long, 0 = off
+    bool explainCheck = true;   // log request-path statements whose plan scans a table
+    std::function<void(const std::string&)> log; // defaults to std::cerr
+
+    /**
+     * Options from DATABASE_PROFILE, DATABASE_SLOW_QUERY_MS and
+     * DATABASE_EXPLAIN_CHECK
+     */
+    static DatabaseProfileOptions fromConfig(const Config& config);
+};
+
+/**
+ * What one SQL text has cost so far, summed over every connection
+ */
+struct StatementProfile {
+    std::string sql;
+    MetricSnapshot latency;     // one sample per execution, from first step to reset
+    uint64_t rowsReturned = 0;
+    uint64_t fullScanSteps = 0; // rows stepped over by full table scans
+    uint64_t vmSteps = 0;       // virtual machine instructions run
+};
+
+/**
+ * Safe to share between threads: each calling thread is given its own
+ * connection on first use, which returns to the pool when the thread exits.
+ *
+ * With `shards` > 1 the data is spread over that many SQLite files
+ * ("authlib.db" becomes "authlib.shard0.db", "authlib.shard1.db", ...),
+ * each with its own write lock, so writers to different shards don't
+ * queue behind each other. Rows are placed by one of 256 slots: a user by
+ * its canonical email hash, a revoked token by its SHA-256 and a session
+ * by its id, and slot s lives in shard s % shards. A sharded user id
+ * carries its slot in the low 8 bits, so findUserById goes straight to
+ * one file, and resharding moves whole slots without changing any id.
+ * That leaves 24 bits of per-shard sequence: about 16.7 million
+ * registrations per shard file.
+ *
+ * A database is sharded or not for life; change the layout offline with
+ * reshard() (the authlib_reshard tool).
+ */
 class Database {
 public:
-    explicit Database(const std::string& connectionUrl);
-    
+    static constexpr uint32_t MAX_SHARDS = 256;
+
+    /**
+     * `busyTimeoutMs` bounds how long a writer waits for another thread's
+     * write to the same shard to finish before failing with DatabaseError
+     */
+    explicit Database(const std::string& connectionUrl, uint32_t busyTimeoutMs = 5000, uint32_t shards = 1);
+
     ~Database();
 
     /**
@@ -29,20 +94,57 @@ public:
      */
     bool isConnected() const;
 
+    uint32_t shardCount() const;
+
+    /**
+     * Turn on statement profiling; call before initialize().
+     *
+     * With `enabled`, every execution of a prepared statement is timed
+     * into a histogram for its SQL text, and its returned rows and full
+     * scan steps are counted, costing two clock reads per step. The slow
+     * query log is separate (SQLite's own profile hook, which reports in
+     * whole milliseconds) and also covers transactions and schema
+     * statements. The logged SQL has its parameters expanded, so it
+     * holds emails and password hashes: route `log` accordingly.
+     */
+    void setProfiling(const DatabaseProfileOptions& options);
+
+    /**
+     * Every profiled SQL text, most total time first; empty unless
+     * profiling is enabled
+     */
+    std::vector<StatementProfile> statementProfiles() const;
+
     /**
-     * Insert a user
+     * Run EXPLAIN QUERY PLAN on `statements` (by default the ones login,
+     * refresh, logout and the session store run) and return one line per
+     * statement that scans a whole table or index. initialize() logs
+     * these when `explainCheck` is set.
+     */
+    std::vector<std::string> checkQueryPlans(const std::vector<std::string>& statements = {});
+
+    /**
+     * Insert a user. An empty emailCanonical is filled in with the default
+     * EmailCanonicalizer rules.
      */
     User insertUser(const User& user);
 
     /**
-     * Find user by ID
+     * Find user by ID; throws UserNotFound
      */
     User findUserById(uint32_t id);
 
     /**
-     * Find user by email
+     * Find user by canonical email (see EmailCanonicalizer); served from
+     * the UNIQUE index on email_canonical. Throws UserNotFound.
      */
-    User findUserByEmail(const std::string& email);
+    User findUserByEmail(const std::string& canonicalEmail);
+
+    /**
+     * The lookups above with a miss as an empty result instead of an exception
+     */
+    std::optional<User> tryFindUserById(uint32_t id);
+    std::optional<User> tryFindUserByEmail(const std::string& canonicalEmail);
 
     /**
      * Update user
@@ -50,25 +152,79 @@ public:
     void updateUser(const User& user);
 
     /**
-     * Blacklist a token
+     * Set last_login only, so a login can't overwrite a concurrent
+     * change to the user's other fields
+     */
+    void updateLastLogin(uint32_t id, std::time_t lastLogin);
+
+    /**
+     * Set password_hash and updated_at only
+     */
+    void updatePasswordHash(uint32_t id, const std::string& passwordHash, std::time_t updatedAt);
+
+    /**
+     * Blacklist a token until its expiry. Only the token's SHA-256 is
+     * stored; blacklisting twice is harmless.
      */
     void blacklistToken(const TokenBlacklist& entry);
 
     /**
-     * Check if token is blacklisted
+     * Check if token is blacklisted: one primary-key lookup on its digest
      */
     bool isTokenBlacklisted(const std::string& token);
 
     /**
-     * Clean expired blacklisted tokens
+     * Drop blacklist entries whose token has expired anyway
      */
     void cleanExpiredTokens();
 
+    /**
+     * Insert or replace sessions in one transaction (SessionStore write-behind)
+     */
+    void saveSessions(const std::vector<Session>& sessions);
+
+    /**
+     * Delete sessions by raw id, plus every session expired at `now`, in
+     * one transaction
+     */
+    void deleteSessions(const std::vector<std::string>& ids, std::time_t now);
+
+    /**
+     * Sessions still valid at `now`
+     */
+    std::vector<Session> loadSessions(std::time_t now);
+
+    /**
+     * Copy every user, revocation and session from one layout into another,
+     * e.g. 4 shards to 16. The target must be empty and nothing may write
+     * to the source meanwhile. User ids are kept, except going from an
+     * unsharded source to a sharded target: those ids carry no slot, so
+     * users get new ids and `idMap` (if given) receives one "old new" line
+     * per user; revocations and sessions are moved to the new ids. Tokens
+     * issued before such a move name the old ids, so rotate JWT_SECRET
+     * with it. Returns the number of users copied.
+     */
+    static size_t reshard(
+        const std::string& sourceUrl, uint32_t sourceShards,
+        const std::string& targetUrl, uint32_t targetShards,
+        std::ostream* idMap = nullptr
+    );
+
 private:
     std::string connectionUrl;
-    void* dbHandle; // SQLite3 or DB-specific handle
-
-    void createTables();
+    uint32_t busyTimeoutMs;
+    uint32_t shards;
+    std::vector<std::shared_ptr<detail::SqliteConnectionPool>> pools;
+    std::shared_ptr<detail::StatementProfiler> profiler; // null when neither profiling nor the slow log is on
+    DatabaseProfileOptions profileOptions;
+    bool profileConfigured = false;
+
+    detail::SqliteConnection& connection(size_t shard = 0) const;
+    size_t shardForSlot(uint32_t slot) const;
+    size_t shardForUser(uint32_t id) const;
+    void createTables(size_t shard);
+    void migrateEmailCanonical(size_t shard);
+    void migrateTokenBlacklist(size_t shard);
 };
 
 } // namespace authlib
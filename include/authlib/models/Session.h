@@ -0,0 +1,35 @@
+/**
+ * Opaque server-side session model
+ */
+
+#ifndef AUTHLIB_SESSION_H
+#define AUTHLIB_SESSION_H
+
+#include <cstdint>
+#include <ctime>
+#include <string>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+namespace authlib {
+
+class Session {
+public:
+    std::string id; // the raw 32 random bytes; clients hold the base64url form
+    uint32_t userId;
+    std::time_t createdAt;
+    std::time_t expiresAt;
+    std::string metadata; // opaque to the library, e.g. device or IP
+
+    Session();
+
+    /**
+     * Everything but the id, which is a bearer credential
+     */
+    json toJson() const;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_SESSION_H
@@ -5,9 +5,11 @@
 #ifndef AUTHLIB_USER_H
 #define AUTHLIB_USER_H
 
+#include <cstdint>
 #include <string>
 #include <ctime>
 #include <nlohmann/json.hpp>
+#include <authlib/utils/JsonWriter.h>
 
 using json = nlohmann::json;
 
@@ -17,6 +19,8 @@ class User {
 public:
     uint32_t id;
     std::string email;
+    std::string emailCanonical; // lookup key, see EmailCanonicalizer
+    uint64_t emailHash;
     std::string passwordHash;
     std::string firstName;
     std::string lastName;
@@ -29,6 +33,13 @@ public:
     User();
 
     json toJson() const;
+
+    /**
+     * Same fields as toJson(), written without an intermediate tree
+     */
+    void writeJson(JsonWriter& writer) const;
+    void appendJson(std::string& out) const;
+
     std::string toString() const;
 };
 
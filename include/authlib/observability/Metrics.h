@@ -0,0 +1,160 @@
+/**
+ * Per-operation latency histograms with Prometheus text export
+ */
+
+#ifndef AUTHLIB_METRICS_H
+#define AUTHLIB_METRICS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <string>
+#include <vector>
+
+namespace authlib {
+
+/**
+ * What gets timed: the AuthService operations, then the phases inside
+ * them. The name is the `op` label in the exported metrics.
+ */
+enum class Metric : uint8_t {
+    Register,   // register
+    Login,      // login
+    Refresh,    // refresh
+    Logout,     // logout
+    Validate,   // validate: email and password checks
+    Lookup,     // lookup: user and blacklist reads
+    Hash,       // hash: password hashing
+    HashVerify, // hash_verify: password verification
+    DbWrite,    // db_write: user inserts and updates, blacklisting
+    Sign,       // sign: token creation
+    Verify,     // verify: token verification
+    COUNT
+};
+
+/**
+ * A merged copy of one metric's histogram
+ */
+struct MetricSnapshot {
+    uint64_t count = 0;      // the sum of `buckets`
+    uint64_t errors = 0;     // failed operations: thrown, or returned after ScopedTimer::fail()
+    uint64_t sumNanos = 0;
+    std::vector<uint64_t> buckets; // Metrics::BUCKETS entries, see Metrics::bucketLower
+
+    /**
+     * Latency at quantile `q` (0..1) in nanoseconds, to within 1/16 of
+     * the value: the midpoint of the bucket holding that rank. 0 when
+     * nothing was recorded.
+     */
+    uint64_t percentile(double q) const;
+};
+
+/**
+ * Process-wide latency histograms. Every thread records into its own
+ * block, so the hot path is a thread-local pointer load, a bucket index
+ * from the leading-zero count, and plain loads and stores to two counters
+ * (the bucket and the sum): no lock, no read-modify-write, no shared cache
+ * line. A scrape sums the live blocks plus those of threads that have
+ * exited; the count is the buckets' total, so it always agrees with them.
+ *
+ * Buckets are log-linear like HdrHistogram: values below 8ns get one
+ * bucket each, then every power of two is split into 8 equal buckets, so
+ * the relative error is under 12.5% from nanoseconds to the 2^40ns (about
+ * 18 minute) cap. That is 304 buckets per metric, 2.4KB, or about 27KB per
+ * recording thread.
+ */
+class Metrics {
+public:
+    static constexpr size_t BUCKETS = 304;
+    static constexpr uint64_t MAX_NANOS = (uint64_t(1) << 40) - 1;
+
+    /**
+     * Add one sample of `nanos` (clamped to MAX_NANOS) to `metric`
+     */
+    static void record(Metric metric, uint64_t nanos);
+
+    /**
+     * Add one sample and count it as an error
+     */
+    static void recordError(Metric metric, uint64_t nanos);
+
+    /**
+     * Every thread's recordings of `metric` so far. Recordings racing
+     * with the scrape may or may not be included.
+     */
+    static MetricSnapshot snapshot(Metric metric);
+
+    /**
+     * Prometheus text exposition (version 0.0.4) of every metric:
+     * authlib_operation_duration_seconds histograms with power-of-two
+     * bounds from 1.024us to about 17s, and authlib_operation_errors_total
+     * counters, both labelled op="<name>".
+     */
+    static std::string prometheus();
+
+    /**
+     * The `op` label of `metric`
+     */
+    static const char* name(Metric metric);
+
+    /**
+     * Smallest value counted in bucket `index`
+     */
+    static uint64_t bucketLower(size_t index);
+
+    /**
+     * Bucket that counts `nanos`
+     */
+    static size_t bucketFor(uint64_t nanos);
+
+    /**
+     * Zero every histogram. For tests; recordings running concurrently
+     * with it may survive.
+     */
+    static void reset();
+};
+
+/**
+ * Times its own scope into a metric, counting an error when the scope is
+ * left by an exception or after fail():
+ *
+ *   ScopedTimer timer(Metric::Login);
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Metric metric)
+        : metric(metric),
+          exceptions(std::uncaught_exceptions()),
+          start(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        if (failed || std::uncaught_exceptions() > exceptions) {
+            Metrics::recordError(metric, static_cast<uint64_t>(nanos));
+        } else {
+            Metrics::record(metric, static_cast<uint64_t>(nanos));
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    /**
+     * Count this sample as an error, for failures returned rather than thrown
+     */
+    void fail() {
+        failed = true;
+    }
+
+private:
+    Metric metric;
+    bool failed = false;
+    int exceptions;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_METRICS_H
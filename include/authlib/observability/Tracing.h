@@ -0,0 +1,171 @@
+/**
+ * Per-request phase tracing with a Chrome trace-event writer
+ */
+
+#ifndef AUTHLIB_TRACING_H
+#define AUTHLIB_TRACING_H
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace authlib {
+
+/**
+ * One finished span: either a whole request (`name == request`) or one
+ * phase of it. Names are string literals and outlive the event.
+ */
+struct TraceEvent {
+    const char* name;
+    const char* request;    // the operation this span belongs to, e.g. "login"
+    uint64_t traceId;       // shared by a request and all of its phases
+    uint64_t startNanos;    // steady_clock time since its epoch
+    uint64_t durationNanos;
+    uint32_t thread;        // small per-process thread number
+    bool error;             // ended by an exception
+};
+
+/**
+ * Receives every finished span. record() is called on the traced thread,
+ * concurrently from every thread doing work, and sits on the request's
+ * latency path; keep it short.
+ */
+class TraceSink {
+public:
+    virtual ~TraceSink() = default;
+    virtual void record(const TraceEvent& event) = 0;
+};
+
+/**
+ * Process-wide switch. With no sink installed (the default), each trace
+ * point costs one relaxed atomic load; built with
+ * -DAUTHLIB_ENABLE_TRACING=OFF the trace points are not compiled at all.
+ */
+class Tracing {
+public:
+    /**
+     * Send spans to `sink` from the next request on; nullptr stops
+     * tracing. Requests already running finish on the sink they started
+     * with, which is kept alive until they do.
+     */
+    static void setSink(std::shared_ptr<TraceSink> sink);
+
+    static std::shared_ptr<TraceSink> sink();
+
+    /**
+     * Whether the library was built with trace points
+     */
+    static bool compiledIn();
+};
+
+/**
+ * Request-scoped trace id for the calling thread, so spans from a request
+ * can be joined with the caller's own logs: set one around the AuthService
+ * call and every span it records carries that id. Without one, each
+ * request gets a fresh id. Restores the previous id on destruction.
+ */
+class TraceContext {
+public:
+    explicit TraceContext(uint64_t traceId);
+    ~TraceContext();
+
+    TraceContext(const TraceContext&) = delete;
+    TraceContext& operator=(const TraceContext&) = delete;
+
+    /**
+     * The calling thread's id, 0 when none is set
+     */
+    static uint64_t current();
+
+    /**
+     * A process-unique nonzero id
+     */
+    static uint64_t newId();
+
+private:
+    uint64_t previous;
+};
+
+/**
+ * Spans one operation and its consecutive phases: each phase() call ends
+ * the phase before it, and destruction ends the last phase and the
+ * operation. Use through the macros below so the calls vanish when
+ * tracing is compiled out:
+ *
+ *   AUTHLIB_TRACE_REQUEST(trace, "login");
+ *   AUTHLIB_TRACE_PHASE(trace, "validate");
+ *   ...
+ *   AUTHLIB_TRACE_PHASE(trace, "verify_password");
+ *
+ * The last phase and the operation are marked as errors when the scope
+ * is left by an exception, or after AUTHLIB_TRACE_FAIL(trace) for
+ * failures that are returned instead.
+ */
+class RequestTrace {
+public:
+    explicit RequestTrace(const char* name);
+    ~RequestTrace();
+
+    RequestTrace(const RequestTrace&) = delete;
+    RequestTrace& operator=(const RequestTrace&) = delete;
+
+    void phase(const char* name);
+
+    void fail();
+
+private:
+    std::shared_ptr<TraceSink> sink; // null when tracing is off
+    const char* name;
+    const char* phaseName = nullptr;
+    uint64_t traceId = 0;
+    uint64_t start = 0;
+    uint64_t phaseStart = 0;
+    int exceptions = 0;
+    bool failed = false;
+
+    void endPhase(uint64_t now, bool error);
+};
+
+#ifdef AUTHLIB_WITH_TRACING
+#define AUTHLIB_TRACE_REQUEST(trace, name) ::authlib::RequestTrace trace(name)
+#define AUTHLIB_TRACE_PHASE(trace, name) trace.phase(name)
+#define AUTHLIB_TRACE_FAIL(trace) trace.fail()
+#else
+#define AUTHLIB_TRACE_REQUEST(trace, name) ((void)0)
+#define AUTHLIB_TRACE_PHASE(trace, name) ((void)0)
+#define AUTHLIB_TRACE_FAIL(trace) ((void)0)
+#endif
+
+/**
+ * Appends spans to a file in Chrome's trace-event format (complete "X"
+ * events), for chrome://tracing or ui.perfetto.dev. Each event is
+ * formatted on the recording thread and written under a lock into the
+ * stream's buffer; the closing bracket is written on destruction, and the
+ * viewers also accept a file cut off by a crash.
+ */
+class ChromeTraceWriter : public TraceSink {
+public:
+    /**
+     * Truncates `path`; throws std::runtime_error if it can't be opened
+     */
+    explicit ChromeTraceWriter(const std::string& path);
+    ~ChromeTraceWriter() override;
+
+    void record(const TraceEvent& event) override;
+
+    /**
+     * Push buffered events to the file
+     */
+    void flush();
+
+private:
+    std::mutex mutex;
+    std::ofstream out;
+    bool first = true;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_TRACING_H
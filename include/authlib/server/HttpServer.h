@@ -0,0 +1,93 @@
+/**
+ * HTTP/1.1 JSON front end for AuthService (the authd daemon)
+ */
+
+#ifndef AUTHLIB_HTTP_SERVER_H
+#define AUTHLIB_HTTP_SERVER_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <authlib/config/Config.h>
+#include <authlib/services/AuthService.h>
+
+namespace authlib {
+
+namespace detail {
+class HttpWorker;
+}
+
+struct HttpServerOptions {
+    std::string address = "0.0.0.0";
+    uint16_t port = 8080;             // 0 picks a free port, see HttpServer::port()
+    uint32_t threads = 0;             // 0 = hardware concurrency
+    bool reusePort = true;            // falls back to one shared acceptor where unsupported
+    uint32_t idleTimeoutSeconds = 30;
+    uint32_t maxBodyBytes = 16384;
+    bool metrics = false;             // serve GET /metrics (Prometheus text) on the same port
+
+    /**
+     * Options from the HTTP_* settings
+     */
+    static HttpServerOptions fromConfig(const Config& config);
+};
+
+/**
+ * Endpoints (request and response bodies are JSON):
+ *
+ *   POST /auth/register  {email, password, firstName, lastName} -> 201 AuthResponse
+ *   POST /auth/login     {email, password}                      -> 200 AuthResponse
+ *   GET  /auth/verify    Authorization: Bearer <access token>   -> 200 token payload
+ *   POST /auth/refresh   {refreshToken}                         -> 200 {accessToken}
+ *   POST /auth/logout    {accessToken, refreshToken}            -> 200 {success}
+ *   GET  /metrics        (only with options.metrics)            -> 200 Prometheus text
+ *
+ * Failures are {"error": message} with 400 (validation or malformed
+ * body), 401 (credentials or token), 404, 409 (email taken), 413, 503
+ * (hash queue full) or 500.
+ *
+ * Each worker thread runs its own event loop. With reusePort every worker
+ * also has its own SO_REUSEPORT listening socket, so the kernel spreads
+ * new connections across them and no accept path is shared; otherwise
+ * worker 0 accepts and deals connections out round-robin. A connection
+ * stays on one worker for its lifetime. Handlers call AuthService
+ * synchronously, so a login's password hash holds up the other
+ * connections on that worker; size `threads` to at least the core count.
+ */
+class HttpServer {
+public:
+    HttpServer(AuthService& authService, const HttpServerOptions& options = HttpServerOptions());
+
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    /**
+     * Bind, listen and start the worker threads; returns once the server
+     * is accepting. Throws boost::system::system_error if the address
+     * can't be bound.
+     */
+    void start();
+
+    /**
+     * Stop accepting, drop open connections and join the workers
+     */
+    void stop();
+
+    /**
+     * The bound port (useful after binding port 0); valid after start()
+     */
+    uint16_t port() const;
+
+private:
+    AuthService& authService;
+    HttpServerOptions options;
+    uint16_t boundPort;
+    std::vector<std::unique_ptr<detail::HttpWorker>> workers;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_HTTP_SERVER_H
@@ -0,0 +1,83 @@
+/**
+ * Coroutine (C++20, Boost.Asio) front end for AuthService
+ */
+
+#ifndef AUTHLIB_ASYNC_AUTH_SERVICE_H
+#define AUTHLIB_ASYNC_AUTH_SERVICE_H
+
+#if __cplusplus < 202002L && !(defined(_MSVC_LANG) && _MSVC_LANG >= 202002L)
+#error "AsyncAuthService needs C++20; configure with -DAUTHLIB_ENABLE_COROUTINES=ON"
+#endif
+
+#include <memory>
+#include <string>
+#include <utility> // before awaitable.hpp, which uses std::exchange without it on older Boost
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <authlib/config/ConfigStore.h>
+#include <authlib/database/Database.h>
+#include <authlib/services/AuthService.h>
+#include <authlib/utils/Result.h>
+
+namespace authlib {
+
+/**
+ * Awaitable versions of the AuthService calls. Password hashing runs on a
+ * compute pool (ASYNC_COMPUTE_THREADS) and database calls on an I/O pool
+ * (ASYNC_IO_THREADS); each step resumes on the awaiting coroutine's
+ * executor, so a single event-loop thread can keep thousands of logins in
+ * flight without ever running PBKDF2 or waiting on SQLite itself.
+ *
+ *   LoginInput input{email, password};
+ *   auto result = co_await auth.loginAsync(std::move(input));
+ *
+ * Build the input as a named variable as above: GCC 12 miscompiles
+ * brace-initialised aggregate temporaries that live across a co_await.
+ *
+ * Exceptions are the same as AuthService's and are rethrown at the
+ * co_await; the try* coroutines return the expected failures as a Result
+ * instead, like AuthService's try* calls. The destructor waits for work
+ * already on the pools.
+ */
+class AsyncAuthService {
+public:
+    AsyncAuthService(Database& database, const Config& config = Config());
+    AsyncAuthService(Database& database, std::shared_ptr<ConfigStore> configStore);
+
+    ~AsyncAuthService();
+
+    AsyncAuthService(const AsyncAuthService&) = delete;
+    AsyncAuthService& operator=(const AsyncAuthService&) = delete;
+
+    boost::asio::awaitable<AuthResponse> registerUserAsync(RegisterInput input);
+    boost::asio::awaitable<Result<AuthResponse>> tryRegisterUserAsync(RegisterInput input);
+
+    boost::asio::awaitable<AuthResponse> loginAsync(LoginInput input);
+    boost::asio::awaitable<Result<AuthResponse>> tryLoginAsync(LoginInput input);
+
+    /**
+     * A single HMAC, so it runs on the caller's executor
+     */
+    boost::asio::awaitable<TokenPayload> verifyTokenAsync(std::string token);
+    boost::asio::awaitable<Result<TokenPayload>> tryVerifyTokenAsync(std::string token);
+
+    boost::asio::awaitable<json> refreshAccessTokenAsync(std::string refreshToken);
+    boost::asio::awaitable<Result<std::string>> tryRefreshAccessTokenAsync(std::string refreshToken);
+
+    boost::asio::awaitable<json> logoutAsync(std::string accessToken, std::string refreshToken);
+    boost::asio::awaitable<Result<void>> tryLogoutAsync(std::string accessToken, std::string refreshToken);
+
+    /**
+     * The blocking service the coroutines delegate to
+     */
+    AuthService& blocking();
+
+private:
+    AuthService auth;
+    boost::asio::thread_pool computePool;
+    boost::asio::thread_pool ioPool;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_ASYNC_AUTH_SERVICE_H
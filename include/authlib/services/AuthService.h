@@ -5,13 +5,19 @@
 #ifndef AUTHLIB_AUTH_SERVICE_H
 #define AUTHLIB_AUTH_SERVICE_H
 
+#include <memory>
 #include <string>
 #include <nlohmann/json.hpp>
 #include <authlib/models/User.h>
 #include <authlib/database/Database.h>
 #include <authlib/services/UserService.h>
 #include <authlib/utils/JWTHandler.h>
+#include <authlib/utils/JsonWriter.h>
+#include <authlib/utils/PasswordHandler.h>
+#include <authlib/utils/PasswordPolicy.h>
+#include <authlib/utils/Result.h>
 #include <authlib/config/Config.h>
+#include <authlib/config/ConfigStore.h>
 
 using json = nlohmann::json;
 
@@ -29,6 +35,11 @@ struct LoginInput {
     std::string password;
 };
 
+struct TokenPair {
+    std::string accessToken;
+    std::string refreshToken;
+};
+
 struct AuthResponse {
     bool success;
     User user;
@@ -36,45 +47,102 @@ struct AuthResponse {
     std::string refreshToken;
 
     json toJson() const;
+
+    /**
+     * toJson() as text, appended to `out` with a single reservation, for
+     * handlers that send the response body straight on
+     */
+    void appendJson(std::string& out) const;
+    void writeJson(JsonWriter& writer) const;
 };
 
+/**
+ * Thread-safe: one instance can serve any number of threads. Everything it
+ * owns is immutable after construction (password and policy settings, the
+ * config store's snapshots) or per-thread (database connections, random
+ * buffers, hashing scratch memory), so calls take no lock in the service
+ * itself. Token calls read settings through ConfigStore::view(), which
+ * writes nothing shared while the store is in the thread's cache (see
+ * TenantRegistry for the many-tenant case); a snapshot() copy would bump
+ * a reference count every thread shares.
+ *
+ * Each hot operation also comes as a try* variant that returns expected
+ * failures (bad input, wrong password, unknown email, bad or revoked
+ * token) as a Result instead of throwing them; the throwing versions
+ * wrap these. Under credential stuffing most logins fail, and a returned
+ * error skips the unwinding an exception costs. Infrastructure failures
+ * such as DatabaseError are still thrown.
+ */
 class AuthService {
 public:
+    /**
+     * Uses a private copy of `config`
+     */
     AuthService(Database& database, const Config& config = Config());
 
+    /**
+     * JWT settings follow the store's snapshots, so publishing a new
+     * secret rotates keys without a restart. Password hashing, the
+     * password policy and email canonicalization are fixed at
+     * construction. A non-empty `tenantId` is stamped into every token
+     * and required back on verification (see TenantRegistry).
+     */
+    AuthService(Database& database, std::shared_ptr<ConfigStore> configStore, const std::string& tenantId = "");
+
     /**
      * Register a new user
      */
     AuthResponse registerUser(const RegisterInput& input);
+    Result<AuthResponse> tryRegisterUser(const RegisterInput& input);
 
     /**
-     * Login user
+     * Login user. An unknown email is ErrorCode::UserNotFound, a wrong
+     * password or deactivated account InvalidCredentials.
      */
     AuthResponse login(const LoginInput& input);
+    Result<AuthResponse> tryLogin(const LoginInput& input);
 
     /**
      * Verify access token
      */
     TokenPayload verifyToken(const std::string& token);
+    Result<TokenPayload> tryVerifyToken(const std::string& token);
 
     /**
-     * Refresh access token
+     * Refresh access token: {"accessToken": ...}, or the bare token from
+     * the try variant
      */
     json refreshAccessToken(const std::string& refreshToken);
+    Result<std::string> tryRefreshAccessToken(const std::string& refreshToken);
 
     /**
-     * Logout user (blacklist tokens)
+     * Logout user (blacklist tokens). Both tokens must verify, the first
+     * as an access token and the second as a refresh token of the same
+     * user; anything else is ErrorCode::InvalidToken.
      */
     json logout(const std::string& accessToken, const std::string& refreshToken);
+    Result<void> tryLogout(const std::string& accessToken, const std::string& refreshToken);
 
 private:
+    // Runs the same steps as login/registerUser, split across its pools
+    friend class AsyncAuthService;
+
     Database& database;
+    std::shared_ptr<ConfigStore> configStore;
+    PasswordHandler passwordHandler;
+    std::shared_ptr<const PasswordPolicy> passwordPolicy;
     UserService userService;
     JWTHandler jwtHandler;
-    PasswordHandler passwordHandler;
-    const Config& config;
 
-    json generateTokens(const User& user);
+    // The steps of the try* calls that can fail, shared with
+    // AsyncAuthService so both report the same errors
+    Result<void> validateLogin(const LoginInput& input);
+    Result<User> findActiveUser(const std::string& email);
+    Result<void> checkPassword(const std::string& password, const User& user);
+    Result<User> insertNewUser(const CreateUserInput& input, const std::string& passwordHash);
+    Result<TokenPayload> verifyRefreshToken(const std::string& refreshToken);
+
+    TokenPair generateTokens(const User& user);
     json userToResponse(const User& user);
 };
 
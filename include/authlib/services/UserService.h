@@ -5,9 +5,15 @@
 #ifndef AUTHLIB_USER_SERVICE_H
 #define AUTHLIB_USER_SERVICE_H
 
+#include <memory>
+#include <optional>
 #include <string>
 #include <authlib/models/User.h>
 #include <authlib/database/Database.h>
+#include <authlib/utils/EmailCanonicalizer.h>
+#include <authlib/utils/PasswordHandler.h>
+#include <authlib/utils/PasswordPolicy.h>
+#include <authlib/utils/Result.h>
 
 namespace authlib {
 
@@ -18,25 +24,52 @@ struct CreateUserInput {
     std::string lastName;
 };
 
+/**
+ * Thread-safe as long as `database` is; activate/deactivate/verify are
+ * read-modify-write and last-writer-wins against each other
+ */
 class UserService {
 public:
-    explicit UserService(Database& database);
+    /**
+     * `passwordPolicy` defaults to PasswordValidator's built-in rules;
+     * `emailCanonicalizer` must match the one the users were written with
+     */
+    explicit UserService(
+        Database& database,
+        const PasswordHandler& passwordHandler = PasswordHandler(),
+        std::shared_ptr<const PasswordPolicy> passwordPolicy = nullptr,
+        const EmailCanonicalizer& emailCanonicalizer = EmailCanonicalizer()
+    );
 
     /**
      * Create a new user
      */
     User createUser(const CreateUserInput& input);
 
+    /**
+     * createUser in two steps, for callers that hash the password
+     * elsewhere: validate the input and check the email is free, then
+     * insert with a hash from PasswordHandler::hashPassword
+     */
+    void checkNewUser(const CreateUserInput& input);
+    Result<void> tryCheckNewUser(const CreateUserInput& input);
+    User insertUser(const CreateUserInput& input, const std::string& passwordHash);
+
     /**
      * Get user by ID
      */
     User getUserById(uint32_t userId);
 
     /**
-     * Get user by email
+     * Get user by email, matched on its canonical form
      */
     User getUserByEmail(const std::string& email);
 
+    /**
+     * getUserByEmail with no exception for a missing user
+     */
+    std::optional<User> tryGetUserByEmail(const std::string& email);
+
     /**
      * Update user
      */
@@ -62,8 +95,16 @@ public:
      */
     User updateLastLogin(uint32_t userId);
 
+    /**
+     * Replace the stored password hash
+     */
+    User updatePasswordHash(uint32_t userId, const std::string& passwordHash);
+
 private:
     Database& database;
+    PasswordHandler passwordHandler;
+    std::shared_ptr<const PasswordPolicy> passwordPolicy;
+    EmailCanonicalizer emailCanonicalizer;
 };
 
 } // namespace authlib
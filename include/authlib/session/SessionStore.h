@@ -0,0 +1,150 @@
+/**
+ * In-memory opaque session store with timing-wheel expiry
+ */
+
+#ifndef AUTHLIB_SESSION_STORE_H
+#define AUTHLIB_SESSION_STORE_H
+
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <authlib/config/Config.h>
+#include <authlib/database/Database.h>
+#include <authlib/models/Session.h>
+
+namespace authlib {
+
+namespace detail {
+class SessionShard;
+}
+
+struct SessionStoreOptions {
+    uint32_t shards = 64;           // rounded up to a power of two
+    uint32_t ttlSeconds = 86400;
+    uint32_t sweepIntervalMs = 1000; // 0: no background thread, call expire()/flush() yourself
+    bool persist = false;            // write-behind to the Database given to the store
+    std::function<std::time_t()> clock; // defaults to std::time; tests substitute a fake
+
+    /**
+     * Options from SESSION_SHARDS, SESSION_TTL_SECONDS,
+     * SESSION_SWEEP_INTERVAL_MS and SESSION_PERSIST
+     */
+    static SessionStoreOptions fromConfig(const Config& config);
+};
+
+/**
+ * Server-side sessions for deployments that want instant revocation and
+ * no signature check per request. A session id is 32 bytes from
+ * SecureRandom, handed out as 43 characters of URL-safe base64; the store
+ * keys on the raw bytes, so validating is a decode, a hash that just reads
+ * the first 8 random bytes, and a lookup in one of `shards` independently
+ * locked maps. No HMAC, no database.
+ *
+ * Expiry runs on a hierarchical timing wheel per shard (4 levels of 64
+ * one-second slots, about 194 days of range): scheduling and expiring are
+ * O(1) per session, instead of a scan of every session each sweep.
+ * touch() only moves expiresAt; the session's one wheel entry is
+ * rescheduled when it comes due, however often the session was touched.
+ * Entries of revoked sessions are dropped as their slot comes due.
+ * validate() checks expiresAt itself, so a session is never accepted
+ * late between sweeps.
+ *
+ * Memory on 64-bit libstdc++, per live session: about 112 bytes for the
+ * map node (32-byte key, 56-byte record, link and cached hash, malloc
+ * rounding), 8 for its bucket and 32 for its wheel entry, so ~150 bytes,
+ * plus the metadata beyond 15 characters (the small-string buffer).
+ *
+ * With `persist`, creates, touches and revocations are queued per shard
+ * and written by flush() (on the sweep thread, every sweep interval) in
+ * one transaction, and restore() reloads the unexpired sessions at
+ * startup. Whatever was queued in the last interval before a crash is
+ * lost: a lost create logs that user out, a lost revoke resurrects the
+ * session until restart plus expiry, so call flush() after revoking when
+ * that matters. The database holds raw ids; protect it like the process
+ * memory.
+ */
+class SessionStore {
+public:
+    explicit SessionStore(const SessionStoreOptions& options = SessionStoreOptions(), Database* database = nullptr);
+
+    ~SessionStore();
+
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    /**
+     * Start a session; returns the id to hand to the client. `ttlSeconds`
+     * of 0 means the store's default.
+     */
+    std::string create(uint32_t userId, const std::string& metadata = "", uint32_t ttlSeconds = 0);
+
+    /**
+     * Whether `sessionId` names a live session; copies it to `session`
+     * when given. Malformed ids are simply not found.
+     */
+    bool validate(const std::string& sessionId, Session* session = nullptr) const;
+
+    /**
+     * Push expiry out to now + ttl (sliding sessions). False if the
+     * session is gone.
+     */
+    bool touch(const std::string& sessionId, uint32_t ttlSeconds = 0);
+
+    /**
+     * End a session. False if it was already gone.
+     */
+    bool revoke(const std::string& sessionId);
+
+    /**
+     * End every session of `userId`, e.g. after a password change. Scans
+     * all shards.
+     */
+    size_t revokeUser(uint32_t userId);
+
+    size_t size() const;
+
+    /**
+     * Advance the timing wheels to the clock and drop what expired;
+     * returns how many sessions went. The sweep thread calls this.
+     */
+    size_t expire();
+
+    /**
+     * Write queued changes to the database (no-op without `persist`).
+     * The sweep thread calls this; a failed write is requeued and
+     * rethrown. Concurrent calls run one after another, so a caller's
+     * flush is never overtaken by an older one.
+     */
+    void flush();
+
+    /**
+     * Load the database's unexpired sessions into memory; returns how many
+     */
+    size_t restore();
+
+private:
+    SessionStoreOptions options;
+    Database* database;
+    std::vector<std::unique_ptr<detail::SessionShard>> shards;
+    size_t shardMask;
+
+    std::mutex flushMutex;
+
+    std::mutex sweepMutex;
+    std::condition_variable sweepWake;
+    bool stopping;
+    std::thread sweeper;
+
+    std::time_t now() const;
+    detail::SessionShard& shardFor(const unsigned char* key) const;
+    void sweepLoop();
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_SESSION_STORE_H
@@ -0,0 +1,177 @@
+/**
+ * Header-only client for the token verification sidecar (POSIX, no dependencies)
+ */
+
+#ifndef AUTHLIB_VERIFY_CLIENT_H
+#define AUTHLIB_VERIFY_CLIENT_H
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <authlib/sidecar/VerifyProtocol.h>
+
+namespace authlib {
+namespace sidecar {
+
+namespace wire {
+#ifdef SOCK_CLOEXEC
+constexpr int SOCKET_FLAGS = SOCK_CLOEXEC;
+#else
+constexpr int SOCKET_FLAGS = 0;
+#endif
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL; // a dead sidecar is an exception, not SIGPIPE
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+} // namespace wire
+
+/**
+ * One connection to authlib_verifyd. Include this header alone: it needs
+ * neither the library nor its dependencies.
+ *
+ *   VerifyClient client("/run/authlib/verify.sock");
+ *   if (client.verify(token).valid()) { ... }
+ *
+ * For throughput, pass many tokens at once (one frame) or pipeline:
+ * send() several batches, then receive() each response in order. Not
+ * thread-safe; use one client per thread. I/O errors throw
+ * std::system_error, protocol errors std::runtime_error.
+ */
+class VerifyClient {
+public:
+    explicit VerifyClient(const std::string& socketPath) {
+        sockaddr_un address{};
+        if (socketPath.size() >= sizeof(address.sun_path)) {
+            throw std::length_error("verify socket path too long: " + socketPath);
+        }
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+        fd = ::socket(AF_UNIX, SOCK_STREAM | wire::SOCKET_FLAGS, 0);
+        if (fd < 0) {
+            throw std::system_error(errno, std::generic_category(), "socket");
+        }
+        if (::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "connect " + socketPath);
+        }
+    }
+
+    ~VerifyClient() {
+        ::close(fd);
+    }
+
+    VerifyClient(const VerifyClient&) = delete;
+    VerifyClient& operator=(const VerifyClient&) = delete;
+
+    VerifyResult verify(const std::string& token) {
+        return verify(std::vector<std::string>{token}).front();
+    }
+
+    /**
+     * One round trip for the whole batch (at most MAX_TOKENS_PER_FRAME)
+     */
+    std::vector<VerifyResult> verify(const std::vector<std::string>& tokens) {
+        uint32_t id = send(tokens);
+        VerifyResponseFrame response = receive();
+        if (response.id != id || response.results.size() != tokens.size()) {
+            throw std::runtime_error("verify protocol: response does not match request");
+        }
+        return std::move(response.results);
+    }
+
+    /**
+     * Queue a batch without waiting; returns the id its response will carry.
+     * Queued frames are written by the next receive() or flush(). A batch
+     * that cannot be encoded throws and leaves the queue and ids untouched.
+     */
+    uint32_t send(const std::vector<std::string>& tokens) {
+        encodeRequest(output, nextId, tokens);
+        return nextId++;
+    }
+
+    /**
+     * Write every queued frame. Responses that arrive meanwhile are read
+     * into the input buffer, so a pipeline longer than both socket buffers
+     * can't stall against a sidecar waiting for its writes to drain.
+     */
+    void flush() {
+        size_t written = 0;
+        while (written < output.size()) {
+            pollfd ready{fd, POLLIN | POLLOUT, 0};
+            if (::poll(&ready, 1, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "poll");
+            }
+            if (ready.revents & POLLIN) {
+                readSome(MSG_DONTWAIT);
+            }
+            if (!(ready.revents & (POLLOUT | POLLERR | POLLHUP))) {
+                continue;
+            }
+            ssize_t n = ::send(fd, output.data() + written, output.size() - written, wire::SEND_FLAGS | MSG_DONTWAIT);
+            if (n < 0) {
+                if (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "send");
+            }
+            written += static_cast<size_t>(n);
+        }
+        output.clear();
+    }
+
+    /**
+     * The next response, in the order the batches were sent
+     */
+    VerifyResponseFrame receive() {
+        flush();
+        size_t frameSize;
+        while ((frameSize = completeFrameSize(input.data(), input.size())) == 0) {
+            readSome(0);
+        }
+        VerifyResponseFrame response = decodeResponse(input.data(), frameSize);
+        input.erase(0, frameSize);
+        return response;
+    }
+
+private:
+    int fd;
+    uint32_t nextId = 1;
+    std::string output;
+    std::string input;
+
+    // Appends what one recv returns to input; with MSG_DONTWAIT, nothing
+    // when no data is waiting
+    void readSome(int flags) {
+        char buffer[16384];
+        ssize_t n;
+        while ((n = ::recv(fd, buffer, sizeof(buffer), flags)) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            if (errno != EINTR) {
+                throw std::system_error(errno, std::generic_category(), "recv");
+            }
+        }
+        if (n == 0) {
+            throw std::runtime_error("verify sidecar closed the connection");
+        }
+        input.append(buffer, static_cast<size_t>(n));
+    }
+};
+
+} // namespace sidecar
+} // namespace authlib
+
+#endif // AUTHLIB_VERIFY_CLIENT_H
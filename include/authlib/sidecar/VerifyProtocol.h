@@ -0,0 +1,245 @@
+/**
+ * Wire format of the token verification sidecar (header-only, no dependencies)
+ */
+
+#ifndef AUTHLIB_VERIFY_PROTOCOL_H
+#define AUTHLIB_VERIFY_PROTOCOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace authlib {
+namespace sidecar {
+
+/*
+ * Every frame, in both directions, is
+ *
+ *   u32 payload length | u32 request id | u16 count | count entries
+ *
+ * with integers little-endian. A request entry is `u16 length, token
+ * bytes`; a response entry is `u8 status, u8 type, u32 userId, u32 exp,
+ * u16 length, email bytes`. Responses carry the request's id and come
+ * back in request order, so a client may pipeline any number of frames
+ * before reading.
+ */
+
+constexpr size_t FRAME_HEADER_BYTES = 10;
+constexpr uint32_t MAX_FRAME_BYTES = 1u << 20;
+constexpr uint16_t MAX_TOKENS_PER_FRAME = 2048;
+
+enum class VerifyStatus : uint8_t {
+    Valid = 0,
+    Invalid = 1,     // bad signature, expired or malformed
+    Revoked = 2,     // valid but blacklisted by logout
+    Unavailable = 3  // the revocation check failed; treat as not verified
+};
+
+struct VerifyResult {
+    VerifyStatus status = VerifyStatus::Invalid;
+    bool refresh = false; // token type: refresh or access
+    uint32_t userId = 0;
+    uint32_t expiresAt = 0;
+    std::string email;
+
+    bool valid() const {
+        return status == VerifyStatus::Valid;
+    }
+};
+
+struct VerifyFrame {
+    uint32_t id = 0;
+    std::vector<std::string> tokens;
+};
+
+struct VerifyResponseFrame {
+    uint32_t id = 0;
+    std::vector<VerifyResult> results;
+};
+
+namespace wire {
+
+inline void putU16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xff));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+inline void putU32(std::string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+class Reader {
+public:
+    Reader(const char* data, size_t size) : position(reinterpret_cast<const unsigned char*>(data)), end(position + size) {}
+
+    uint16_t u16() {
+        need(2);
+        uint16_t value = static_cast<uint16_t>(position[0] | (position[1] << 8));
+        position += 2;
+        return value;
+    }
+
+    uint32_t u32() {
+        need(4);
+        uint32_t value = 0;
+        for (int i = 3; i >= 0; --i) {
+            value = (value << 8) | position[i];
+        }
+        position += 4;
+        return value;
+    }
+
+    uint8_t u8() {
+        need(1);
+        return *position++;
+    }
+
+    std::string bytes(size_t count) {
+        need(count);
+        std::string value(reinterpret_cast<const char*>(position), count);
+        position += count;
+        return value;
+    }
+
+    bool done() const {
+        return position == end;
+    }
+
+private:
+    const unsigned char* position;
+    const unsigned char* end;
+
+    void need(size_t count) const {
+        if (static_cast<size_t>(end - position) < count) {
+            throw std::runtime_error("verify protocol: truncated frame");
+        }
+    }
+};
+
+// Appends the frame header; the caller appends `count` entries, then
+// calls finishFrame with the header's offset
+inline size_t beginFrame(std::string& out, uint32_t id, uint16_t count) {
+    size_t start = out.size();
+    putU32(out, 0);
+    putU32(out, id);
+    putU16(out, count);
+    return start;
+}
+
+inline void finishFrame(std::string& out, size_t start) {
+    uint32_t length = static_cast<uint32_t>(out.size() - start - 4);
+    if (length > MAX_FRAME_BYTES) {
+        throw std::length_error("verify protocol: frame exceeds MAX_FRAME_BYTES");
+    }
+    for (int i = 0; i < 4; ++i) {
+        out[start + i] = static_cast<char>((length >> (8 * i)) & 0xff);
+    }
+}
+
+} // namespace wire
+
+/**
+ * Bytes of the first frame in `data` when it has fully arrived, else 0.
+ * Throws std::runtime_error on a length no peer would send.
+ */
+inline size_t completeFrameSize(const char* data, size_t size) {
+    if (size < 4) {
+        return 0;
+    }
+    uint32_t length = wire::Reader(data, 4).u32();
+    if (length < FRAME_HEADER_BYTES - 4 || length > MAX_FRAME_BYTES) {
+        throw std::runtime_error("verify protocol: bad frame length");
+    }
+    return size >= 4 + size_t(length) ? 4 + size_t(length) : 0;
+}
+
+/**
+ * Appends one frame to out. Throws std::length_error before writing
+ * anything, so out never holds a partial frame.
+ */
+inline void encodeRequest(std::string& out, uint32_t id, const std::vector<std::string>& tokens) {
+    if (tokens.size() > MAX_TOKENS_PER_FRAME) {
+        throw std::length_error("verify protocol: too many tokens in one frame");
+    }
+    size_t length = FRAME_HEADER_BYTES - 4;
+    for (const auto& token : tokens) {
+        if (token.size() > 0xffff) {
+            throw std::length_error("verify protocol: token too long");
+        }
+        length += 2 + token.size();
+    }
+    if (length > MAX_FRAME_BYTES) {
+        throw std::length_error("verify protocol: frame exceeds MAX_FRAME_BYTES");
+    }
+    size_t start = wire::beginFrame(out, id, static_cast<uint16_t>(tokens.size()));
+    for (const auto& token : tokens) {
+        wire::putU16(out, static_cast<uint16_t>(token.size()));
+        out += token;
+    }
+    wire::finishFrame(out, start);
+}
+
+inline VerifyFrame decodeRequest(const char* frame, size_t size) {
+    wire::Reader reader(frame + 4, size - 4);
+    VerifyFrame request;
+    request.id = reader.u32();
+    uint16_t count = reader.u16();
+    if (count > MAX_TOKENS_PER_FRAME) {
+        throw std::runtime_error("verify protocol: too many tokens in one frame");
+    }
+    request.tokens.reserve(count);
+    for (uint16_t i = 0; i < count; ++i) {
+        request.tokens.push_back(reader.bytes(reader.u16()));
+    }
+    if (!reader.done()) {
+        throw std::runtime_error("verify protocol: trailing bytes in frame");
+    }
+    return request;
+}
+
+inline void encodeResponse(std::string& out, uint32_t id, const std::vector<VerifyResult>& results) {
+    size_t start = wire::beginFrame(out, id, static_cast<uint16_t>(results.size()));
+    for (const auto& result : results) {
+        out.push_back(static_cast<char>(result.status));
+        out.push_back(static_cast<char>(result.refresh ? 1 : 0));
+        wire::putU32(out, result.userId);
+        wire::putU32(out, result.expiresAt);
+        uint16_t emailLength = static_cast<uint16_t>(std::min<size_t>(result.email.size(), 0xffff));
+        wire::putU16(out, emailLength);
+        out.append(result.email, 0, emailLength);
+    }
+    wire::finishFrame(out, start);
+}
+
+inline VerifyResponseFrame decodeResponse(const char* frame, size_t size) {
+    wire::Reader reader(frame + 4, size - 4);
+    VerifyResponseFrame response;
+    response.id = reader.u32();
+    uint16_t count = reader.u16();
+    response.results.resize(count);
+    for (auto& result : response.results) {
+        uint8_t status = reader.u8();
+        if (status > static_cast<uint8_t>(VerifyStatus::Unavailable)) {
+            throw std::runtime_error("verify protocol: unknown status");
+        }
+        result.status = static_cast<VerifyStatus>(status);
+        result.refresh = reader.u8() != 0;
+        result.userId = reader.u32();
+        result.expiresAt = reader.u32();
+        result.email = reader.bytes(reader.u16());
+    }
+    if (!reader.done()) {
+        throw std::runtime_error("verify protocol: trailing bytes in frame");
+    }
+    return response;
+}
+
+} // namespace sidecar
+} // namespace authlib
+
+#endif // AUTHLIB_VERIFY_PROTOCOL_H
@@ -0,0 +1,85 @@
+/**
+ * Token verification over a Unix domain socket (the authlib_verifyd sidecar)
+ */
+
+#ifndef AUTHLIB_VERIFY_SIDECAR_H
+#define AUTHLIB_VERIFY_SIDECAR_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <authlib/config/Config.h>
+#include <authlib/config/ConfigStore.h>
+#include <authlib/database/Database.h>
+#include <authlib/sidecar/VerifyProtocol.h>
+#include <authlib/utils/JWTHandler.h>
+
+namespace authlib {
+
+namespace detail {
+class VerifySidecarLoop;
+}
+
+struct VerifySidecarOptions {
+    std::string socketPath = "/tmp/authlib-verify.sock";
+    uint32_t threads = 1;
+
+    /**
+     * Options from VERIFY_SOCKET_PATH and VERIFY_THREADS
+     */
+    static VerifySidecarOptions fromConfig(const Config& config);
+};
+
+/**
+ * Owns the JWT keys (following the config store, so rotation applies) and
+ * the revocation check, and answers sidecar::VerifyClient frames. Services
+ * that only verify tokens talk to this instead of linking the library or
+ * holding the signing key.
+ *
+ * Each connection reads whatever has arrived, answers every complete
+ * frame in it and writes the responses in one go, so pipelined frames
+ * cost one read and one write between them. Reading continues while a
+ * write is in flight, pausing only once a few MAX_FRAME_BYTES of answers
+ * are waiting for a client that isn't reading. A malformed frame closes
+ * the connection. The socket file is created with the process umask; put it
+ * in a directory only the intended clients can reach.
+ */
+class VerifySidecar {
+public:
+    VerifySidecar(
+        Database& database,
+        std::shared_ptr<ConfigStore> configStore,
+        const VerifySidecarOptions& options = VerifySidecarOptions()
+    );
+
+    ~VerifySidecar();
+
+    VerifySidecar(const VerifySidecar&) = delete;
+    VerifySidecar& operator=(const VerifySidecar&) = delete;
+
+    /**
+     * Replace any stale socket file, listen and start the worker threads.
+     * Throws ConfigError if socketPath names something other than a socket.
+     */
+    void start();
+
+    /**
+     * Stop serving, join the workers and remove the socket file
+     */
+    void stop();
+
+    /**
+     * The answer to one frame, computed in-process. Thread-safe.
+     */
+    std::vector<sidecar::VerifyResult> verify(const std::vector<std::string>& tokens);
+
+private:
+    Database& database;
+    JWTHandler jwtHandler;
+    VerifySidecarOptions options;
+    std::unique_ptr<detail::VerifySidecarLoop> loop;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_VERIFY_SIDECAR_H
@@ -0,0 +1,166 @@
+/**
+ * Many tenants in one process: lazily opened per-tenant stores and keys
+ */
+
+#ifndef AUTHLIB_TENANT_REGISTRY_H
+#define AUTHLIB_TENANT_REGISTRY_H
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <authlib/config/Config.h>
+#include <authlib/config/ConfigStore.h>
+#include <authlib/database/Database.h>
+#include <authlib/services/AuthService.h>
+#include <authlib/utils/JWTHandler.h>
+
+namespace authlib {
+
+/**
+ * Everything that belongs to one tenant: its settings (database, signing
+ * keys, password policy), its Database and an AuthService that stamps the
+ * tenant id into every token it issues. The database is opened (and
+ * created if missing) on the first database() or auth() call; verifying a
+ * token only needs the key and never touches it.
+ */
+class Tenant {
+public:
+    Tenant(const std::string& tenantId, std::shared_ptr<const Config> config);
+
+    Tenant(const Tenant&) = delete;
+    Tenant& operator=(const Tenant&) = delete;
+
+    const std::string& id() const;
+    Database& database();
+    AuthService& auth();
+
+    /**
+     * Signature, expiry and tenant claim against this tenant's keys
+     */
+    TokenPayload verifyToken(const std::string& token);
+
+    /**
+     * Publish here to rotate this tenant's keys
+     */
+    std::shared_ptr<ConfigStore> configStore();
+
+private:
+    std::string tenantId;
+    std::shared_ptr<ConfigStore> store;
+    JWTHandler jwtHandler;
+    Database db;
+    std::once_flag opened;
+    std::unique_ptr<AuthService> authService;
+
+    void open();
+};
+
+/**
+ * Returns the settings for `tenantId`, or throws TenantNotFound
+ */
+using TenantResolver = std::function<std::shared_ptr<const Config>(const std::string& tenantId)>;
+
+struct TenantRegistryOptions {
+    size_t maxOpenTenants = 256;
+    uint32_t idleSeconds = 600; // 0: only close tenants to stay under maxOpenTenants
+
+    /**
+     * Options from TENANT_MAX_OPEN and TENANT_IDLE_SECONDS
+     */
+    static TenantRegistryOptions fromConfig(const Config& config);
+};
+
+/**
+ * Tenant id -> Tenant, opened on first use and kept in an LRU. Opening a
+ * tenant past maxOpenTenants, or touching the registry after a tenant sat
+ * unused for idleSeconds, drops the least recently used ones. A dropped
+ * tenant closes its database files once the last request holding its
+ * shared_ptr finishes, so open files are bounded by roughly
+ * maxOpenTenants x worker threads x DATABASE_SHARDS x 3 (database, WAL
+ * and shared-memory files), and SQLite page cache by the same count of
+ * connections.
+ *
+ * Tokens carry the tenant as their "tid" claim; verifyToken reads it from
+ * the unverified payload, picks that tenant's key, and the JWTHandler
+ * then insists the verified claim matches. Until the signature verifies
+ * the tid only reaches the resolver, never the LRU. No database is
+ * consulted (or opened) to route and verify a token.
+ *
+ * Each tenant reads its settings from its own ConfigStore. Worker threads
+ * cache up to 16 stores for ConfigStore::view(); a thread that cycles
+ * through more tenants than that misses the cache and reloads the
+ * snapshot with an atomic shared_ptr load on most tokens.
+ *
+ * Concurrent first requests for one tenant open it once; others wait for
+ * that open. A failed open is not cached.
+ */
+class TenantRegistry {
+public:
+    explicit TenantRegistry(TenantResolver resolver, const TenantRegistryOptions& options = TenantRegistryOptions());
+
+    TenantRegistry(const TenantRegistry&) = delete;
+    TenantRegistry& operator=(const TenantRegistry&) = delete;
+
+    /**
+     * The tenant, opening it if needed. Throws TenantNotFound, or whatever
+     * opening its database threw.
+     */
+    std::shared_ptr<Tenant> get(const std::string& tenantId);
+
+    /**
+     * Verify with the key of the tenant named in the token. Tokens without
+     * a tenant, or naming an unknown one, are InvalidToken. A tenant that
+     * isn't open is opened only once the token's signature checks out.
+     */
+    TokenPayload verifyToken(const std::string& token);
+
+    /**
+     * Close a tenant so the next request reopens it with fresh settings
+     */
+    void evict(const std::string& tenantId);
+
+    size_t openCount() const;
+
+    /**
+     * A resolver deriving every tenant from one base config:
+     * "{tenant}" in DATABASE_URL is replaced by the tenant id, and each
+     * tenant signs with HMAC-SHA256(JWT_SECRET_KEY, tenant id) so one
+     * tenant's key never verifies another's tokens. Tenant ids are 1-64
+     * characters of [A-Za-z0-9_-]. PBKDF2 calibration
+     * (PASSWORD_HASH_TARGET_MS) runs once here rather than per tenant.
+     */
+    static TenantResolver templateResolver(std::shared_ptr<const Config> base);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry {
+        std::string tenantId;
+        std::shared_future<std::shared_ptr<Tenant>> tenant;
+        Clock::time_point lastUsed;
+        uint64_t generation; // tells a failed open which entry was its own
+    };
+
+    TenantResolver resolver;
+    TenantRegistryOptions options;
+    mutable std::mutex mutex;
+    std::list<Entry> lru; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    uint64_t opens;
+
+    // The open tenant, or `built` (resolved and built here when null)
+    // entered into the LRU in its place
+    std::shared_ptr<Tenant> acquire(const std::string& tenantId, std::shared_ptr<Tenant> built);
+    std::shared_ptr<Tenant> build(const std::string& tenantId);
+    std::shared_future<std::shared_ptr<Tenant>> findOpen(const std::string& tenantId);
+    void evictIdle(Clock::time_point now);
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_TENANT_REGISTRY_H
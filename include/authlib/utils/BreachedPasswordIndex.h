@@ -0,0 +1,74 @@
+/**
+ * Offline lookup of known-breached passwords in a memory-mapped SHA-1 index
+ */
+
+#ifndef AUTHLIB_BREACHED_PASSWORD_INDEX_H
+#define AUTHLIB_BREACHED_PASSWORD_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace authlib {
+
+struct BreachedIndexBuildStats {
+    uint64_t linesRead = 0;
+    uint64_t entries = 0;     // distinct 64-bit keys written
+    uint64_t bloomBytes = 0;
+};
+
+class BreachedPasswordIndex {
+public:
+    /**
+     * Map an index file produced by build(). Nothing is read up front;
+     * pages fault in as lookups touch them.
+     */
+    explicit BreachedPasswordIndex(const std::string& path);
+    ~BreachedPasswordIndex();
+
+    BreachedPasswordIndex(const BreachedPasswordIndex&) = delete;
+    BreachedPasswordIndex& operator=(const BreachedPasswordIndex&) = delete;
+
+    /**
+     * Whether SHA-1(password) is in the corpus. Keys are the first 64 bits
+     * of the digest, so a false positive needs a 2^-64 collision.
+     */
+    bool contains(const std::string& password) const;
+    bool containsSha1(const unsigned char digest[20]) const;
+
+    size_t size() const;
+    bool hasBloomFilter() const;
+
+    /**
+     * Convert a Pwned Passwords style text dump ("<40 hex SHA-1>[:count]"
+     * per line, ordered by hash) into the binary index format. With
+     * `bloomBitsPerEntry` > 0 a blocked Bloom filter is appended so most
+     * misses are answered from a single cache line.
+     */
+    static BreachedIndexBuildStats build(
+        const std::string& textDumpPath,
+        const std::string& outputPath,
+        uint32_t bloomBitsPerEntry = 0
+    );
+
+private:
+    const unsigned char* base = nullptr;
+    size_t length = 0;
+    const unsigned char* fanout = nullptr;
+    const unsigned char* entries = nullptr;
+    const unsigned char* bloom = nullptr;
+    uint64_t entryCount = 0;
+    uint64_t bloomBlocks = 0;
+    uint32_t bloomHashes = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+
+    bool containsKey(uint64_t key) const;
+    void unmap();
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_BREACHED_PASSWORD_INDEX_H
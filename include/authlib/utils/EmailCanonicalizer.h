@@ -0,0 +1,49 @@
+/**
+ * Canonical form of an email address, used as the lookup key for users
+ */
+
+#ifndef AUTHLIB_EMAIL_CANONICALIZER_H
+#define AUTHLIB_EMAIL_CANONICALIZER_H
+
+#include <cstdint>
+#include <string>
+#include <authlib/config/Config.h>
+
+namespace authlib {
+
+struct EmailCanonicalizerOptions {
+    bool foldLocalPart = true;  // treat Foo@x and foo@x as one mailbox
+    bool providerRules = false; // Gmail dots, "+tag" suffixes and domain aliases
+};
+
+class EmailCanonicalizer {
+public:
+    explicit EmailCanonicalizer(const EmailCanonicalizerOptions& options = EmailCanonicalizerOptions());
+
+    /**
+     * Canonicalizer from EMAIL_FOLD_LOCAL_PART and EMAIL_PROVIDER_RULES
+     */
+    static EmailCanonicalizer fromConfig(const Config& config);
+
+    /**
+     * Domain lower-cased with any trailing dot dropped; the local part
+     * folded and rewritten per the options. Two addresses that reach the
+     * same mailbox map to the same string.
+     */
+    std::string canonicalize(const std::string& email) const;
+
+    /**
+     * Stable 64-bit key for a canonical address (FNV-1a with a murmur3
+     * finalizer). Persisted, so the function must never change.
+     */
+    static uint64_t hash(const std::string& canonical) noexcept;
+
+    const EmailCanonicalizerOptions& getOptions() const;
+
+private:
+    EmailCanonicalizerOptions options;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_EMAIL_CANONICALIZER_H
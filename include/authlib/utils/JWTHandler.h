@@ -5,9 +5,12 @@
 #ifndef AUTHLIB_JWT_HANDLER_H
 #define AUTHLIB_JWT_HANDLER_H
 
+#include <memory>
 #include <string>
 #include <nlohmann/json.hpp>
 #include <authlib/config/Config.h>
+#include <authlib/config/ConfigStore.h>
+#include <authlib/utils/Result.h>
 
 using json = nlohmann::json;
 
@@ -17,14 +20,27 @@ struct TokenPayload {
     uint32_t userId;
     std::string email;
     std::string type; // "access" or "refresh"
+    std::string jti;  // unique token id
+    std::string tenantId; // "tid" claim, empty outside multi-tenant setups
     uint32_t iat = 0; // issued at
     uint32_t exp = 0; // expiration
 };
 
 class JWTHandler {
 public:
+    /**
+     * Uses a private copy of `config`
+     */
     explicit JWTHandler(const Config& config);
 
+    /**
+     * Reads the secret and expiry settings from the store's current
+     * snapshot on every call, so a publish takes effect immediately. With
+     * a `tenantId`, tokens carry it as the "tid" claim and verifyToken
+     * rejects tokens of any other tenant.
+     */
+    explicit JWTHandler(std::shared_ptr<ConfigStore> configStore, std::string tenantId = "");
+
     /**
      * Create an access token
      */
@@ -44,19 +60,34 @@ public:
     );
 
     /**
-     * Verify and decode a token
+     * Verify and decode a token. Tokens signed with JWT_PREVIOUS_SECRET_KEY
+     * are accepted until JWT_PREVIOUS_SECRET_EXPIRES_AT.
      */
     TokenPayload verifyToken(const std::string& token);
 
+    /**
+     * verifyToken returning ErrorCode::InvalidToken instead of throwing
+     */
+    Result<TokenPayload> tryVerifyToken(const std::string& token);
+
     /**
      * Decode token without verification (for inspection)
      */
     TokenPayload decodeToken(const std::string& token);
 
+    /**
+     * The unverified "tid" claim ("" if absent), for picking which
+     * tenant's key to verify with. Throws InvalidToken if the token
+     * doesn't decode.
+     */
+    static std::string tenantOf(const std::string& token);
+
 private:
-    const Config& config;
+    std::shared_ptr<ConfigStore> configStore;
+    std::string tenantId;
 
     std::string createToken(
+        const Config& config,
         uint32_t userId,
         const std::string& email,
         const std::string& type,
@@ -0,0 +1,59 @@
+/**
+ * Streaming JSON writer that appends straight to a std::string
+ */
+
+#ifndef AUTHLIB_JSON_WRITER_H
+#define AUTHLIB_JSON_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace authlib {
+
+/**
+ * Writes JSON text without building a tree; the only allocations are the
+ * output string growing, so reserve() it up front for one allocation in
+ * total. Commas are inserted automatically. Keys are written as given
+ * and must not need escaping (they are always literals here); string
+ * values are escaped.
+ *
+ *   JsonWriter writer(out);
+ *   writer.beginObject().key("id").number(7).key("email").string(email).endObject();
+ *
+ * Nothing checks that calls are balanced; callers write well-formed
+ * sequences.
+ */
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out(out) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    JsonWriter& key(std::string_view name);
+
+    JsonWriter& string(std::string_view value);
+    JsonWriter& number(int64_t value);
+    JsonWriter& number(uint64_t value);
+    JsonWriter& boolean(bool value);
+    JsonWriter& null();
+
+    /**
+     * `value` as a quoted JSON string: quote, backslash and control
+     * characters escaped, everything else (including UTF-8) copied
+     */
+    static void appendEscaped(std::string& out, std::string_view value);
+
+private:
+    std::string& out;
+    bool needsComma = false;
+
+    void separate();
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_JSON_WRITER_H
@@ -5,29 +5,101 @@
 #ifndef AUTHLIB_PASSWORD_HANDLER_H
 #define AUTHLIB_PASSWORD_HANDLER_H
 
+#include <chrono>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace authlib {
 
+enum class PasswordAlgorithm {
+    Pbkdf2Sha256,
+    Argon2id
+};
+
+struct PasswordHashParams {
+    PasswordAlgorithm algorithm = PasswordAlgorithm::Pbkdf2Sha256;
+    uint32_t iterations = 10000;   // PBKDF2 rounds
+    uint32_t memoryKiB = 65536;    // Argon2id m
+    uint32_t timeCost = 3;         // Argon2id t
+    uint32_t parallelism = 1;      // Argon2id p
+};
+
 class PasswordHandler {
 public:
+    static constexpr uint32_t DEFAULT_ITERATIONS = 10000;
+    static constexpr uint32_t MIN_ITERATIONS = 10000;
+
+    PasswordHandler();
+    explicit PasswordHandler(uint32_t iterations);
+    explicit PasswordHandler(const PasswordHashParams& params);
+
+    /**
+     * Hash a password with the configured algorithm. Returns a PHC string:
+     *   $pbkdf2-sha256$i=<iterations>$<salt>$<hash>
+     *   $argon2id$v=19$m=<KiB>,t=<passes>,p=<lanes>$<salt>$<hash>
+     */
+    std::string hashPassword(const std::string& password) const;
+
+    /**
+     * Hash many passwords at once, each with its own salt. PBKDF2 runs
+     * several chains in parallel SIMD lanes, so throughput per core is a
+     * multiple of calling hashPassword in a loop; results are identical in
+     * format and verify the same way.
+     */
+    std::vector<std::string> hashPasswordBatch(const std::vector<std::string>& passwords) const;
+
+    /**
+     * Verify a password against any supported PHC hash string (constant-time compare)
+     */
+    bool verifyPassword(const std::string& password, const std::string& hash) const;
+
+    /**
+     * Check if a hash was produced with an algorithm or parameters other than
+     * the current policy
+     */
+    bool needsRehashing(const std::string& hash) const;
+
+    /**
+     * Iteration count used for new PBKDF2 hashes
+     */
+    uint32_t getIterations() const;
+
+    const PasswordHashParams& getParams() const;
+
+    /**
+     * Whether this build can hash with `algorithm` (Argon2id needs libargon2)
+     */
+    static bool isAlgorithmAvailable(PasswordAlgorithm algorithm);
+
+    /**
+     * Map a PHC algorithm id ("pbkdf2-sha256", "argon2id") to the enum
+     */
+    static PasswordAlgorithm algorithmFromName(const std::string& name);
+
     /**
-     * Hash a password using bcrypt
+     * SIMD kernel used by hashPasswordBatch on this CPU ("avx512", "sha-ni",
+     * "avx2", "sse2" or "openssl")
      */
-    std::string hashPassword(const std::string& password);
+    static std::string batchBackend();
 
     /**
-     * Verify a password against a hash
+     * Free the calling thread's Argon2 scratch arena. Workers keep their
+     * arena between hashes; call this from a thread that will stop hashing.
      */
-    bool verifyPassword(const std::string& password, const std::string& hash);
+    static void releaseScratchMemory();
 
     /**
-     * Check if a password needs rehashing
+     * Measure this host and return the PBKDF2 iteration count whose hash
+     * time is closest to `target`, never less than `floor`
      */
-    bool needsRehashing(const std::string& hash);
+    static uint32_t calibrateIterations(
+        std::chrono::milliseconds target,
+        uint32_t floor = MIN_ITERATIONS
+    );
 
 private:
-    static constexpr int SALT_ROUNDS = 12;
+    PasswordHashParams params;
 };
 
 } // namespace authlib
@@ -0,0 +1,129 @@
+/**
+ * Bounded worker pool for off-thread password hashing
+ */
+
+#ifndef AUTHLIB_PASSWORD_HASH_POOL_H
+#define AUTHLIB_PASSWORD_HASH_POOL_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <authlib/config/Config.h>
+#include <authlib/utils/PasswordHandler.h>
+
+namespace authlib {
+
+struct HashPoolStats {
+    size_t workers = 0;
+    size_t queueCapacity = 0;
+    size_t queueDepth = 0;          // tasks waiting for a worker right now
+    uint64_t submitted = 0;
+    uint64_t rejected = 0;          // fast-failed because the queue was full
+    uint64_t completed = 0;
+    uint64_t totalWaitMicros = 0;   // enqueue -> worker pickup
+    uint64_t maxWaitMicros = 0;
+    uint64_t totalServiceMicros = 0; // worker pickup -> done
+    uint64_t maxServiceMicros = 0;
+
+    double meanWaitMicros() const;
+    double meanServiceMicros() const;
+};
+
+class PasswordHashPool {
+public:
+    using HashCallback = std::function<void(std::string hash, std::exception_ptr error)>;
+    using VerifyCallback = std::function<void(bool matches, std::exception_ptr error)>;
+
+    /**
+     * Start `workers` threads (0 = hardware concurrency) sharing a queue
+     * that holds at most `queueCapacity` pending tasks
+     */
+    PasswordHashPool(
+        size_t workers,
+        size_t queueCapacity,
+        PasswordHandler handler = PasswordHandler()
+    );
+
+    /**
+     * Sized from PASSWORD_HASH_POOL_WORKERS and
+     * PASSWORD_HASH_POOL_QUEUE_CAPACITY
+     */
+    explicit PasswordHashPool(const Config& config, PasswordHandler handler = PasswordHandler());
+
+    ~PasswordHashPool();
+
+    PasswordHashPool(const PasswordHashPool&) = delete;
+    PasswordHashPool& operator=(const PasswordHashPool&) = delete;
+
+    /**
+     * Hash a password on a worker thread.
+     * Throws HashQueueFull immediately if the queue is at capacity.
+     */
+    std::future<std::string> hashAsync(const std::string& password);
+
+    /**
+     * Hash a password on a worker thread and invoke `callback` there
+     */
+    void hashAsync(const std::string& password, HashCallback callback);
+
+    /**
+     * Verify a password on a worker thread.
+     * Throws HashQueueFull immediately if the queue is at capacity.
+     */
+    std::future<bool> verifyAsync(const std::string& password, const std::string& hash);
+
+    /**
+     * Verify a password on a worker thread and invoke `callback` there
+     */
+    void verifyAsync(const std::string& password, const std::string& hash, VerifyCallback callback);
+
+    /**
+     * Snapshot of queue depth and latency counters
+     */
+    HashPoolStats stats() const;
+
+    /**
+     * Stop accepting work, finish queued tasks and join the workers
+     */
+    void shutdown();
+
+private:
+    struct Task {
+        std::function<void()> run;
+        std::chrono::steady_clock::time_point enqueuedAt;
+    };
+
+    PasswordHandler handler;
+    size_t queueCapacity;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;
+    std::deque<Task> queue;
+    bool stopping;
+    std::vector<std::thread> threads;
+
+    std::atomic<uint64_t> submitted;
+    std::atomic<uint64_t> rejected;
+    std::atomic<uint64_t> completed;
+    std::atomic<uint64_t> totalWaitMicros;
+    std::atomic<uint64_t> maxWaitMicros;
+    std::atomic<uint64_t> totalServiceMicros;
+    std::atomic<uint64_t> maxServiceMicros;
+
+    void submit(std::function<void()> work);
+    void workerLoop();
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_PASSWORD_HASH_POOL_H
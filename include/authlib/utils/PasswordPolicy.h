@@ -0,0 +1,99 @@
+/**
+ * Configurable password policy, compiled once into a single-pass checker
+ */
+
+#ifndef AUTHLIB_PASSWORD_POLICY_H
+#define AUTHLIB_PASSWORD_POLICY_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <authlib/config/Config.h>
+#include <authlib/utils/BreachedPasswordIndex.h>
+
+namespace authlib {
+
+enum class PolicyViolation {
+    TooShort,
+    TooLong,
+    MissingUppercase,
+    MissingLowercase,
+    MissingDigit,
+    MissingSpecial,
+    ForbiddenSubstring,
+    DictionaryWord,
+    ContainsEmail,
+    Breached
+};
+
+struct PasswordPolicyOptions {
+    size_t minLength = 8;
+    size_t maxLength = 128;
+    bool requireUppercase = true;
+    bool requireLowercase = true;
+    bool requireDigit = true;
+    bool requireSpecial = true;
+    bool forbidEmailLocalPart = true;           // local parts shorter than 3 are ignored
+    std::vector<std::string> forbiddenSubstrings; // case-insensitive, anywhere in the password
+    std::vector<std::string> dictionary;          // case-insensitive, whole password
+    std::shared_ptr<const BreachedPasswordIndex> breachedPasswords;
+};
+
+class PasswordPolicy {
+public:
+    explicit PasswordPolicy(const PasswordPolicyOptions& options = PasswordPolicyOptions());
+
+    /**
+     * Policy from PASSWORD_MIN_LENGTH, PASSWORD_REQUIRE_*,
+     * PASSWORD_FORBIDDEN_SUBSTRINGS, PASSWORD_DICTIONARY_PATH and
+     * PASSWORD_BREACHED_INDEX_PATH
+     */
+    static std::shared_ptr<const PasswordPolicy> fromConfig(const Config& config);
+
+    /**
+     * Every rule `password` breaks, in declaration order (empty when it
+     * passes). `email` feeds the ContainsEmail rule. Safe to call from any
+     * number of threads.
+     */
+    std::vector<PolicyViolation> check(const std::string& password, const std::string& email = "") const;
+
+    /**
+     * Throws ValidationError listing every violation
+     */
+    void validate(const std::string& password, const std::string& email = "") const;
+
+    /**
+     * The message validate() would throw, empty when `password` passes
+     */
+    std::string violationMessage(const std::string& password, const std::string& email = "") const;
+
+    std::string describe(PolicyViolation violation) const;
+
+    const PasswordPolicyOptions& getOptions() const;
+
+private:
+    PasswordPolicyOptions options;
+    uint8_t requiredClasses = 0;
+
+    // Aho-Corasick automaton over case-folded forbidden substrings, as a
+    // dense table of [state][byte class] -> state
+    std::array<uint8_t, 256> byteClass{};
+    size_t classCount = 1;
+    std::vector<uint32_t> transitions;
+    std::vector<uint8_t> accepting;
+
+    // FNV-1a of each case-folded dictionary word, sorted, with its index
+    std::vector<std::pair<uint64_t, uint32_t>> dictionaryHashes;
+    std::vector<std::string> dictionaryWords;
+
+    void compileSubstrings();
+    void compileDictionary();
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_PASSWORD_POLICY_H
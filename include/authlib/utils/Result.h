@@ -0,0 +1,148 @@
+/**
+ * Error-code results for the exception-free API variants
+ */
+
+#ifndef AUTHLIB_RESULT_H
+#define AUTHLIB_RESULT_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <authlib/utils/exceptions.h>
+
+namespace authlib {
+
+/**
+ * The expected failures, one per exception the throwing API raises for
+ * them. Anything else (DatabaseError, HashQueueFull, bad_alloc) is still
+ * thrown by the try* variants too.
+ */
+enum class ErrorCode : uint8_t {
+    None,
+    ValidationError,    // malformed email, password policy
+    InvalidCredentials, // wrong password, deactivated account
+    InvalidToken,       // bad signature, expired, wrong type or tenant, revoked
+    UserNotFound,
+    UserAlreadyExists
+};
+
+struct AuthError {
+    ErrorCode code;
+    std::string message;
+
+    /**
+     * Throw the exception the throwing API uses for this error
+     */
+    [[noreturn]] void raise() const {
+        switch (code) {
+            case ErrorCode::ValidationError:
+                throw ValidationError(message);
+            case ErrorCode::InvalidCredentials:
+                throw InvalidCredentials(message);
+            case ErrorCode::InvalidToken:
+                throw InvalidToken(message);
+            case ErrorCode::UserNotFound:
+                throw UserNotFound(message);
+            case ErrorCode::UserAlreadyExists:
+                throw UserAlreadyExists(message);
+            default:
+                throw AuthException(message);
+        }
+    }
+};
+
+/**
+ * A value or an AuthError, like C++23's std::expected:
+ *
+ *   Result<AuthResponse> result = auth.tryLogin(input);
+ *   if (!result) {
+ *       log(result.error().message);
+ *   }
+ */
+template <typename T>
+class Result {
+public:
+    Result(T value) : state(std::in_place_index<0>, std::move(value)) {}
+    Result(AuthError error) : state(std::in_place_index<1>, std::move(error)) {}
+
+    bool ok() const noexcept {
+        return state.index() == 0;
+    }
+    explicit operator bool() const noexcept {
+        return ok();
+    }
+
+    /**
+     * Throws std::bad_variant_access unless ok()
+     */
+    T& value() & {
+        return std::get<0>(state);
+    }
+    const T& value() const& {
+        return std::get<0>(state);
+    }
+
+    /**
+     * Throws std::bad_variant_access if ok()
+     */
+    const AuthError& error() const {
+        return std::get<1>(state);
+    }
+
+    ErrorCode code() const noexcept {
+        return ok() ? ErrorCode::None : std::get_if<1>(&state)->code;
+    }
+
+    /**
+     * The value, or the error thrown as its exception
+     */
+    T valueOrThrow() && {
+        if (!ok()) {
+            error().raise();
+        }
+        return std::move(std::get<0>(state));
+    }
+
+private:
+    std::variant<T, AuthError> state;
+};
+
+template <>
+class Result<void> {
+public:
+    Result() = default;
+    Result(AuthError error) : failure(std::move(error)) {}
+
+    bool ok() const noexcept {
+        return !failure;
+    }
+    explicit operator bool() const noexcept {
+        return ok();
+    }
+
+    /**
+     * Throws std::bad_optional_access if ok()
+     */
+    const AuthError& error() const {
+        return failure.value();
+    }
+
+    ErrorCode code() const noexcept {
+        return failure ? failure->code : ErrorCode::None;
+    }
+
+    void valueOrThrow() const {
+        if (failure) {
+            failure->raise();
+        }
+    }
+
+private:
+    std::optional<AuthError> failure;
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_RESULT_H
@@ -0,0 +1,50 @@
+/**
+ * Cryptographically secure random bytes for salts, token ids and secrets
+ */
+
+#ifndef AUTHLIB_SECURE_RANDOM_H
+#define AUTHLIB_SECURE_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace authlib {
+
+class SecureRandom {
+public:
+    /**
+     * Fill `out` with `length` random bytes. Small requests are served from
+     * a per-thread buffer refilled in large chunks from the OS (getrandom on
+     * Linux, OpenSSL RAND_bytes elsewhere), so the common case takes no
+     * lock and makes no syscall. Buffers are discarded in a forked child.
+     */
+    static void fill(unsigned char* out, size_t length);
+
+    /**
+     * `length` random bytes as a binary string
+     */
+    static std::string bytes(size_t length);
+
+    /**
+     * URL-safe base64 (no padding) of `length` random bytes, for opaque
+     * refresh tokens, API keys and JWT ids
+     */
+    static std::string token(size_t length = 32);
+
+    /**
+     * Lowercase hex of `length` random bytes
+     */
+    static std::string hex(size_t length);
+
+    static uint64_t nextU64();
+
+    /**
+     * Wipe and drop the calling thread's buffer
+     */
+    static void releaseThreadBuffer();
+};
+
+} // namespace authlib
+
+#endif // AUTHLIB_SECURE_RANDOM_H
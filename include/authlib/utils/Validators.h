@@ -12,12 +12,44 @@ namespace authlib {
 
 class EmailValidator {
 public:
+    /**
+     * Throws ValidationError unless `email` is a well-formed address of at
+     * most 254 characters
+     */
     static void validate(const std::string& email);
+
+    /**
+     * Non-throwing check; never allocates
+     */
+    static bool isValid(const std::string& email) noexcept;
+
+    /**
+     * The message validate() would throw, or nullptr when `email` passes
+     */
+    static const char* problem(const std::string& email) noexcept;
 };
 
+class BreachedPasswordIndex;
+class PasswordPolicy;
+
 class PasswordValidator {
 public:
+    /**
+     * The rules validate() checks
+     */
+    static const PasswordPolicy& defaultPolicy();
+
+    /**
+     * Check against the default PasswordPolicy (8-128 characters, upper,
+     * lower, digit and special)
+     */
     static void validate(const std::string& password);
+
+    /**
+     * Also reject passwords found in a breached-password corpus (skipped
+     * when `breached` is null)
+     */
+    static void validate(const std::string& password, const BreachedPasswordIndex* breached);
 };
 
 } // namespace authlib
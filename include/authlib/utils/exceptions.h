@@ -51,6 +51,24 @@ public:
         : AuthException(message) {}
 };
 
+class HashQueueFull : public AuthException {
+public:
+    explicit HashQueueFull(const std::string& message = "Password hashing queue is full")
+        : AuthException(message) {}
+};
+
+class ConfigError : public AuthException {
+public:
+    explicit ConfigError(const std::string& message = "Invalid configuration")
+        : AuthException(message) {}
+};
+
+class TenantNotFound : public AuthException {
+public:
+    explicit TenantNotFound(const std::string& message = "Tenant not found")
+        : AuthException(message) {}
+};
+
 } // namespace authlib
 
 #endif // AUTHLIB_EXCEPTIONS_H
@@ -1,24 +1,274 @@
 #include <authlib/config/Config.h>
+#include <authlib/utils/exceptions.h>
 #include <cstdlib>
+#include <fstream>
 #include <stdexcept>
+#include <vector>
+
+// Every setting is one row in settings(): name, member, default and the
+// range or choices it must fall in. Loading is a single pass over that
+// table, taking each value from the environment, else the config file,
+// else the default, and rejecting anything out of range with the setting
+// name and where the bad value came from. toJson() walks the same table,
+// so a new setting only has to be added here.
 
 namespace authlib {
 
-Config::Config() {
-    JWT_SECRET_KEY = getEnv("JWT_SECRET_KEY", "change-me-in-production");
-    JWT_ALGORITHM = getEnv("JWT_ALGORITHM", "HS256");
-    JWT_ACCESS_TOKEN_EXPIRY_MINUTES = std::stoul(getEnv("JWT_ACCESS_TOKEN_EXPIRY_MINUTES", "15"));
-    JWT_REFRESH_TOKEN_EXPIRY_DAYS = std::stoul(getEnv("JWT_REFRESH_TOKEN_EXPIRY_DAYS", "7"));
+namespace {
+
+enum class SettingType {
+    Text,
+    Number,
+    Flag
+};
+
+struct Setting {
+    const char* name;
+    SettingType type;
+    std::string Config::* text;
+    uint32_t Config::* number;
+    bool Config::* flag;
+    const char* defaultValue;
+    uint32_t min;
+    uint32_t max;
+    std::vector<std::string> choices; // empty = any text
+    bool secret;
+};
+
+Setting text(
+    const char* name,
+    std::string Config::* member,
+    const char* defaultValue,
+    std::vector<std::string> choices = {},
+    bool secret = false
+) {
+    return {name, SettingType::Text, member, nullptr, nullptr, defaultValue, 0, 0, std::move(choices), secret};
+}
+
+Setting secretText(const char* name, std::string Config::* member, const char* defaultValue) {
+    return text(name, member, defaultValue, {}, true);
+}
+
+Setting number(const char* name, uint32_t Config::* member, const char* defaultValue, uint32_t min, uint32_t max) {
+    return {name, SettingType::Number, nullptr, member, nullptr, defaultValue, min, max, {}, false};
+}
+
+Setting flag(const char* name, bool Config::* member, const char* defaultValue) {
+    return {name, SettingType::Flag, nullptr, nullptr, member, defaultValue, 0, 0, {}, false};
+}
+
+const std::vector<Setting>& settings() {
+    static const std::vector<Setting> table = {
+        secretText("JWT_SECRET_KEY", &Config::JWT_SECRET_KEY, "change-me-in-production"),
+        text("JWT_ALGORITHM", &Config::JWT_ALGORITHM, "HS256", {"HS256"}),
+        number("JWT_ACCESS_TOKEN_EXPIRY_MINUTES", &Config::JWT_ACCESS_TOKEN_EXPIRY_MINUTES, "15", 1, 1440),
+        number("JWT_REFRESH_TOKEN_EXPIRY_DAYS", &Config::JWT_REFRESH_TOKEN_EXPIRY_DAYS, "7", 1, 365),
+        secretText("JWT_PREVIOUS_SECRET_KEY", &Config::JWT_PREVIOUS_SECRET_KEY, ""),
+        number("JWT_KEY_ROTATION_GRACE_SECONDS", &Config::JWT_KEY_ROTATION_GRACE_SECONDS, "3600", 0, 2592000),
+
+        text("PASSWORD_HASH_ALGORITHM", &Config::PASSWORD_HASH_ALGORITHM, "pbkdf2-sha256", {"pbkdf2-sha256", "argon2id"}),
+        number("PASSWORD_HASH_ITERATIONS", &Config::PASSWORD_HASH_ITERATIONS, "10000", 1000, 10000000),
+        number("PASSWORD_HASH_TARGET_MS", &Config::PASSWORD_HASH_TARGET_MS, "0", 0, 10000),
+        number("PASSWORD_ARGON2_MEMORY_KIB", &Config::PASSWORD_ARGON2_MEMORY_KIB, "65536", 8, 4194304),
+        number("PASSWORD_ARGON2_TIME_COST", &Config::PASSWORD_ARGON2_TIME_COST, "3", 1, 100),
+        number("PASSWORD_ARGON2_PARALLELISM", &Config::PASSWORD_ARGON2_PARALLELISM, "1", 1, 64),
+        number("PASSWORD_HASH_POOL_WORKERS", &Config::PASSWORD_HASH_POOL_WORKERS, "0", 0, 1024),
+        number("PASSWORD_HASH_POOL_QUEUE_CAPACITY", &Config::PASSWORD_HASH_POOL_QUEUE_CAPACITY, "1024", 1, 1048576),
+        text("PASSWORD_BREACHED_INDEX_PATH", &Config::PASSWORD_BREACHED_INDEX_PATH, ""),
+
+        number("PASSWORD_MIN_LENGTH", &Config::PASSWORD_MIN_LENGTH, "8", 1, 1024),
+        number("PASSWORD_MAX_LENGTH", &Config::PASSWORD_MAX_LENGTH, "128", 1, 4096),
+        flag("PASSWORD_REQUIRE_UPPERCASE", &Config::PASSWORD_REQUIRE_UPPERCASE, "true"),
+        flag("PASSWORD_REQUIRE_LOWERCASE", &Config::PASSWORD_REQUIRE_LOWERCASE, "true"),
+        flag("PASSWORD_REQUIRE_DIGIT", &Config::PASSWORD_REQUIRE_DIGIT, "true"),
+        flag("PASSWORD_REQUIRE_SPECIAL", &Config::PASSWORD_REQUIRE_SPECIAL, "true"),
+        flag("PASSWORD_FORBID_EMAIL", &Config::PASSWORD_FORBID_EMAIL, "true"),
+        text("PASSWORD_FORBIDDEN_SUBSTRINGS", &Config::PASSWORD_FORBIDDEN_SUBSTRINGS, ""),
+        text("PASSWORD_DICTIONARY_PATH", &Config::PASSWORD_DICTIONARY_PATH, ""),
+
+        flag("EMAIL_FOLD_LOCAL_PART", &Config::EMAIL_FOLD_LOCAL_PART, "true"),
+        flag("EMAIL_PROVIDER_RULES", &Config::EMAIL_PROVIDER_RULES, "false"),
+
+        number("ASYNC_COMPUTE_THREADS", &Config::ASYNC_COMPUTE_THREADS, "0", 0, 1024),
+        number("ASYNC_IO_THREADS", &Config::ASYNC_IO_THREADS, "4", 1, 1024),
+
+        text("HTTP_BIND_ADDRESS", &Config::HTTP_BIND_ADDRESS, "0.0.0.0"),
+        number("HTTP_PORT", &Config::HTTP_PORT, "8080", 0, 65535),
+        number("HTTP_THREADS", &Config::HTTP_THREADS, "0", 0, 1024),
+        flag("HTTP_REUSE_PORT", &Config::HTTP_REUSE_PORT, "true"),
+        number("HTTP_IDLE_TIMEOUT_SECONDS", &Config::HTTP_IDLE_TIMEOUT_SECONDS, "30", 1, 3600),
+        number("HTTP_MAX_BODY_BYTES", &Config::HTTP_MAX_BODY_BYTES, "16384", 256, 1048576),
+        flag("HTTP_METRICS", &Config::HTTP_METRICS, "false"),
+        text("HTTP_TRACE_FILE", &Config::HTTP_TRACE_FILE, ""),
+
+        text("VERIFY_SOCKET_PATH", &Config::VERIFY_SOCKET_PATH, "/tmp/authlib-verify.sock"),
+        number("VERIFY_THREADS", &Config::VERIFY_THREADS, "1", 1, 256),
+
+        number("SESSION_SHARDS", &Config::SESSION_SHARDS, "64", 1, 4096),
+        number("SESSION_TTL_SECONDS", &Config::SESSION_TTL_SECONDS, "86400", 1, 31536000),
+        number("SESSION_SWEEP_INTERVAL_MS", &Config::SESSION_SWEEP_INTERVAL_MS, "1000", 0, 60000),
+        flag("SESSION_PERSIST", &Config::SESSION_PERSIST, "false"),
+
+        number("TENANT_MAX_OPEN", &Config::TENANT_MAX_OPEN, "256", 1, 1000000),
+        number("TENANT_IDLE_SECONDS", &Config::TENANT_IDLE_SECONDS, "600", 0, 86400),
+
+        text("DATABASE_URL", &Config::DATABASE_URL, "sqlite:///./authlib.db"),
+        text("DATABASE_TYPE", &Config::DATABASE_TYPE, "sqlite", {"sqlite"}),
+        number("DATABASE_SHARDS", &Config::DATABASE_SHARDS, "1", 1, 256),
+        flag("DATABASE_PROFILE", &Config::DATABASE_PROFILE, "false"),
+        number("DATABASE_SLOW_QUERY_MS", &Config::DATABASE_SLOW_QUERY_MS, "0", 0, 3600000),
+        flag("DATABASE_EXPLAIN_CHECK", &Config::DATABASE_EXPLAIN_CHECK, "true"),
+
+        text("SMTP_SERVER", &Config::SMTP_SERVER, "smtp.gmail.com"),
+        text("SMTP_USERNAME", &Config::SMTP_USERNAME, ""),
+        secretText("SMTP_PASSWORD", &Config::SMTP_PASSWORD, ""),
+        text("SMTP_FROM", &Config::SMTP_FROM, "noreply@authlib.dev"),
+
+        flag("DEBUG", &Config::DEBUG, "false")
+    };
+    return table;
+}
+
+const Setting* findSetting(const std::string& name) {
+    for (const auto& setting : settings()) {
+        if (name == setting.name) {
+            return &setting;
+        }
+    }
+    return nullptr;
+}
+
+std::string describeRange(const Setting& setting) {
+    return "[" + std::to_string(setting.min) + ", " + std::to_string(setting.max) + "]";
+}
+
+void assignNumber(Config& config, const Setting& setting, uint64_t value, const std::string& raw, const std::string& source) {
+    if (value < setting.min || value > setting.max) {
+        throw ConfigError(source + ": " + setting.name + "=" + raw + " is out of range " + describeRange(setting));
+    }
+    config.*setting.number = static_cast<uint32_t>(value);
+}
+
+void assignText(Config& config, const Setting& setting, const std::string& value, const std::string& source) {
+    if (!setting.choices.empty()) {
+        bool allowed = false;
+        std::string expected;
+        for (const auto& choice : setting.choices) {
+            allowed = allowed || value == choice;
+            expected += (expected.empty() ? "" : ", ") + choice;
+        }
+        if (!allowed) {
+            throw ConfigError(source + ": " + setting.name + "=\"" + value + "\" must be one of: " + expected);
+        }
+    }
+    config.*setting.text = value;
+}
+
+// Environment variables and defaults are always strings
+void assignString(Config& config, const Setting& setting, const std::string& value, const std::string& source) {
+    switch (setting.type) {
+        case SettingType::Text:
+            assignText(config, setting, value, source);
+            return;
+        case SettingType::Flag:
+            if (value == "true" || value == "1") {
+                config.*setting.flag = true;
+            } else if (value == "false" || value == "0") {
+                config.*setting.flag = false;
+            } else {
+                throw ConfigError(source + ": " + setting.name + "=\"" + value + "\" must be true or false");
+            }
+            return;
+        case SettingType::Number: {
+            uint64_t parsed = 0;
+            bool valid = !value.empty() && value.size() <= 10;
+            for (char c : value) {
+                valid = valid && c >= '0' && c <= '9';
+                parsed = parsed * 10 + static_cast<uint64_t>(c - '0');
+            }
+            if (!valid) {
+                throw ConfigError(source + ": " + setting.name + "=\"" + value
+                    + "\" is not an unsigned integer in " + describeRange(setting));
+            }
+            assignNumber(config, setting, parsed, value, source);
+            return;
+        }
+    }
+}
+
+void assignJson(Config& config, const Setting& setting, const json& value, const std::string& source) {
+    switch (setting.type) {
+        case SettingType::Text:
+            if (!value.is_string()) {
+                throw ConfigError(source + ": " + setting.name + " must be a string");
+            }
+            assignText(config, setting, value.get<std::string>(), source);
+            return;
+        case SettingType::Flag:
+            if (!value.is_boolean()) {
+                throw ConfigError(source + ": " + setting.name + " must be true or false");
+            }
+            config.*setting.flag = value.get<bool>();
+            return;
+        case SettingType::Number:
+            if (!value.is_number_unsigned()) {
+                throw ConfigError(source + ": " + setting.name + "=" + value.dump()
+                    + " is not an unsigned integer in " + describeRange(setting));
+            }
+            assignNumber(config, setting, value.get<uint64_t>(), value.dump(), source);
+            return;
+    }
+}
+
+json readConfigFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw ConfigError("Cannot open config file: " + path);
+    }
+
+    json document;
+    try {
+        document = json::parse(file);
+    } catch (const json::parse_error& e) {
+        throw ConfigError(path + ": " + e.what());
+    }
+    if (!document.is_object()) {
+        throw ConfigError(path + ": top level must be an object of SETTING: value pairs");
+    }
+    for (const auto& item : document.items()) {
+        if (!findSetting(item.key())) {
+            throw ConfigError(path + ": unknown setting \"" + item.key() + "\"");
+        }
+    }
+    return document;
+}
+
+} // namespace
 
-    DATABASE_URL = getEnv("DATABASE_URL", "sqlite:///./authlib.db");
-    DATABASE_TYPE = getEnv("DATABASE_TYPE", "sqlite");
+Config::Config() : Config(getEnv("AUTHLIB_CONFIG_FILE", "")) {}
 
-    SMTP_SERVER = getEnv("SMTP_SERVER", "smtp.gmail.com");
-    SMTP_USERNAME = getEnv("SMTP_USERNAME", "");
-    SMTP_PASSWORD = getEnv("SMTP_PASSWORD", "");
-    SMTP_FROM = getEnv("SMTP_FROM", "noreply@authlib.dev");
+Config::Config(const std::string& configFile) {
+    json file = configFile.empty() ? json::object() : readConfigFile(configFile);
 
-    DEBUG = getEnv("DEBUG", "false") == "true";
+    for (const auto& setting : settings()) {
+        const char* env = std::getenv(setting.name);
+        if (env) {
+            assignString(*this, setting, env, "environment");
+        } else if (file.contains(setting.name)) {
+            assignJson(*this, setting, file[setting.name], configFile);
+        } else {
+            assignString(*this, setting, setting.defaultValue, "default");
+        }
+    }
+
+    if (PASSWORD_MIN_LENGTH > PASSWORD_MAX_LENGTH) {
+        throw ConfigError("PASSWORD_MIN_LENGTH=" + std::to_string(PASSWORD_MIN_LENGTH)
+            + " exceeds PASSWORD_MAX_LENGTH=" + std::to_string(PASSWORD_MAX_LENGTH));
+    }
+
+    JWT_PREVIOUS_SECRET_EXPIRES_AT = JWT_PREVIOUS_SECRET_KEY.empty()
+        ? 0
+        : std::time(nullptr) + JWT_KEY_ROTATION_GRACE_SECONDS;
 }
 
 void Config::validate() const {
@@ -35,6 +285,26 @@ bool Config::isProductionMode() const {
     return env && std::string(env) == "production";
 }
 
+json Config::toJson(bool includeSecrets) const {
+    json result = json::object();
+    for (const auto& setting : settings()) {
+        switch (setting.type) {
+            case SettingType::Text: {
+                const std::string& value = this->*setting.text;
+                result[setting.name] = setting.secret && !includeSecrets && !value.empty() ? "<redacted>" : value;
+                break;
+            }
+            case SettingType::Number:
+                result[setting.name] = this->*setting.number;
+                break;
+            case SettingType::Flag:
+                result[setting.name] = this->*setting.flag;
+                break;
+        }
+    }
+    return result;
+}
+
 std::string Config::getEnv(const std::string& key, const std::string& defaultValue) {
     const char* value = std::getenv(key.c_str());
     return value ? std::string(value) : defaultValue;
@@ -0,0 +1,110 @@
+#include <authlib/config/ConfigStore.h>
+#include <ctime>
+
+// Each thread keeps its own reference to the snapshot it last saw of up
+// to CACHED_STORES stores, so a read is one atomic load of the version and
+// a short scan. Only a thread that observes a new version, or
+// a store that fell out of its cache, goes through std::atomic_load, which
+// may lock briefly. view() hands out that cached reference and writes
+// nothing shared; snapshot() copies it, which is an atomic increment and
+// decrement on the control block every thread shares, so hot paths use
+// view(). Versions come from one process-wide counter, so a store that
+// reuses a destroyed store's address can't match a stale cache entry.
+
+namespace authlib {
+
+namespace {
+
+std::atomic<uint64_t> nextVersion{1};
+
+// Stores cached per thread. A TenantRegistry gives every tenant its own
+// store, so a worker serving several tenants needs more than one.
+constexpr size_t CACHED_STORES = 16;
+
+struct CachedSnapshot {
+    const ConfigStore* store = nullptr;
+    uint64_t version = 0;
+    std::shared_ptr<const Config> config;
+};
+
+struct SnapshotCache {
+    CachedSnapshot entries[CACHED_STORES];
+    size_t nextVictim = 0; // round robin once every entry is taken
+};
+
+thread_local SnapshotCache cache;
+
+} // namespace
+
+ConfigStore::ConfigStore(std::shared_ptr<const Config> initial)
+    : current(std::move(initial)), currentVersion(nextVersion.fetch_add(1)) {}
+
+std::shared_ptr<const Config> ConfigStore::snapshot() const {
+    return cachedSnapshot();
+}
+
+const Config& ConfigStore::view() const {
+    return *cachedSnapshot();
+}
+
+const std::shared_ptr<const Config>& ConfigStore::cachedSnapshot() const {
+    uint64_t version = currentVersion.load(std::memory_order_acquire);
+    CachedSnapshot* cached = nullptr;
+    for (CachedSnapshot& entry : cache.entries) {
+        if (entry.store == this) {
+            cached = &entry;
+            break;
+        }
+    }
+    if (!cached) {
+        cached = &cache.entries[cache.nextVictim];
+        cache.nextVictim = (cache.nextVictim + 1) % CACHED_STORES;
+    }
+    if (cached->store != this || cached->version != version) {
+        // publish() stores the pointer before the version, so this load
+        // sees a snapshot at least as new as `version`
+        cached->config = std::atomic_load_explicit(&current, std::memory_order_acquire);
+        cached->store = this;
+        cached->version = version;
+    }
+    return cached->config;
+}
+
+void ConfigStore::publish(std::shared_ptr<const Config> next) {
+    std::lock_guard<std::mutex> lock(publishMutex);
+
+    std::shared_ptr<const Config> previous = std::atomic_load_explicit(&current, std::memory_order_acquire);
+    if (previous
+        && previous->JWT_SECRET_KEY != next->JWT_SECRET_KEY
+        && next->JWT_KEY_ROTATION_GRACE_SECONDS > 0) {
+        auto rotated = std::make_shared<Config>(*next);
+        rotated->JWT_PREVIOUS_SECRET_KEY = previous->JWT_SECRET_KEY;
+        rotated->JWT_PREVIOUS_SECRET_EXPIRES_AT = std::time(nullptr) + next->JWT_KEY_ROTATION_GRACE_SECONDS;
+        next = std::move(rotated);
+    } else if (previous
+        && previous->JWT_SECRET_KEY == next->JWT_SECRET_KEY
+        && !previous->JWT_PREVIOUS_SECRET_KEY.empty()
+        && (next->JWT_PREVIOUS_SECRET_KEY.empty()
+            || next->JWT_PREVIOUS_SECRET_KEY == previous->JWT_PREVIOUS_SECRET_KEY)) {
+        // An unrelated reload must neither cut a rotation's grace window
+        // short nor restart it
+        auto carried = std::make_shared<Config>(*next);
+        carried->JWT_PREVIOUS_SECRET_KEY = previous->JWT_PREVIOUS_SECRET_KEY;
+        carried->JWT_PREVIOUS_SECRET_EXPIRES_AT = previous->JWT_PREVIOUS_SECRET_EXPIRES_AT;
+        next = std::move(carried);
+    }
+
+    std::atomic_store_explicit(&current, std::move(next), std::memory_order_release);
+    currentVersion.store(nextVersion.fetch_add(1), std::memory_order_release);
+}
+
+std::shared_ptr<const Config> ConfigStore::reload() {
+    publish(std::make_shared<const Config>());
+    return snapshot();
+}
+
+uint64_t ConfigStore::version() const {
+    return currentVersion.load(std::memory_order_acquire);
+}
+
+} // namespace authlib
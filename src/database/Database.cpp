@@ -1,49 +1,597 @@
 #include <authlib/database/Database.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/utils/EmailCanonicalizer.h>
 #include <authlib/utils/exceptions.h>
+#include <openssl/sha.h>
 #include <sqlite3.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <ostream>
 #include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Users are keyed by email_canonical (UNIQUE) rather than the address as
+// typed, so case-insensitive lookups never need LOWER() and stay on the
+// index. email_hash carries EmailCanonicalizer::hash for cache and shard
+// routing.
+//
+// Each thread that touches a Database gets its own SQLite connection
+// (opened NOMUTEX, with its own prepared-statement cache), so concurrent
+// callers never serialize on one handle and errmsg/last_insert_rowid always
+// belong to the caller's statement. WAL lets readers run alongside the one
+// writer; writers queue on busy_timeout. A thread's connection goes back to
+// the pool when the thread exits.
+//
+// Sharding gives every shard file its own pool, so the per-thread
+// connections above become one per thread per shard. Sharded user ids are
+// allocated as ((MAX(id) >> 8) + 1) << 8 | slot inside the INSERT itself:
+// the sequence part only grows within a file, and a slot only ever lives in
+// one file, so ids stay unique across shards and across reshards.
+//
+// Lookups time only the statement step, so a miss is a normal lookup
+// rather than an error in the metrics.
+//
+// Statement profiling times sqlite3_step in the Statement wrapper rather
+// than through sqlite3_trace_v2: SQLITE_TRACE_PROFILE durations come from
+// the VFS clock, which on unix ticks in milliseconds, and nearly every
+// statement here finishes well inside one. The trace hook still drives
+// the slow query log, whose threshold is in milliseconds anyway. Stats
+// are shared by SQL text across connections and updated with relaxed
+// atomics; each connection caches its own pointers to them, so only the
+// first execution of a statement on a connection takes the lock.
 
 namespace authlib {
 
-Database::Database(const std::string& connectionUrl)
-    : connectionUrl(connectionUrl), dbHandle(nullptr) {}
+namespace detail {
+
+struct StatementStats {
+    std::string sql;
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> sumNanos{0};
+    std::atomic<uint64_t> rowsReturned{0};
+    std::atomic<uint64_t> fullScanSteps{0};
+    std::atomic<uint64_t> vmSteps{0};
+    std::array<std::atomic<uint64_t>, Metrics::BUCKETS> buckets{};
+};
+
+class StatementProfiler {
+public:
+    explicit StatementProfiler(const DatabaseProfileOptions& options) : options(options) {}
+
+    StatementStats& statsFor(const char* sql) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::unique_ptr<StatementStats>& entry = stats[sql];
+        if (!entry) {
+            entry = std::make_unique<StatementStats>();
+            entry->sql = sql;
+        }
+        return *entry;
+    }
+
+    void record(StatementStats& entry, uint64_t nanos, uint64_t rows, uint64_t fullScanSteps, uint64_t vmSteps) {
+        nanos = std::min(nanos, Metrics::MAX_NANOS);
+        entry.count.fetch_add(1, std::memory_order_relaxed);
+        entry.sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+        entry.rowsReturned.fetch_add(rows, std::memory_order_relaxed);
+        entry.fullScanSteps.fetch_add(fullScanSteps, std::memory_order_relaxed);
+        entry.vmSteps.fetch_add(vmSteps, std::memory_order_relaxed);
+        entry.buckets[Metrics::bucketFor(nanos)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::vector<StatementProfile> profiles() const {
+        std::vector<StatementProfile> result;
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& entry : stats) {
+            const StatementStats& source = *entry.second;
+            StatementProfile profile;
+            profile.sql = source.sql;
+            profile.latency.count = source.count.load(std::memory_order_relaxed);
+            profile.latency.sumNanos = source.sumNanos.load(std::memory_order_relaxed);
+            profile.latency.buckets.reserve(Metrics::BUCKETS);
+            for (const auto& bucket : source.buckets) {
+                profile.latency.buckets.push_back(bucket.load(std::memory_order_relaxed));
+            }
+            profile.rowsReturned = source.rowsReturned.load(std::memory_order_relaxed);
+            profile.fullScanSteps = source.fullScanSteps.load(std::memory_order_relaxed);
+            profile.vmSteps = source.vmSteps.load(std::memory_order_relaxed);
+            result.push_back(std::move(profile));
+        }
+        return result;
+    }
+
+    // sqlite3_trace_v2 callback: `p` is the statement, `x` its duration
+    static int onProfile(unsigned type, void* context, void* p, void* x) {
+        if (type != SQLITE_TRACE_PROFILE) {
+            return 0;
+        }
+        auto* profiler = static_cast<StatementProfiler*>(context);
+        const auto nanos = *static_cast<const sqlite3_int64*>(x);
+        if (nanos < static_cast<sqlite3_int64>(profiler->options.slowQueryMs) * 1000000) {
+            return 0;
+        }
+        auto* stmt = static_cast<sqlite3_stmt*>(p);
+        char* expanded = sqlite3_expanded_sql(stmt);
+        profiler->options.log("authlib: slow query (" + std::to_string(nanos / 1000000) + " ms): "
+            + (expanded ? expanded : sqlite3_sql(stmt)));
+        sqlite3_free(expanded);
+        return 0;
+    }
+
+    DatabaseProfileOptions options;
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::unique_ptr<StatementStats>> stats;
+};
+
+struct SqliteConnection {
+    sqlite3* db = nullptr;
+    std::unordered_map<const char*, sqlite3_stmt*> statements; // keyed by SQL text address
+    StatementProfiler* profiler = nullptr; // set when per-statement profiling is on
+    std::unordered_map<const char*, StatementStats*> profiled; // same keys as `statements`
+
+    ~SqliteConnection() {
+        for (auto& entry : statements) {
+            sqlite3_finalize(entry.second);
+        }
+        sqlite3_close(db);
+    }
+};
+
+class SqliteConnectionPool {
+public:
+    SqliteConnectionPool(std::string path, bool uri, uint32_t busyTimeoutMs,
+                         std::shared_ptr<StatementProfiler> profiler)
+        : path(std::move(path)), uri(uri), busyTimeoutMs(busyTimeoutMs), profiler(std::move(profiler)) {}
+
+    SqliteConnection* acquire() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!idle.empty()) {
+                SqliteConnection* connection = idle.back();
+                idle.pop_back();
+                return connection;
+            }
+        }
+
+        auto connection = std::make_unique<SqliteConnection>();
+        int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX | (uri ? SQLITE_OPEN_URI : 0);
+        if (sqlite3_open_v2(path.c_str(), &connection->db, flags, nullptr) != SQLITE_OK) {
+            throw DatabaseError("Failed to open database: " + std::string(sqlite3_errmsg(connection->db)));
+        }
+        sqlite3_busy_timeout(connection->db, static_cast<int>(busyTimeoutMs));
+        sqlite3_exec(connection->db, "PRAGMA synchronous=NORMAL", nullptr, nullptr, nullptr);
+        if (profiler) {
+            if (profiler->options.enabled) {
+                connection->profiler = profiler.get();
+            }
+            if (profiler->options.slowQueryMs > 0) {
+                sqlite3_trace_v2(connection->db, SQLITE_TRACE_PROFILE, &StatementProfiler::onProfile, profiler.get());
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        connections.push_back(std::move(connection));
+        return connections.back().get();
+    }
 
-Database::~Database() {
-    if (dbHandle) {
-        sqlite3_close(static_cast<sqlite3*>(dbHandle));
+    void release(SqliteConnection* connection) {
+        std::lock_guard<std::mutex> lock(mutex);
+        idle.push_back(connection);
     }
+
+private:
+    std::string path;
+    bool uri;
+    uint32_t busyTimeoutMs;
+    std::shared_ptr<StatementProfiler> profiler;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<SqliteConnection>> connections;
+    std::vector<SqliteConnection*> idle;
+};
+
+} // namespace detail
+
+namespace {
+
+constexpr uint32_t SLOT_MASK = Database::MAX_SHARDS - 1;
+
+const std::string INSERT_COLUMNS =
+    "email, email_canonical, email_hash, password_hash, first_name, last_name,"
+    " is_active, is_verified, created_at, updated_at, last_login";
+const std::string USER_COLUMNS = "id, " + INSERT_COLUMNS;
+const std::string SELECT_USER_BY_ID = "SELECT " + USER_COLUMNS + " FROM users WHERE id = ?";
+const std::string SELECT_USER_BY_EMAIL = "SELECT " + USER_COLUMNS + " FROM users WHERE email_canonical = ?";
+const std::string SELECT_ALL_USERS = "SELECT " + USER_COLUMNS + " FROM users ORDER BY id";
+const std::string INSERT_USER =
+    "INSERT INTO users (" + INSERT_COLUMNS + ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+const std::string INSERT_USER_IN_SLOT =
+    "INSERT INTO users (id, " + INSERT_COLUMNS + ")"
+    " VALUES (((((SELECT IFNULL(MAX(id), 0) FROM users) >> 8) + 1) << 8) | ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+const char* const CREATE_TOKEN_BLACKLIST =
+    "CREATE TABLE IF NOT EXISTS token_blacklist ("
+    "token_digest BLOB PRIMARY KEY," // SHA-256 of the token
+    "user_id INTEGER NOT NULL,"
+    "expires_at INTEGER NOT NULL,"
+    "blacklisted_at INTEGER NOT NULL"
+    ") WITHOUT ROWID";
+
+const std::string INSERT_USER_WITH_ID =
+    "INSERT INTO users (" + USER_COLUMNS + ") VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
+const char* const UPDATE_USER =
+    "UPDATE users SET password_hash = ?, first_name = ?, last_name = ?, is_active = ?,"
+    " is_verified = ?, updated_at = ?, last_login = ? WHERE id = ?";
+const char* const UPDATE_LAST_LOGIN = "UPDATE users SET last_login = ? WHERE id = ?";
+const char* const UPDATE_PASSWORD_HASH = "UPDATE users SET password_hash = ?, updated_at = ? WHERE id = ?";
+const char* const INSERT_TOKEN_DIGEST =
+    "INSERT OR IGNORE INTO token_blacklist (token_digest, user_id, expires_at, blacklisted_at)"
+    " VALUES (?, ?, ?, ?)";
+const char* const SELECT_TOKEN_DIGEST = "SELECT 1 FROM token_blacklist WHERE token_digest = ?";
+const char* const DELETE_EXPIRED_TOKENS = "DELETE FROM token_blacklist WHERE expires_at <= ?";
+const char* const UPSERT_SESSION =
+    "INSERT OR REPLACE INTO sessions (id, user_id, created_at, expires_at, metadata)"
+    " VALUES (?, ?, ?, ?, ?)";
+const char* const DELETE_SESSION = "DELETE FROM sessions WHERE id = ?";
+const char* const DELETE_EXPIRED_SESSIONS = "DELETE FROM sessions WHERE expires_at <= ?";
+const char* const SELECT_LIVE_SESSIONS =
+    "SELECT id, user_id, created_at, expires_at, metadata FROM sessions WHERE expires_at > ?";
+
+// What checkQueryPlans looks at by default: everything a request or the
+// session store runs, but not migrations or resharding
+std::vector<std::string> hotStatements() {
+    return {
+        SELECT_USER_BY_ID, SELECT_USER_BY_EMAIL, INSERT_USER, INSERT_USER_IN_SLOT, UPDATE_USER,
+        UPDATE_LAST_LOGIN, UPDATE_PASSWORD_HASH, INSERT_TOKEN_DIGEST, SELECT_TOKEN_DIGEST,
+        DELETE_EXPIRED_TOKENS, UPSERT_SESSION, DELETE_SESSION, DELETE_EXPIRED_SESSIONS, SELECT_LIVE_SESSIONS,
+    };
 }
 
-void Database::initialize() {
-    try {
-        sqlite3* db;
-        int result = sqlite3_open(connectionUrl.c_str(), &db);
+struct ThreadConnection {
+    std::weak_ptr<detail::SqliteConnectionPool> pool;
+    const detail::SqliteConnectionPool* key;
+    detail::SqliteConnection* connection;
+};
 
-        if (result != SQLITE_OK) {
-            throw DatabaseError("Failed to open database: " + std::string(sqlite3_errmsg(db)));
+struct ThreadConnections {
+    std::vector<ThreadConnection> entries;
+
+    ~ThreadConnections() {
+        for (auto& entry : entries) {
+            if (auto pool = entry.pool.lock()) {
+                pool->release(entry.connection);
+            }
+        }
+    }
+};
+
+thread_local ThreadConnections threadConnections;
+
+std::atomic<uint64_t> memoryDatabaseCount{0};
+
+// Statements are prepared once per connection and reset when the wrapper
+// goes out of scope. `sql` must outlive the connection (a literal or one of
+// the constants above) because its address is the cache key.
+class Statement {
+public:
+    Statement(detail::SqliteConnection& connection, const char* sql) : stmt(nullptr) {
+        sqlite3_stmt*& cached = connection.statements[sql];
+        if (!cached
+            && sqlite3_prepare_v3(connection.db, sql, -1, SQLITE_PREPARE_PERSISTENT, &cached, nullptr) != SQLITE_OK) {
+            connection.statements.erase(sql);
+            throw DatabaseError("Failed to prepare statement: " + std::string(sqlite3_errmsg(connection.db)));
+        }
+        stmt = cached;
+        if (connection.profiler) {
+            detail::StatementStats*& entry = connection.profiled[sql];
+            if (!entry) {
+                entry = &connection.profiler->statsFor(sql);
+            }
+            profiler = connection.profiler;
+            stats = entry;
+        }
+    }
+    ~Statement() {
+        if (stats && steps > 0) {
+            profiler->record(*stats, nanos, rows,
+                static_cast<uint64_t>(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1)),
+                static_cast<uint64_t>(sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1)));
+        }
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+    Statement(const Statement&) = delete;
+    Statement& operator=(const Statement&) = delete;
+
+    void bind(int index, const std::string& value) {
+        sqlite3_bind_text(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+    }
+    void bind(int index, int64_t value) {
+        sqlite3_bind_int64(stmt, index, value);
+    }
+    void bind(int index, int value) {
+        sqlite3_bind_int(stmt, index, value);
+    }
+    void bindBlob(int index, const std::string& value) {
+        sqlite3_bind_blob(stmt, index, value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT);
+    }
+    int step() {
+        if (!stats) {
+            return sqlite3_step(stmt);
         }
+        const auto start = std::chrono::steady_clock::now();
+        const int result = sqlite3_step(stmt);
+        nanos += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        ++steps;
+        rows += result == SQLITE_ROW ? 1 : 0;
+        return result;
+    }
+    int64_t integer(int column) const {
+        return sqlite3_column_int64(stmt, column);
+    }
+    std::string text(int column) const {
+        const unsigned char* value = sqlite3_column_text(stmt, column);
+        return value ? std::string(reinterpret_cast<const char*>(value), sqlite3_column_bytes(stmt, column)) : "";
+    }
+    std::string blob(int column) const {
+        const void* value = sqlite3_column_blob(stmt, column);
+        return value ? std::string(static_cast<const char*>(value), sqlite3_column_bytes(stmt, column)) : "";
+    }
+
+private:
+    sqlite3_stmt* stmt;
+    detail::StatementProfiler* profiler = nullptr;
+    detail::StatementStats* stats = nullptr; // null unless profiling
+    uint64_t nanos = 0;
+    uint64_t steps = 0;
+    uint64_t rows = 0;
+};
+
+int timedStep(Statement& statement, Metric metric) {
+    ScopedTimer timer(metric);
+    return statement.step();
+}
+
+void execute(sqlite3* db, const char* sql, const std::string& context) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql, nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::string error = errMsg ? errMsg : "Unknown error";
+        sqlite3_free(errMsg);
+        throw DatabaseError(context + ": " + error);
+    }
+}
+
+// "sqlite:///./authlib.db" -> "./authlib.db", "sqlite:////var/a.db" ->
+// "/var/a.db"; anything without the scheme is already a path
+std::string sqlitePath(const std::string& connectionUrl) {
+    const std::string scheme = "sqlite://";
+    if (connectionUrl.compare(0, scheme.size(), scheme) != 0) {
+        return connectionUrl;
+    }
+    std::string path = connectionUrl.substr(scheme.size());
+    if (!path.empty() && path[0] == '/') {
+        path.erase(0, 1);
+    }
+    return path.empty() ? ":memory:" : path;
+}
+
+// "./authlib.db" -> "./authlib.shard2.db"
+std::string shardPath(const std::string& path, size_t shard) {
+    const std::string suffix = ".shard" + std::to_string(shard);
+    size_t slash = path.find_last_of('/');
+    size_t dot = path.find_last_of('.');
+    size_t nameStart = slash == std::string::npos ? 0 : slash + 1;
+    if (dot == std::string::npos || dot <= nameStart) {
+        return path + suffix;
+    }
+    return path.substr(0, dot) + suffix + path.substr(dot);
+}
+
+uint32_t emailSlot(const std::string& canonicalEmail) {
+    return static_cast<uint32_t>(EmailCanonicalizer::hash(canonicalEmail)) & SLOT_MASK;
+}
+
+// Digests and session ids are uniformly random already
+uint32_t randomSlot(const std::string& bytes) {
+    return bytes.empty() ? 0 : static_cast<unsigned char>(bytes[0]);
+}
+
+std::string tokenDigest(const std::string& token) {
+    unsigned char digest[SHA256_DIGEST_LENGTH];
+    SHA256(reinterpret_cast<const unsigned char*>(token.data()), token.size(), digest);
+    return std::string(reinterpret_cast<const char*>(digest), sizeof(digest));
+}
+
+void bindUser(Statement& insert, const User& user, int first) {
+    insert.bind(first, user.email);
+    insert.bind(first + 1, user.emailCanonical);
+    insert.bind(first + 2, static_cast<int64_t>(user.emailHash));
+    insert.bind(first + 3, user.passwordHash);
+    insert.bind(first + 4, user.firstName);
+    insert.bind(first + 5, user.lastName);
+    insert.bind(first + 6, user.isActive ? 1 : 0);
+    insert.bind(first + 7, user.isVerified ? 1 : 0);
+    insert.bind(first + 8, static_cast<int64_t>(user.createdAt));
+    insert.bind(first + 9, static_cast<int64_t>(user.updatedAt));
+    insert.bind(first + 10, static_cast<int64_t>(user.lastLogin));
+}
+
+User readUser(const Statement& row) {
+    User user;
+    user.id = static_cast<uint32_t>(row.integer(0));
+    user.email = row.text(1);
+    user.emailCanonical = row.text(2);
+    user.emailHash = static_cast<uint64_t>(row.integer(3));
+    user.passwordHash = row.text(4);
+    user.firstName = row.text(5);
+    user.lastName = row.text(6);
+    user.isActive = row.integer(7) != 0;
+    user.isVerified = row.integer(8) != 0;
+    user.createdAt = static_cast<std::time_t>(row.integer(9));
+    user.updatedAt = static_cast<std::time_t>(row.integer(10));
+    user.lastLogin = static_cast<std::time_t>(row.integer(11));
+    return user;
+}
+
+} // namespace
+
+Database::Database(const std::string& connectionUrl, uint32_t busyTimeoutMs, uint32_t shards)
+    : connectionUrl(connectionUrl), busyTimeoutMs(busyTimeoutMs), shards(shards) {
+    if (shards == 0 || shards > MAX_SHARDS) {
+        throw DatabaseError("Shard count must be between 1 and " + std::to_string(MAX_SHARDS));
+    }
+}
 
-        dbHandle = db;
-        createTables();
+Database::~Database() = default;
+
+void Database::initialize() {
+    try {
+        const std::string basePath = sqlitePath(connectionUrl);
+        const bool inMemory = basePath == ":memory:";
+        for (size_t shard = 0; shard < shards; ++shard) {
+            std::string path = shards > 1 ? shardPath(basePath, shard) : basePath;
+            if (inMemory) {
+                // Every per-thread connection has to see the same in-memory
+                // database, which plain ":memory:" would not
+#if SQLITE_VERSION_NUMBER >= 3036000
+                path = "file:/authlib-" + std::to_string(memoryDatabaseCount.fetch_add(1)) + "?vfs=memdb";
+#else
+                path = "file:authlib-" + std::to_string(memoryDatabaseCount.fetch_add(1)) + "?mode=memory&cache=shared";
+#endif
+            }
+            pools.push_back(std::make_shared<detail::SqliteConnectionPool>(path, inMemory, busyTimeoutMs, profiler));
+            if (!inMemory) {
+                execute(connection(shard).db, "PRAGMA journal_mode=WAL", "Failed to enable WAL");
+            }
+            createTables(shard);
+        }
+        if (profileConfigured && profileOptions.explainCheck) {
+            for (const std::string& warning : checkQueryPlans()) {
+                profileOptions.log("authlib: " + warning);
+            }
+        }
     } catch (const std::exception& e) {
+        pools.clear();
         throw DatabaseError("Database initialization failed: " + std::string(e.what()));
     }
 }
 
+DatabaseProfileOptions DatabaseProfileOptions::fromConfig(const Config& config) {
+    DatabaseProfileOptions options;
+    options.enabled = config.DATABASE_PROFILE;
+    options.slowQueryMs = config.DATABASE_SLOW_QUERY_MS;
+    options.explainCheck = config.DATABASE_EXPLAIN_CHECK;
+    return options;
+}
+
+void Database::setProfiling(const DatabaseProfileOptions& options) {
+    if (!pools.empty()) {
+        throw DatabaseError("Profiling must be set before initialize()");
+    }
+    profileOptions = options;
+    if (!profileOptions.log) {
+        profileOptions.log = [](const std::string& line) { std::cerr << line << std::endl; };
+    }
+    profileConfigured = true;
+    profiler = options.enabled || options.slowQueryMs > 0
+        ? std::make_shared<detail::StatementProfiler>(profileOptions)
+        : nullptr;
+}
+
+std::vector<StatementProfile> Database::statementProfiles() const {
+    if (!profiler) {
+        return {};
+    }
+    std::vector<StatementProfile> profiles = profiler->profiles();
+    std::sort(profiles.begin(), profiles.end(), [](const StatementProfile& a, const StatementProfile& b) {
+        return a.latency.sumNanos > b.latency.sumNanos;
+    });
+    return profiles;
+}
+
+std::vector<std::string> Database::checkQueryPlans(const std::vector<std::string>& statements) {
+    // Every shard has the same schema, so one plan speaks for all of them
+    sqlite3* db = connection(0).db;
+    std::vector<std::string> warnings;
+    for (const std::string& sql : statements.empty() ? hotStatements() : statements) {
+        const std::string explain = "EXPLAIN QUERY PLAN " + sql;
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, explain.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            std::string error = sqlite3_errmsg(db);
+            sqlite3_finalize(stmt);
+            throw DatabaseError("Failed to explain statement: " + error);
+        }
+        // Rows are (id, parent, notused, detail); a full pass reads "SCAN t"
+        // or "SCAN t USING COVERING INDEX i", a keyed one "SEARCH t USING ..."
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            const unsigned char* detail = sqlite3_column_text(stmt, 3);
+            const std::string plan = detail ? reinterpret_cast<const char*>(detail) : "";
+            if (plan.compare(0, 5, "SCAN ") == 0) {
+                warnings.push_back("full scan (" + plan + ") in: " + sql);
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+    return warnings;
+}
+
 bool Database::isConnected() const {
-    return dbHandle != nullptr;
+    return !pools.empty();
+}
+
+uint32_t Database::shardCount() const {
+    return shards;
+}
+
+size_t Database::shardForSlot(uint32_t slot) const {
+    return shards == 1 ? 0 : slot % shards;
 }
 
-void Database::createTables() {
-    if (!dbHandle) {
+size_t Database::shardForUser(uint32_t id) const {
+    return shards == 1 ? 0 : (id & SLOT_MASK) % shards;
+}
+
+detail::SqliteConnection& Database::connection(size_t shard) const {
+    if (pools.size() <= shard) {
         throw DatabaseError("Database not connected");
     }
+    const std::shared_ptr<detail::SqliteConnectionPool>& pool = pools[shard];
+
+    auto& entries = threadConnections.entries;
+    for (size_t i = 0; i < entries.size();) {
+        if (entries[i].pool.expired()) {
+            // A closed Database (an evicted tenant, say), or one whose
+            // address was reused: drop it so the list stays short
+            entries[i] = entries.back();
+            entries.pop_back();
+            continue;
+        }
+        if (entries[i].key == pool.get()) {
+            return *entries[i].connection;
+        }
+        ++i;
+    }
+
+    detail::SqliteConnection* connection = pool->acquire();
+    entries.push_back({pool, pool.get(), connection});
+    return *connection;
+}
 
-    sqlite3* db = static_cast<sqlite3*>(dbHandle);
+void Database::createTables(size_t shard) {
+    sqlite3* db = connection(shard).db;
     const char* createUsersSQL =
         "CREATE TABLE IF NOT EXISTS users ("
         "id INTEGER PRIMARY KEY AUTOINCREMENT,"
         "email TEXT UNIQUE NOT NULL,"
+        "email_canonical TEXT NOT NULL DEFAULT '',"
+        "email_hash INTEGER NOT NULL DEFAULT 0,"
         "password_hash TEXT NOT NULL,"
         "first_name TEXT,"
         "last_name TEXT,"
@@ -54,56 +602,480 @@ void Database::createTables() {
         "last_login DATETIME"
         ");";
 
-    const char* createTokenBlacklistSQL =
-        "CREATE TABLE IF NOT EXISTS token_blacklist ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "token TEXT NOT NULL,"
+    execute(db, createUsersSQL, "Failed to create users table");
+    migrateEmailCanonical(shard);
+    migrateTokenBlacklist(shard);
+    execute(db, CREATE_TOKEN_BLACKLIST, "Failed to create token_blacklist table");
+    execute(db,
+        "CREATE INDEX IF NOT EXISTS idx_token_blacklist_expires_at ON token_blacklist (expires_at)",
+        "Failed to index token_blacklist");
+    execute(db,
+        "CREATE TABLE IF NOT EXISTS sessions ("
+        "id BLOB PRIMARY KEY,"
         "user_id INTEGER NOT NULL,"
-        "expires_at DATETIME NOT NULL,"
-        "blacklisted_at DATETIME DEFAULT CURRENT_TIMESTAMP"
-        ");";
+        "created_at INTEGER NOT NULL,"
+        "expires_at INTEGER NOT NULL,"
+        "metadata TEXT NOT NULL DEFAULT ''"
+        ") WITHOUT ROWID",
+        "Failed to create sessions table");
+    execute(db,
+        "CREATE INDEX IF NOT EXISTS idx_sessions_expires_at ON sessions (expires_at)",
+        "Failed to index sessions");
+}
 
-    char* errMsg = nullptr;
-    if (sqlite3_exec(db, createUsersSQL, nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        std::string error = errMsg ? errMsg : "Unknown error";
-        sqlite3_free(errMsg);
-        throw DatabaseError("Failed to create users table: " + error);
+void Database::migrateEmailCanonical(size_t shard) {
+    detail::SqliteConnection& conn = connection(shard);
+    sqlite3* db = conn.db;
+
+    bool hasColumn = false;
+    {
+        Statement columns(conn, "PRAGMA table_info(users)");
+        while (columns.step() == SQLITE_ROW) {
+            hasColumn = hasColumn || columns.text(1) == "email_canonical";
+        }
     }
 
-    if (sqlite3_exec(db, createTokenBlacklistSQL, nullptr, nullptr, &errMsg) != SQLITE_OK) {
-        std::string error = errMsg ? errMsg : "Unknown error";
-        sqlite3_free(errMsg);
-        throw DatabaseError("Failed to create token_blacklist table: " + error);
+    if (!hasColumn) {
+        // Tables created before email_canonical existed: add the columns and
+        // backfill them with the default rules
+        execute(db, "BEGIN IMMEDIATE", "Failed to migrate users table");
+        try {
+            execute(db, "ALTER TABLE users ADD COLUMN email_canonical TEXT NOT NULL DEFAULT ''",
+                "Failed to migrate users table");
+            execute(db, "ALTER TABLE users ADD COLUMN email_hash INTEGER NOT NULL DEFAULT 0",
+                "Failed to migrate users table");
+
+            std::vector<std::pair<int64_t, std::string>> rows;
+            {
+                Statement select(conn, "SELECT id, email FROM users");
+                while (select.step() == SQLITE_ROW) {
+                    rows.emplace_back(select.integer(0), select.text(1));
+                }
+            }
+
+            EmailCanonicalizer canonicalizer;
+            for (const auto& row : rows) {
+                std::string canonical = canonicalizer.canonicalize(row.second);
+                Statement update(conn, "UPDATE users SET email_canonical = ?, email_hash = ? WHERE id = ?");
+                update.bind(1, canonical);
+                update.bind(2, static_cast<int64_t>(EmailCanonicalizer::hash(canonical)));
+                update.bind(3, row.first);
+                if (update.step() != SQLITE_DONE) {
+                    throw DatabaseError("Failed to backfill email_canonical: " + std::string(sqlite3_errmsg(db)));
+                }
+            }
+            execute(db, "COMMIT", "Failed to migrate users table");
+        } catch (...) {
+            sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+            throw;
+        }
+    }
+
+    // Fails if two existing accounts only differed by case; those have to
+    // be merged by hand before upgrading
+    execute(db,
+        "CREATE UNIQUE INDEX IF NOT EXISTS idx_users_email_canonical ON users (email_canonical)",
+        "Failed to index email_canonical");
+}
+
+void Database::migrateTokenBlacklist(size_t shard) {
+    detail::SqliteConnection& conn = connection(shard);
+    sqlite3* db = conn.db;
+
+    bool storesTokens = false;
+    {
+        Statement columns(conn, "PRAGMA table_info(token_blacklist)");
+        while (columns.step() == SQLITE_ROW) {
+            storesTokens = storesTokens || columns.text(1) == "token";
+        }
+    }
+    if (!storesTokens) {
+        return;
+    }
+
+    // The first schema kept whole tokens with no index; keep the entries
+    // but store digests from now on
+    execute(db, "BEGIN IMMEDIATE", "Failed to migrate token_blacklist table");
+    try {
+        execute(db, "ALTER TABLE token_blacklist RENAME TO token_blacklist_v1",
+            "Failed to migrate token_blacklist table");
+        execute(db, CREATE_TOKEN_BLACKLIST, "Failed to migrate token_blacklist table");
+        {
+            Statement select(conn, "SELECT token, user_id, expires_at FROM token_blacklist_v1");
+            while (select.step() == SQLITE_ROW) {
+                Statement insert(conn,
+                    "INSERT OR IGNORE INTO token_blacklist (token_digest, user_id, expires_at, blacklisted_at)"
+                    " VALUES (?, ?, ?, strftime('%s', 'now'))");
+                insert.bindBlob(1, tokenDigest(select.text(0)));
+                insert.bind(2, select.integer(1));
+                insert.bind(3, select.integer(2));
+                if (insert.step() != SQLITE_DONE) {
+                    throw DatabaseError("Failed to migrate token_blacklist: " + std::string(sqlite3_errmsg(db)));
+                }
+            }
+        }
+        execute(db, "DROP TABLE token_blacklist_v1", "Failed to migrate token_blacklist table");
+        execute(db, "COMMIT", "Failed to migrate token_blacklist table");
+    } catch (...) {
+        sqlite3_exec(db, "ROLLBACK", nullptr, nullptr, nullptr);
+        throw;
     }
 }
 
 User Database::insertUser(const User& user) {
-    // Implementation for SQLite
-    throw DatabaseError("Not fully implemented in this example");
+    User stored = user;
+    if (stored.emailCanonical.empty()) {
+        stored.emailCanonical = EmailCanonicalizer().canonicalize(stored.email);
+        stored.emailHash = EmailCanonicalizer::hash(stored.emailCanonical);
+    }
+
+    const uint32_t slot = emailSlot(stored.emailCanonical);
+    detail::SqliteConnection& conn = connection(shardForSlot(slot));
+    int result;
+    {
+        ScopedTimer timer(Metric::DbWrite);
+        Statement insert(conn, shards > 1 ? INSERT_USER_IN_SLOT.c_str() : INSERT_USER.c_str());
+        if (shards > 1) {
+            insert.bind(1, static_cast<int64_t>(slot));
+        }
+        bindUser(insert, stored, shards > 1 ? 2 : 1);
+        result = insert.step();
+    }
+    if ((result & 0xff) == SQLITE_CONSTRAINT) {
+        throw UserAlreadyExists("User with email " + stored.email + " already exists");
+    }
+    if (result != SQLITE_DONE) {
+        throw DatabaseError("Failed to insert user: " + std::string(sqlite3_errmsg(conn.db)));
+    }
+
+    const int64_t id = sqlite3_last_insert_rowid(conn.db);
+    if (id > std::numeric_limits<uint32_t>::max()) {
+        Statement remove(conn, "DELETE FROM users WHERE id = ?");
+        remove.bind(1, id);
+        remove.step();
+        throw DatabaseError("User ids exhausted; reshard to spread users over more shards");
+    }
+    stored.id = static_cast<uint32_t>(id);
+    return stored;
 }
 
 User Database::findUserById(uint32_t id) {
-    throw DatabaseError("Not fully implemented in this example");
+    std::optional<User> user = tryFindUserById(id);
+    if (!user) {
+        throw UserNotFound("User with id " + std::to_string(id) + " not found");
+    }
+    return std::move(*user);
 }
 
-User Database::findUserByEmail(const std::string& email) {
-    throw DatabaseError("Not fully implemented in this example");
+User Database::findUserByEmail(const std::string& canonicalEmail) {
+    std::optional<User> user = tryFindUserByEmail(canonicalEmail);
+    if (!user) {
+        throw UserNotFound("User with email " + canonicalEmail + " not found");
+    }
+    return std::move(*user);
+}
+
+std::optional<User> Database::tryFindUserById(uint32_t id) {
+    Statement select(connection(shardForUser(id)), SELECT_USER_BY_ID.c_str());
+    select.bind(1, static_cast<int64_t>(id));
+    if (timedStep(select, Metric::Lookup) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    return readUser(select);
+}
+
+std::optional<User> Database::tryFindUserByEmail(const std::string& canonicalEmail) {
+    Statement select(connection(shardForSlot(emailSlot(canonicalEmail))), SELECT_USER_BY_EMAIL.c_str());
+    select.bind(1, canonicalEmail);
+    if (timedStep(select, Metric::Lookup) != SQLITE_ROW) {
+        return std::nullopt;
+    }
+    return readUser(select);
 }
 
 void Database::updateUser(const User& user) {
-    throw DatabaseError("Not fully implemented in this example");
+    detail::SqliteConnection& conn = connection(shardForUser(user.id));
+
+    Statement update(conn, UPDATE_USER);
+    update.bind(1, user.passwordHash);
+    update.bind(2, user.firstName);
+    update.bind(3, user.lastName);
+    update.bind(4, user.isActive ? 1 : 0);
+    update.bind(5, user.isVerified ? 1 : 0);
+    update.bind(6, static_cast<int64_t>(user.updatedAt));
+    update.bind(7, static_cast<int64_t>(user.lastLogin));
+    update.bind(8, static_cast<int64_t>(user.id));
+
+    if (timedStep(update, Metric::DbWrite) != SQLITE_DONE) {
+        throw DatabaseError("Failed to update user: " + std::string(sqlite3_errmsg(conn.db)));
+    }
+    if (sqlite3_changes(conn.db) == 0) {
+        throw UserNotFound("User with id " + std::to_string(user.id) + " not found");
+    }
+}
+
+void Database::updateLastLogin(uint32_t id, std::time_t lastLogin) {
+    detail::SqliteConnection& conn = connection(shardForUser(id));
+
+    Statement update(conn, UPDATE_LAST_LOGIN);
+    update.bind(1, static_cast<int64_t>(lastLogin));
+    update.bind(2, static_cast<int64_t>(id));
+
+    if (timedStep(update, Metric::DbWrite) != SQLITE_DONE) {
+        throw DatabaseError("Failed to update last login: " + std::string(sqlite3_errmsg(conn.db)));
+    }
+    if (sqlite3_changes(conn.db) == 0) {
+        throw UserNotFound("User with id " + std::to_string(id) + " not found");
+    }
+}
+
+void Database::updatePasswordHash(uint32_t id, const std::string& passwordHash, std::time_t updatedAt) {
+    detail::SqliteConnection& conn = connection(shardForUser(id));
+
+    Statement update(conn, UPDATE_PASSWORD_HASH);
+    update.bind(1, passwordHash);
+    update.bind(2, static_cast<int64_t>(updatedAt));
+    update.bind(3, static_cast<int64_t>(id));
+
+    if (timedStep(update, Metric::DbWrite) != SQLITE_DONE) {
+        throw DatabaseError("Failed to update password hash: " + std::string(sqlite3_errmsg(conn.db)));
+    }
+    if (sqlite3_changes(conn.db) == 0) {
+        throw UserNotFound("User with id " + std::to_string(id) + " not found");
+    }
 }
 
 void Database::blacklistToken(const TokenBlacklist& entry) {
-    throw DatabaseError("Not fully implemented in this example");
+    const std::string digest = tokenDigest(entry.token);
+    detail::SqliteConnection& conn = connection(shardForSlot(randomSlot(digest)));
+
+    Statement insert(conn, INSERT_TOKEN_DIGEST);
+    insert.bindBlob(1, digest);
+    insert.bind(2, static_cast<int64_t>(entry.userId));
+    insert.bind(3, static_cast<int64_t>(entry.expiresAt));
+    insert.bind(4, static_cast<int64_t>(entry.blacklistedAt));
+    if (timedStep(insert, Metric::DbWrite) != SQLITE_DONE) {
+        throw DatabaseError("Failed to blacklist token: " + std::string(sqlite3_errmsg(conn.db)));
+    }
 }
 
 bool Database::isTokenBlacklisted(const std::string& token) {
-    throw DatabaseError("Not fully implemented in this example");
+    const std::string digest = tokenDigest(token);
+    detail::SqliteConnection& conn = connection(shardForSlot(randomSlot(digest)));
+
+    Statement select(conn, SELECT_TOKEN_DIGEST);
+    select.bindBlob(1, digest);
+    int result = timedStep(select, Metric::Lookup);
+    if (result != SQLITE_ROW && result != SQLITE_DONE) {
+        throw DatabaseError("Failed to check token blacklist: " + std::string(sqlite3_errmsg(conn.db)));
+    }
+    return result == SQLITE_ROW;
 }
 
 void Database::cleanExpiredTokens() {
-    throw DatabaseError("Not fully implemented in this example");
+    const std::time_t now = std::time(nullptr);
+    for (size_t shard = 0; shard < shards; ++shard) {
+        detail::SqliteConnection& conn = connection(shard);
+        Statement remove(conn, DELETE_EXPIRED_TOKENS);
+        remove.bind(1, static_cast<int64_t>(now));
+        if (remove.step() != SQLITE_DONE) {
+            throw DatabaseError("Failed to clean token blacklist: " + std::string(sqlite3_errmsg(conn.db)));
+        }
+    }
+}
+
+void Database::saveSessions(const std::vector<Session>& sessions) {
+    std::vector<std::vector<const Session*>> byShard(shards);
+    for (const auto& session : sessions) {
+        byShard[shardForSlot(randomSlot(session.id))].push_back(&session);
+    }
+
+    for (size_t shard = 0; shard < shards; ++shard) {
+        if (byShard[shard].empty()) {
+            continue;
+        }
+        detail::SqliteConnection& conn = connection(shard);
+        execute(conn.db, "BEGIN IMMEDIATE", "Failed to save sessions");
+        try {
+            for (const Session* session : byShard[shard]) {
+                Statement upsert(conn, UPSERT_SESSION);
+                upsert.bindBlob(1, session->id);
+                upsert.bind(2, static_cast<int64_t>(session->userId));
+                upsert.bind(3, static_cast<int64_t>(session->createdAt));
+                upsert.bind(4, static_cast<int64_t>(session->expiresAt));
+                upsert.bind(5, session->metadata);
+                if (upsert.step() != SQLITE_DONE) {
+                    throw DatabaseError("Failed to save session: " + std::string(sqlite3_errmsg(conn.db)));
+                }
+            }
+            execute(conn.db, "COMMIT", "Failed to save sessions");
+        } catch (...) {
+            sqlite3_exec(conn.db, "ROLLBACK", nullptr, nullptr, nullptr);
+            throw;
+        }
+    }
+}
+
+void Database::deleteSessions(const std::vector<std::string>& ids, std::time_t now) {
+    std::vector<std::vector<const std::string*>> byShard(shards);
+    for (const auto& id : ids) {
+        byShard[shardForSlot(randomSlot(id))].push_back(&id);
+    }
+
+    for (size_t shard = 0; shard < shards; ++shard) {
+        detail::SqliteConnection& conn = connection(shard);
+        execute(conn.db, "BEGIN IMMEDIATE", "Failed to delete sessions");
+        try {
+            for (const std::string* id : byShard[shard]) {
+                Statement remove(conn, DELETE_SESSION);
+                remove.bindBlob(1, *id);
+                if (remove.step() != SQLITE_DONE) {
+                    throw DatabaseError("Failed to delete session: " + std::string(sqlite3_errmsg(conn.db)));
+                }
+            }
+            Statement expired(conn, DELETE_EXPIRED_SESSIONS);
+            expired.bind(1, static_cast<int64_t>(now));
+            if (expired.step() != SQLITE_DONE) {
+                throw DatabaseError("Failed to delete expired sessions: " + std::string(sqlite3_errmsg(conn.db)));
+            }
+            execute(conn.db, "COMMIT", "Failed to delete sessions");
+        } catch (...) {
+            sqlite3_exec(conn.db, "ROLLBACK", nullptr, nullptr, nullptr);
+            throw;
+        }
+    }
+}
+
+std::vector<Session> Database::loadSessions(std::time_t now) {
+    std::vector<Session> sessions;
+    for (size_t shard = 0; shard < shards; ++shard) {
+        detail::SqliteConnection& conn = connection(shard);
+        Statement select(conn, SELECT_LIVE_SESSIONS);
+        select.bind(1, static_cast<int64_t>(now));
+
+        int result;
+        while ((result = select.step()) == SQLITE_ROW) {
+            Session session;
+            session.id = select.blob(0);
+            session.userId = static_cast<uint32_t>(select.integer(1));
+            session.createdAt = static_cast<std::time_t>(select.integer(2));
+            session.expiresAt = static_cast<std::time_t>(select.integer(3));
+            session.metadata = select.text(4);
+            sessions.push_back(std::move(session));
+        }
+        if (result != SQLITE_DONE) {
+            throw DatabaseError("Failed to load sessions: " + std::string(sqlite3_errmsg(conn.db)));
+        }
+    }
+    return sessions;
+}
+
+size_t Database::reshard(
+    const std::string& sourceUrl, uint32_t sourceShards,
+    const std::string& targetUrl, uint32_t targetShards,
+    std::ostream* idMap
+) {
+    Database source(sourceUrl, 5000, sourceShards);
+    Database target(targetUrl, 5000, targetShards);
+    source.initialize();
+    target.initialize();
+
+    for (size_t shard = 0; shard < targetShards; ++shard) {
+        Statement count(target.connection(shard),
+            "SELECT (SELECT COUNT(*) FROM users) + (SELECT COUNT(*) FROM token_blacklist)"
+            " + (SELECT COUNT(*) FROM sessions)");
+        if (count.step() != SQLITE_ROW || count.integer(0) != 0) {
+            throw DatabaseError("Reshard target " + targetUrl + " is not empty");
+        }
+    }
+    const bool newIds = sourceShards == 1 && targetShards > 1;
+    // Old id -> new id when renumbering. Revocations and sessions name
+    // their user, and an old small id can be another user's new id, so
+    // they are rewritten too: a revocation of a vanished user keeps its
+    // digest with user 0, a session of one is dropped.
+    std::unordered_map<int64_t, int64_t> renumbered;
+    auto mapUserId = [&](int64_t id) -> int64_t {
+        if (!newIds) {
+            return id;
+        }
+        auto it = renumbered.find(id);
+        return it == renumbered.end() ? 0 : it->second;
+    };
+
+    // One transaction per target shard for the whole copy, so a failure
+    // leaves the target empty again
+    for (size_t shard = 0; shard < targetShards; ++shard) {
+        execute(target.connection(shard).db, "BEGIN IMMEDIATE", "Failed to start reshard");
+    }
+    size_t copied = 0;
+    try {
+        for (size_t from = 0; from < sourceShards; ++from) {
+            detail::SqliteConnection& in = source.connection(from);
+
+            Statement users(in, SELECT_ALL_USERS.c_str());
+            while (users.step() == SQLITE_ROW) {
+                User user = readUser(users);
+                if (newIds) {
+                    User stored = target.insertUser(user);
+                    renumbered.emplace(user.id, stored.id);
+                    if (idMap) {
+                        *idMap << user.id << ' ' << stored.id << '\n';
+                    }
+                } else {
+                    detail::SqliteConnection& out = target.connection(target.shardForUser(user.id));
+                    Statement insert(out, INSERT_USER_WITH_ID.c_str());
+                    insert.bind(1, static_cast<int64_t>(user.id));
+                    bindUser(insert, user, 2);
+                    if (insert.step() != SQLITE_DONE) {
+                        throw DatabaseError("Failed to copy user: " + std::string(sqlite3_errmsg(out.db)));
+                    }
+                }
+                ++copied;
+            }
+
+            Statement revoked(in, "SELECT token_digest, user_id, expires_at, blacklisted_at FROM token_blacklist");
+            while (revoked.step() == SQLITE_ROW) {
+                const std::string digest = revoked.blob(0);
+                detail::SqliteConnection& out = target.connection(target.shardForSlot(randomSlot(digest)));
+                Statement insert(out, INSERT_TOKEN_DIGEST);
+                insert.bindBlob(1, digest);
+                insert.bind(2, mapUserId(revoked.integer(1)));
+                insert.bind(3, revoked.integer(2));
+                insert.bind(4, revoked.integer(3));
+                if (insert.step() != SQLITE_DONE) {
+                    throw DatabaseError("Failed to copy token blacklist: " + std::string(sqlite3_errmsg(out.db)));
+                }
+            }
+
+            Statement sessions(in, "SELECT id, user_id, created_at, expires_at, metadata FROM sessions");
+            while (sessions.step() == SQLITE_ROW) {
+                const int64_t userId = mapUserId(sessions.integer(1));
+                if (userId == 0) {
+                    continue;
+                }
+                const std::string id = sessions.blob(0);
+                detail::SqliteConnection& out = target.connection(target.shardForSlot(randomSlot(id)));
+                Statement insert(out, UPSERT_SESSION);
+                insert.bindBlob(1, id);
+                insert.bind(2, userId);
+                insert.bind(3, sessions.integer(2));
+                insert.bind(4, sessions.integer(3));
+                insert.bind(5, sessions.text(4));
+                if (insert.step() != SQLITE_DONE) {
+                    throw DatabaseError("Failed to copy session: " + std::string(sqlite3_errmsg(out.db)));
+                }
+            }
+        }
+        for (size_t shard = 0; shard < targetShards; ++shard) {
+            execute(target.connection(shard).db, "COMMIT", "Failed to commit reshard");
+        }
+    } catch (...) {
+        for (size_t shard = 0; shard < targetShards; ++shard) {
+            sqlite3_exec(target.connection(shard).db, "ROLLBACK", nullptr, nullptr, nullptr);
+        }
+        throw;
+    }
+    return copied;
 }
 
 } // namespace authlib
@@ -0,0 +1,21 @@
+#include <authlib/models/Session.h>
+
+namespace authlib {
+
+Session::Session()
+    : id(""),
+      userId(0),
+      createdAt(std::time(nullptr)),
+      expiresAt(0),
+      metadata("") {}
+
+json Session::toJson() const {
+    return json{
+        {"userId", userId},
+        {"createdAt", createdAt},
+        {"expiresAt", expiresAt},
+        {"metadata", metadata}
+    };
+}
+
+} // namespace authlib
@@ -6,6 +6,8 @@ namespace authlib {
 User::User()
     : id(0),
       email(""),
+      emailCanonical(""),
+      emailHash(0),
       passwordHash(""),
       firstName(""),
       lastName(""),
@@ -29,6 +31,26 @@ json User::toJson() const {
     };
 }
 
+void User::writeJson(JsonWriter& writer) const {
+    writer.beginObject()
+        .key("id").number(static_cast<uint64_t>(id))
+        .key("email").string(email)
+        .key("firstName").string(firstName)
+        .key("lastName").string(lastName)
+        .key("isActive").boolean(isActive)
+        .key("isVerified").boolean(isVerified)
+        .key("createdAt").number(static_cast<int64_t>(createdAt))
+        .key("updatedAt").number(static_cast<int64_t>(updatedAt))
+        .key("lastLogin").number(static_cast<int64_t>(lastLogin))
+        .endObject();
+}
+
+void User::appendJson(std::string& out) const {
+    out.reserve(out.size() + 160 + email.size() + firstName.size() + lastName.size());
+    JsonWriter writer(out);
+    writeJson(writer);
+}
+
 std::string User::toString() const {
     std::stringstream ss;
     ss << "<User(id=" << id << ", email=" << email << ", isActive=" << isActive << ")>";
@@ -0,0 +1,271 @@
+#include <authlib/observability/Metrics.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <mutex>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Each histogram counter is written by exactly one thread, so recording is
+// a relaxed load and store rather than fetch_add: on x86 that is two plain
+// movs where fetch_add would be a locked instruction. The counters are
+// still atomics so a scrape on another thread reads them without a data
+// race. When a thread exits its block is folded into `retired` under the
+// registry lock and freed; scrapes take the same lock, so a thread's counts
+// are seen exactly once whichever side of its exit the scrape lands.
+
+namespace authlib {
+
+namespace {
+
+constexpr size_t METRIC_COUNT = static_cast<size_t>(Metric::COUNT);
+
+const char* const NAMES[METRIC_COUNT] = {
+    "register", "login", "refresh", "logout", "validate", "lookup",
+    "hash", "hash_verify", "db_write", "sign", "verify"
+};
+
+// Exported bucket bounds are 2^FIRST_BOUND .. 2^LAST_BOUND ns, each the
+// start of one of our octaves
+constexpr int FIRST_BOUND = 10;
+constexpr int LAST_BOUND = 34;
+
+struct Histogram {
+    std::atomic<uint64_t> buckets[Metrics::BUCKETS] = {}; // their total is the count
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> sum{0};
+};
+
+struct ThreadMetrics {
+    Histogram histograms[METRIC_COUNT];
+};
+
+// Index of the highest set bit; `value` is never 0
+int topBit(uint64_t value) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+void bump(std::atomic<uint64_t>& counter, uint64_t amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void addInto(Histogram& target, const Histogram& source) {
+    for (size_t i = 0; i < Metrics::BUCKETS; ++i) {
+        bump(target.buckets[i], source.buckets[i].load(std::memory_order_relaxed));
+    }
+    bump(target.errors, source.errors.load(std::memory_order_relaxed));
+    bump(target.sum, source.sum.load(std::memory_order_relaxed));
+}
+
+void clear(Histogram& histogram) {
+    for (auto& bucket : histogram.buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    histogram.errors.store(0, std::memory_order_relaxed);
+    histogram.sum.store(0, std::memory_order_relaxed);
+}
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadMetrics*> live;
+    ThreadMetrics retired;
+};
+
+Registry& registry() {
+    // Leaked: threads may still exit (and retire their blocks) during
+    // static destruction
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+// Owns the calling thread's block; only constructed on the first recording
+struct ThreadHandle {
+    ThreadMetrics* block;
+
+    ThreadHandle() : block(new ThreadMetrics()) {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.live.push_back(block);
+    }
+
+    ~ThreadHandle() {
+        Registry& r = registry();
+        {
+            std::lock_guard<std::mutex> lock(r.mutex);
+            for (size_t i = 0; i < METRIC_COUNT; ++i) {
+                addInto(r.retired.histograms[i], block->histograms[i]);
+            }
+            r.live.erase(std::find(r.live.begin(), r.live.end(), block));
+        }
+        delete block;
+    }
+};
+
+// A trivially destructible pointer keeps the hot path free of the
+// thread_local init guard; the handle is only touched once per thread
+thread_local ThreadMetrics* localBlock = nullptr;
+
+ThreadMetrics& localMetrics() {
+    if (!localBlock) {
+        thread_local ThreadHandle handle;
+        localBlock = handle.block;
+    }
+    return *localBlock;
+}
+
+void add(Metric metric, uint64_t nanos, bool error) {
+    nanos = std::min(nanos, Metrics::MAX_NANOS);
+    Histogram& histogram = localMetrics().histograms[static_cast<size_t>(metric)];
+    bump(histogram.buckets[Metrics::bucketFor(nanos)], 1);
+    bump(histogram.sum, nanos);
+    if (error) {
+        bump(histogram.errors, 1);
+    }
+}
+
+void appendSeconds(std::string& out, double seconds) {
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%.9g", seconds);
+    out.append(text, static_cast<size_t>(length));
+}
+
+} // namespace
+
+uint64_t MetricSnapshot::percentile(double q) const {
+    if (count == 0 || buckets.empty()) {
+        return 0;
+    }
+    q = std::min(std::max(q, 0.0), 1.0);
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(count))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            uint64_t lower = Metrics::bucketLower(i);
+            uint64_t upper = i + 1 < Metrics::BUCKETS ? Metrics::bucketLower(i + 1) : Metrics::MAX_NANOS + 1;
+            return lower + (upper - lower) / 2;
+        }
+    }
+    return Metrics::MAX_NANOS;
+}
+
+size_t Metrics::bucketFor(uint64_t nanos) {
+    if (nanos < 8) {
+        return static_cast<size_t>(nanos);
+    }
+    nanos = std::min(nanos, MAX_NANOS);
+    // Octave from the top bit, then the 3 bits below it pick the sub-bucket
+    int exponent = topBit(nanos);
+    return static_cast<size_t>((exponent - 2) * 8) + ((nanos >> (exponent - 3)) & 7);
+}
+
+uint64_t Metrics::bucketLower(size_t index) {
+    if (index < 8) {
+        return index;
+    }
+    int exponent = static_cast<int>(index / 8) + 2;
+    return (8 + (index % 8)) << (exponent - 3);
+}
+
+void Metrics::record(Metric metric, uint64_t nanos) {
+    add(metric, nanos, false);
+}
+
+void Metrics::recordError(Metric metric, uint64_t nanos) {
+    add(metric, nanos, true);
+}
+
+const char* Metrics::name(Metric metric) {
+    return NAMES[static_cast<size_t>(metric)];
+}
+
+MetricSnapshot Metrics::snapshot(Metric metric) {
+    const size_t index = static_cast<size_t>(metric);
+    Histogram merged;
+
+    Registry& r = registry();
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        addInto(merged, r.retired.histograms[index]);
+        for (ThreadMetrics* block : r.live) {
+            addInto(merged, block->histograms[index]);
+        }
+    }
+
+    // The count is summed from the buckets this snapshot holds rather than
+    // kept alongside them, so a scrape that lands mid-record still sees
+    // cumulative buckets that never pass it
+    MetricSnapshot result;
+    result.errors = merged.errors.load(std::memory_order_relaxed);
+    result.sumNanos = merged.sum.load(std::memory_order_relaxed);
+    result.buckets.resize(BUCKETS);
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        result.buckets[i] = merged.buckets[i].load(std::memory_order_relaxed);
+        result.count += result.buckets[i];
+    }
+    return result;
+}
+
+std::string Metrics::prometheus() {
+    std::string out;
+    out.reserve(METRIC_COUNT * 2048);
+
+    out += "# HELP authlib_operation_duration_seconds Latency of authlib operations and their phases\n";
+    out += "# TYPE authlib_operation_duration_seconds histogram\n";
+    std::vector<MetricSnapshot> snapshots;
+    snapshots.reserve(METRIC_COUNT);
+    for (size_t m = 0; m < METRIC_COUNT; ++m) {
+        snapshots.push_back(snapshot(static_cast<Metric>(m)));
+        const MetricSnapshot& s = snapshots.back();
+        const std::string label = std::string("op=\"") + NAMES[m] + "\"";
+
+        // A power of two is the first value of its octave, so everything
+        // below the bound is exactly the buckets before bucketFor(bound)
+        uint64_t cumulative = 0;
+        size_t next = 0;
+        for (int bound = FIRST_BOUND; bound <= LAST_BOUND; ++bound) {
+            size_t end = bucketFor(uint64_t(1) << bound);
+            for (; next < end; ++next) {
+                cumulative += s.buckets[next];
+            }
+            out += "authlib_operation_duration_seconds_bucket{" + label + ",le=\"";
+            appendSeconds(out, static_cast<double>(uint64_t(1) << bound) / 1e9);
+            out += "\"} " + std::to_string(cumulative) + "\n";
+        }
+        out += "authlib_operation_duration_seconds_bucket{" + label + ",le=\"+Inf\"} " + std::to_string(s.count) + "\n";
+        out += "authlib_operation_duration_seconds_sum{" + label + "} ";
+        appendSeconds(out, static_cast<double>(s.sumNanos) / 1e9);
+        out += "\nauthlib_operation_duration_seconds_count{" + label + "} " + std::to_string(s.count) + "\n";
+    }
+
+    out += "# HELP authlib_operation_errors_total Operations that failed, by exception or returned error\n";
+    out += "# TYPE authlib_operation_errors_total counter\n";
+    for (size_t m = 0; m < METRIC_COUNT; ++m) {
+        out += std::string("authlib_operation_errors_total{op=\"") + NAMES[m] + "\"} "
+            + std::to_string(snapshots[m].errors) + "\n";
+    }
+    return out;
+}
+
+void Metrics::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& histogram : r.retired.histograms) {
+        clear(histogram);
+    }
+    for (ThreadMetrics* block : r.live) {
+        for (auto& histogram : block->histograms) {
+            clear(histogram);
+        }
+    }
+}
+
+} // namespace authlib
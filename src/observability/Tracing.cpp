@@ -0,0 +1,169 @@
+#include <authlib/observability/Tracing.h>
+#include <authlib/utils/JsonWriter.h>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <exception>
+#include <stdexcept>
+
+// The installed sink is a shared_ptr read with std::atomic_load, but only
+// after a relaxed check of `enabled`, so the untraced path never touches
+// the shared_ptr's lock. A request copies the pointer once and records all
+// its spans to that copy, which is what keeps a replaced sink alive until
+// the requests using it finish.
+
+namespace authlib {
+
+namespace {
+
+std::atomic<bool> enabled{false};
+std::shared_ptr<TraceSink> installed;
+std::atomic<uint64_t> nextTraceId{1};
+std::atomic<uint32_t> nextThread{1};
+
+thread_local uint64_t currentTraceId = 0;
+
+uint64_t nowNanos() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t threadNumber() {
+    thread_local uint32_t number = nextThread.fetch_add(1, std::memory_order_relaxed);
+    return number;
+}
+
+// Nanoseconds as microseconds with three decimals, the unit Chrome expects
+void appendMicros(std::string& out, uint64_t nanos) {
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%" PRIu64 ".%03u", nanos / 1000, static_cast<unsigned>(nanos % 1000));
+    out.append(text, static_cast<size_t>(length));
+}
+
+} // namespace
+
+void Tracing::setSink(std::shared_ptr<TraceSink> sink) {
+    const bool on = sink != nullptr;
+    std::atomic_store(&installed, std::move(sink));
+    enabled.store(on, std::memory_order_relaxed);
+}
+
+std::shared_ptr<TraceSink> Tracing::sink() {
+    return std::atomic_load(&installed);
+}
+
+bool Tracing::compiledIn() {
+#ifdef AUTHLIB_WITH_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+TraceContext::TraceContext(uint64_t traceId) : previous(currentTraceId) {
+    currentTraceId = traceId;
+}
+
+TraceContext::~TraceContext() {
+    currentTraceId = previous;
+}
+
+uint64_t TraceContext::current() {
+    return currentTraceId;
+}
+
+uint64_t TraceContext::newId() {
+    return nextTraceId.fetch_add(1, std::memory_order_relaxed);
+}
+
+RequestTrace::RequestTrace(const char* name) : name(name) {
+    if (!enabled.load(std::memory_order_relaxed)) {
+        return;
+    }
+    sink = std::atomic_load(&installed);
+    if (!sink) {
+        return;
+    }
+    traceId = currentTraceId != 0 ? currentTraceId : TraceContext::newId();
+    exceptions = std::uncaught_exceptions();
+    start = nowNanos();
+}
+
+RequestTrace::~RequestTrace() {
+    if (!sink) {
+        return;
+    }
+    const uint64_t now = nowNanos();
+    const bool error = failed || std::uncaught_exceptions() > exceptions;
+    endPhase(now, error);
+    sink->record({name, name, traceId, start, now - start, threadNumber(), error});
+}
+
+void RequestTrace::phase(const char* next) {
+    if (!sink) {
+        return;
+    }
+    const uint64_t now = nowNanos();
+    endPhase(now, false);
+    phaseName = next;
+    phaseStart = now;
+}
+
+void RequestTrace::fail() {
+    failed = true;
+}
+
+void RequestTrace::endPhase(uint64_t now, bool error) {
+    if (phaseName) {
+        sink->record({phaseName, name, traceId, phaseStart, now - phaseStart, threadNumber(), error});
+        phaseName = nullptr;
+    }
+}
+
+ChromeTraceWriter::ChromeTraceWriter(const std::string& path) : out(path, std::ios::trunc) {
+    if (!out) {
+        throw std::runtime_error("Cannot open trace file: " + path);
+    }
+    out << "[\n";
+}
+
+ChromeTraceWriter::~ChromeTraceWriter() {
+    std::lock_guard<std::mutex> lock(mutex);
+    out << "\n]\n";
+}
+
+void ChromeTraceWriter::record(const TraceEvent& event) {
+    thread_local std::string line;
+    line.clear();
+    line += "{\"name\":";
+    JsonWriter::appendEscaped(line, event.name);
+    line += ",\"cat\":";
+    JsonWriter::appendEscaped(line, event.request);
+    line += ",\"ph\":\"X\",\"ts\":";
+    appendMicros(line, event.startNanos);
+    line += ",\"dur\":";
+    appendMicros(line, event.durationNanos);
+    line += ",\"pid\":1,\"tid\":";
+    line += std::to_string(event.thread);
+    line += ",\"args\":{\"trace\":";
+    line += std::to_string(event.traceId);
+    if (event.error) {
+        line += ",\"error\":true";
+    }
+    line += "}}";
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!first) {
+        out << ",\n";
+    }
+    first = false;
+    out << line;
+}
+
+void ChromeTraceWriter::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    out.flush();
+}
+
+} // namespace authlib
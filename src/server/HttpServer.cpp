@@ -0,0 +1,414 @@
+#include <authlib/server/HttpServer.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/utils/JsonWriter.h>
+#include <authlib/utils/Result.h>
+#include <authlib/utils/exceptions.h>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <algorithm>
+#include <chrono>
+#include <optional>
+#include <thread>
+
+// One io_context per worker thread, created with a concurrency hint of 1
+// so its scheduler runs single-threaded. Asio still takes its internal
+// locks (only BOOST_ASIO_CONCURRENCY_HINT_UNSAFE drops them, and without
+// SO_REUSEPORT one acceptor hands sockets to the other workers' contexts,
+// which needs them). Sessions are the usual Beast
+// read -> dispatch -> write loop; the routes are a table of path, method
+// and handler, and every AuthService exception maps to a status code in
+// one place (dispatch).
+
+namespace authlib {
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = asio::ip::tcp;
+
+namespace detail {
+
+class HttpWorker {
+public:
+    asio::io_context context{1};
+    asio::executor_work_guard<asio::io_context::executor_type> work = asio::make_work_guard(context);
+    std::unique_ptr<tcp::acceptor> acceptor; // null on workers that only serve connections
+    std::vector<asio::io_context*> targets;  // where this acceptor's connections go
+    size_t next = 0;
+    std::thread thread;
+};
+
+} // namespace detail
+
+namespace {
+
+#if defined(__linux__) && defined(SO_REUSEPORT)
+// Only Linux balances connections across SO_REUSEPORT listeners
+constexpr bool REUSE_PORT_BALANCES = true;
+using ReusePort = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#else
+constexpr bool REUSE_PORT_BALANCES = false;
+#endif
+
+using Request = http::request<http::string_body>;
+using Response = http::response<http::string_body>;
+
+Response makeResponse(http::status status, std::string body, unsigned version, bool keepAlive) {
+    Response response(status, version);
+    response.set(http::field::server, "authd");
+    response.set(http::field::content_type, "application/json");
+    response.keep_alive(keepAlive);
+    response.body() = std::move(body);
+    response.prepare_payload();
+    return response;
+}
+
+json parseBody(const Request& request) {
+    json body = json::parse(request.body(), nullptr, false);
+    if (body.is_discarded() || !body.is_object()) {
+        throw ValidationError("Request body must be a JSON object");
+    }
+    return body;
+}
+
+std::string field(const json& body, const char* name) {
+    auto it = body.find(name);
+    if (it == body.end() || !it->is_string()) {
+        throw ValidationError(std::string("Missing string field \"") + name + "\"");
+    }
+    return it->get<std::string>();
+}
+
+std::string bearerToken(const Request& request) {
+    beast::string_view header = request[http::field::authorization];
+    if (header.size() <= 7 || !beast::iequals(header.substr(0, 7), "Bearer ")) {
+        throw InvalidToken("Missing bearer token");
+    }
+    return std::string(header.substr(7));
+}
+
+// Handlers append their response body to `out`; the two hot ones write
+// AuthResponse text directly rather than going through a json tree.
+// Login, verify and refresh return their expected failures instead of
+// throwing them; malformed requests and the rest still throw.
+Result<void> handleRegister(AuthService& auth, const Request& request, std::string& out) {
+    json body = parseBody(request);
+    Result<AuthResponse> result = auth.tryRegisterUser({
+        field(body, "email"),
+        field(body, "password"),
+        body.value("firstName", ""),
+        body.value("lastName", "")
+    });
+    if (!result) {
+        return result.error();
+    }
+    result.value().appendJson(out);
+    return {};
+}
+
+Result<void> handleLogin(AuthService& auth, const Request& request, std::string& out) {
+    json body = parseBody(request);
+    Result<AuthResponse> result = auth.tryLogin({field(body, "email"), field(body, "password")});
+    if (result.code() == ErrorCode::UserNotFound) {
+        // Same status and body as a wrong password. This doesn't hide which
+        // accounts exist: an unknown email answers before any hashing, and
+        // /auth/register answers 409 for a taken one; rate-limit both.
+        return AuthError{ErrorCode::InvalidCredentials, InvalidCredentials().what()};
+    }
+    if (!result) {
+        return result.error();
+    }
+    result.value().appendJson(out);
+    return {};
+}
+
+Result<void> handleVerify(AuthService& auth, const Request& request, std::string& out) {
+    Result<TokenPayload> result = auth.tryVerifyToken(bearerToken(request));
+    if (!result) {
+        return result.error();
+    }
+    const TokenPayload& payload = result.value();
+    JsonWriter(out).beginObject()
+        .key("userId").number(static_cast<uint64_t>(payload.userId))
+        .key("email").string(payload.email)
+        .key("type").string(payload.type)
+        .key("exp").number(static_cast<uint64_t>(payload.exp))
+        .endObject();
+    return {};
+}
+
+Result<void> handleRefresh(AuthService& auth, const Request& request, std::string& out) {
+    json body = parseBody(request);
+    Result<std::string> result = auth.tryRefreshAccessToken(field(body, "refreshToken"));
+    if (!result) {
+        return result.error();
+    }
+    JsonWriter(out).beginObject().key("accessToken").string(result.value()).endObject();
+    return {};
+}
+
+Result<void> handleLogout(AuthService& auth, const Request& request, std::string& out) {
+    json body = parseBody(request);
+    Result<void> result = auth.tryLogout(field(body, "accessToken"), field(body, "refreshToken"));
+    if (!result) {
+        return result;
+    }
+    JsonWriter(out).beginObject().key("success").boolean(true).endObject();
+    return {};
+}
+
+http::status statusFor(ErrorCode code) {
+    switch (code) {
+        case ErrorCode::ValidationError:
+            return http::status::bad_request;
+        case ErrorCode::InvalidCredentials:
+        case ErrorCode::InvalidToken:
+            return http::status::unauthorized;
+        case ErrorCode::UserAlreadyExists:
+            return http::status::conflict;
+        case ErrorCode::UserNotFound:
+            return http::status::not_found;
+        default:
+            return http::status::internal_server_error;
+    }
+}
+
+struct Route {
+    const char* path;
+    http::verb method;
+    http::status success;
+    Result<void> (*handle)(AuthService&, const Request&, std::string&);
+};
+
+const Route ROUTES[] = {
+    {"/auth/register", http::verb::post, http::status::created, handleRegister},
+    {"/auth/login", http::verb::post, http::status::ok, handleLogin},
+    {"/auth/verify", http::verb::get, http::status::ok, handleVerify},
+    {"/auth/refresh", http::verb::post, http::status::ok, handleRefresh},
+    {"/auth/logout", http::verb::post, http::status::ok, handleLogout}
+};
+
+Response dispatch(AuthService& auth, const Request& request, bool metrics) {
+    const unsigned version = request.version();
+    const bool keepAlive = request.keep_alive();
+    auto error = [&](http::status status, const std::string& message) {
+        return makeResponse(status, json{{"error", message}}.dump(), version, keepAlive);
+    };
+
+    beast::string_view path = request.target();
+    path = path.substr(0, path.find('?'));
+
+    if (metrics && path == "/metrics" && request.method() == http::verb::get) {
+        Response response = makeResponse(http::status::ok, Metrics::prometheus(), version, keepAlive);
+        response.set(http::field::content_type, "text/plain; version=0.0.4");
+        return response;
+    }
+
+    try {
+        for (const auto& route : ROUTES) {
+            if (path != route.path) {
+                continue;
+            }
+            if (request.method() != route.method) {
+                Response response = error(http::status::method_not_allowed, "Method not allowed");
+                response.set(http::field::allow, http::to_string(route.method));
+                return response;
+            }
+            std::string body;
+            Result<void> handled = route.handle(auth, request, body);
+            if (!handled) {
+                return error(statusFor(handled.error().code), handled.error().message);
+            }
+            return makeResponse(route.success, std::move(body), version, keepAlive);
+        }
+        return error(http::status::not_found, "No such endpoint");
+    } catch (const ValidationError& e) {
+        return error(http::status::bad_request, e.what());
+    } catch (const InvalidCredentials& e) {
+        return error(http::status::unauthorized, e.what());
+    } catch (const InvalidToken& e) {
+        return error(http::status::unauthorized, e.what());
+    } catch (const UserAlreadyExists& e) {
+        return error(http::status::conflict, e.what());
+    } catch (const UserNotFound& e) {
+        return error(http::status::not_found, e.what());
+    } catch (const std::exception&) {
+        // Database and library internals stay out of responses
+        return error(http::status::internal_server_error, "Internal server error");
+    }
+}
+
+class Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(tcp::socket socket, AuthService& auth, const HttpServerOptions& options)
+        : stream(std::move(socket)), auth(auth), options(options) {}
+
+    void start() {
+        // The socket may belong to another worker's loop; start there
+        asio::dispatch(stream.get_executor(), [self = shared_from_this()]() { self->readRequest(); });
+    }
+
+private:
+    beast::tcp_stream stream;
+    beast::flat_buffer buffer;
+    std::optional<http::request_parser<http::string_body>> parser;
+    Response response;
+    AuthService& auth;
+    const HttpServerOptions& options;
+
+    void readRequest() {
+        parser.emplace();
+        parser->body_limit(options.maxBodyBytes);
+        stream.expires_after(std::chrono::seconds(options.idleTimeoutSeconds));
+        http::async_read(stream, buffer, *parser, [self = shared_from_this()](beast::error_code ec, size_t) {
+            self->onRead(ec);
+        });
+    }
+
+    void onRead(beast::error_code ec) {
+        if (ec == http::error::body_limit) {
+            response = makeResponse(http::status::payload_too_large, json{{"error", "Request body too large"}}.dump(), 11, false);
+            writeResponse();
+            return;
+        }
+        if (ec) {
+            // end_of_stream, idle timeout or a broken connection
+            close();
+            return;
+        }
+        response = dispatch(auth, parser->get(), options.metrics);
+        writeResponse();
+    }
+
+    void writeResponse() {
+        stream.expires_after(std::chrono::seconds(options.idleTimeoutSeconds));
+        http::async_write(stream, response, [self = shared_from_this()](beast::error_code ec, size_t) {
+            if (ec || !self->response.keep_alive()) {
+                self->close();
+                return;
+            }
+            self->readRequest();
+        });
+    }
+
+    void close() {
+        beast::error_code ignored;
+        stream.socket().shutdown(tcp::socket::shutdown_send, ignored);
+    }
+};
+
+std::unique_ptr<tcp::acceptor> openAcceptor(asio::io_context& context, const tcp::endpoint& endpoint, bool reusePort) {
+    auto acceptor = std::make_unique<tcp::acceptor>(context);
+    acceptor->open(endpoint.protocol());
+    acceptor->set_option(asio::socket_base::reuse_address(true));
+#if defined(__linux__) && defined(SO_REUSEPORT)
+    if (reusePort) {
+        acceptor->set_option(ReusePort(true));
+    }
+#else
+    (void)reusePort;
+#endif
+    acceptor->bind(endpoint);
+    acceptor->listen(asio::socket_base::max_listen_connections);
+    return acceptor;
+}
+
+void acceptNext(detail::HttpWorker& worker, AuthService& auth, const HttpServerOptions& options) {
+    asio::io_context& target = *worker.targets[worker.next++ % worker.targets.size()];
+    worker.acceptor->async_accept(target, [&worker, &auth, &options](beast::error_code ec, tcp::socket socket) {
+        if (ec == asio::error::operation_aborted) {
+            return;
+        }
+        if (!ec) {
+            std::make_shared<Session>(std::move(socket), auth, options)->start();
+        }
+        acceptNext(worker, auth, options);
+    });
+}
+
+} // namespace
+
+HttpServerOptions HttpServerOptions::fromConfig(const Config& config) {
+    HttpServerOptions options;
+    options.address = config.HTTP_BIND_ADDRESS;
+    options.port = static_cast<uint16_t>(config.HTTP_PORT);
+    options.threads = config.HTTP_THREADS;
+    options.reusePort = config.HTTP_REUSE_PORT;
+    options.idleTimeoutSeconds = config.HTTP_IDLE_TIMEOUT_SECONDS;
+    options.maxBodyBytes = config.HTTP_MAX_BODY_BYTES;
+    options.metrics = config.HTTP_METRICS;
+    return options;
+}
+
+HttpServer::HttpServer(AuthService& authService, const HttpServerOptions& options)
+    : authService(authService), options(options), boundPort(0) {}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+void HttpServer::start() {
+    if (!workers.empty()) {
+        return;
+    }
+
+    const size_t threads = options.threads > 0
+        ? options.threads
+        : std::max(1u, std::thread::hardware_concurrency());
+    const bool sharded = options.reusePort && REUSE_PORT_BALANCES;
+    tcp::endpoint endpoint(asio::ip::make_address(options.address), options.port);
+
+    try {
+        for (size_t i = 0; i < threads; ++i) {
+            workers.push_back(std::make_unique<detail::HttpWorker>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            detail::HttpWorker& worker = *workers[i];
+            if (sharded) {
+                worker.targets = {&worker.context};
+            } else if (i == 0) {
+                for (auto& each : workers) {
+                    worker.targets.push_back(&each->context);
+                }
+            } else {
+                continue;
+            }
+            worker.acceptor = openAcceptor(worker.context, endpoint, sharded);
+            // With port 0 the later listeners join whatever port the first one got
+            endpoint.port(worker.acceptor->local_endpoint().port());
+        }
+    } catch (...) {
+        workers.clear();
+        throw;
+    }
+    boundPort = endpoint.port();
+
+    for (auto& worker : workers) {
+        if (worker->acceptor) {
+            acceptNext(*worker, authService, options);
+        }
+        worker->thread = std::thread([context = &worker->context]() { context->run(); });
+    }
+}
+
+void HttpServer::stop() {
+    for (auto& worker : workers) {
+        worker->context.stop();
+    }
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+    workers.clear();
+}
+
+uint16_t HttpServer::port() const {
+    return boundPort;
+}
+
+} // namespace authlib
@@ -0,0 +1,219 @@
+#include <authlib/services/AsyncAuthService.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/observability/Tracing.h>
+#include <authlib/utils/exceptions.h>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <optional>
+#include <thread>
+#include <type_traits>
+
+// Each step that would block (a database call or a password hash) is
+// co_spawned onto the matching pool; co_spawn hands the result back through
+// the awaiting coroutine's executor, so the code between co_awaits always
+// runs on the caller's event loop. Steps capture the coroutine's locals by
+// reference, which is safe because the frame stays alive while suspended.
+// The try* coroutines are the real implementations, built from the same
+// AuthService steps as its try* calls and timed and traced the same way;
+// the throwing ones unwrap them.
+
+namespace authlib {
+
+namespace {
+
+namespace asio = boost::asio;
+
+// co_spawn default-constructs a step's result, which Result<T> can't be,
+// so values travel back in an optional
+template <typename Function>
+asio::awaitable<std::invoke_result_t<Function>> runOn(asio::thread_pool& pool, Function function) {
+    using Value = std::invoke_result_t<Function>;
+    if constexpr (std::is_void_v<Value>) {
+        co_return co_await asio::co_spawn(
+            pool.get_executor(),
+            [function = std::move(function)]() mutable -> asio::awaitable<void> {
+                co_return function();
+            },
+            asio::use_awaitable
+        );
+    } else {
+        std::optional<Value> value = co_await asio::co_spawn(
+            pool.get_executor(),
+            [function = std::move(function)]() mutable -> asio::awaitable<std::optional<Value>> {
+                co_return function();
+            },
+            asio::use_awaitable
+        );
+        co_return std::move(*value);
+    }
+}
+
+size_t computeThreads(const Config& config) {
+    if (config.ASYNC_COMPUTE_THREADS > 0) {
+        return config.ASYNC_COMPUTE_THREADS;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+AsyncAuthService::AsyncAuthService(Database& database, const Config& config)
+    : AsyncAuthService(database, std::make_shared<ConfigStore>(std::make_shared<const Config>(config))) {}
+
+AsyncAuthService::AsyncAuthService(Database& database, std::shared_ptr<ConfigStore> configStore)
+    : auth(database, configStore),
+      computePool(computeThreads(*configStore->snapshot())),
+      ioPool(configStore->snapshot()->ASYNC_IO_THREADS) {}
+
+AsyncAuthService::~AsyncAuthService() {
+    computePool.join();
+    ioPool.join();
+}
+
+asio::awaitable<AuthResponse> AsyncAuthService::registerUserAsync(RegisterInput input) {
+    Result<AuthResponse> result = co_await tryRegisterUserAsync(std::move(input));
+    co_return std::move(result).valueOrThrow();
+}
+
+asio::awaitable<Result<AuthResponse>> AsyncAuthService::tryRegisterUserAsync(RegisterInput input) {
+    ScopedTimer timer(Metric::Register);
+    AUTHLIB_TRACE_REQUEST(trace, "register");
+    auto fail = [&](AuthError error) {
+        timer.fail();
+        AUTHLIB_TRACE_FAIL(trace);
+        return error;
+    };
+
+    AUTHLIB_TRACE_PHASE(trace, "validate");
+    CreateUserInput userInput{input.email, input.password, input.firstName, input.lastName};
+    Result<void> checked = co_await runOn(ioPool, [&]() { return auth.userService.tryCheckNewUser(userInput); });
+    if (!checked) {
+        co_return fail(checked.error());
+    }
+
+    AUTHLIB_TRACE_PHASE(trace, "hash_password");
+    std::string passwordHash = co_await runOn(computePool, [&]() {
+        return auth.passwordHandler.hashPassword(userInput.password);
+    });
+
+    AUTHLIB_TRACE_PHASE(trace, "insert_user");
+    Result<User> inserted = co_await runOn(ioPool, [&]() { return auth.insertNewUser(userInput, passwordHash); });
+    if (!inserted) {
+        co_return fail(inserted.error());
+    }
+    User& user = inserted.value();
+
+    AUTHLIB_TRACE_PHASE(trace, "issue_tokens");
+    TokenPair tokens = auth.generateTokens(user);
+    co_return AuthResponse{true, std::move(user), std::move(tokens.accessToken), std::move(tokens.refreshToken)};
+}
+
+asio::awaitable<AuthResponse> AsyncAuthService::loginAsync(LoginInput input) {
+    Result<AuthResponse> result = co_await tryLoginAsync(std::move(input));
+    co_return std::move(result).valueOrThrow();
+}
+
+asio::awaitable<Result<AuthResponse>> AsyncAuthService::tryLoginAsync(LoginInput input) {
+    ScopedTimer timer(Metric::Login);
+    AUTHLIB_TRACE_REQUEST(trace, "login");
+    auto fail = [&](AuthError error) {
+        timer.fail();
+        AUTHLIB_TRACE_FAIL(trace);
+        return error;
+    };
+
+    AUTHLIB_TRACE_PHASE(trace, "validate");
+    Result<void> valid = auth.validateLogin(input);
+    if (!valid) {
+        co_return fail(valid.error());
+    }
+
+    AUTHLIB_TRACE_PHASE(trace, "lookup_user");
+    Result<User> found = co_await runOn(ioPool, [&]() { return auth.findActiveUser(input.email); });
+    if (!found) {
+        co_return fail(found.error());
+    }
+    User& user = found.value();
+
+    // Verify, and rehash an outdated hash while we hold the plaintext
+    AUTHLIB_TRACE_PHASE(trace, "verify_password");
+    Result<std::string> upgradedHash = co_await runOn(computePool, [&]() -> Result<std::string> {
+        Result<void> checked = auth.checkPassword(input.password, user);
+        if (!checked) {
+            return checked.error();
+        }
+        return auth.passwordHandler.needsRehashing(user.passwordHash)
+            ? auth.passwordHandler.hashPassword(input.password)
+            : std::string();
+    });
+    if (!upgradedHash) {
+        co_return fail(upgradedHash.error());
+    }
+
+    AUTHLIB_TRACE_PHASE(trace, "update_last_login");
+    user = co_await runOn(ioPool, [&]() {
+        if (!upgradedHash.value().empty()) {
+            auth.userService.updatePasswordHash(user.id, upgradedHash.value());
+        }
+        return auth.userService.updateLastLogin(user.id);
+    });
+
+    AUTHLIB_TRACE_PHASE(trace, "issue_tokens");
+    TokenPair tokens = auth.generateTokens(user);
+    co_return AuthResponse{true, std::move(user), std::move(tokens.accessToken), std::move(tokens.refreshToken)};
+}
+
+asio::awaitable<TokenPayload> AsyncAuthService::verifyTokenAsync(std::string token) {
+    co_return auth.verifyToken(token);
+}
+
+asio::awaitable<Result<TokenPayload>> AsyncAuthService::tryVerifyTokenAsync(std::string token) {
+    co_return auth.tryVerifyToken(token);
+}
+
+asio::awaitable<json> AsyncAuthService::refreshAccessTokenAsync(std::string refreshToken) {
+    Result<std::string> result = co_await tryRefreshAccessTokenAsync(std::move(refreshToken));
+    std::string accessToken = std::move(result).valueOrThrow();
+    co_return json{{"accessToken", std::move(accessToken)}};
+}
+
+asio::awaitable<Result<std::string>> AsyncAuthService::tryRefreshAccessTokenAsync(std::string refreshToken) {
+    ScopedTimer timer(Metric::Refresh);
+    AUTHLIB_TRACE_REQUEST(trace, "refresh");
+    auto fail = [&](AuthError error) {
+        timer.fail();
+        AUTHLIB_TRACE_FAIL(trace);
+        return error;
+    };
+
+    AUTHLIB_TRACE_PHASE(trace, "verify_token");
+    Result<TokenPayload> decoded = auth.verifyRefreshToken(refreshToken);
+    if (!decoded) {
+        co_return fail(decoded.error());
+    }
+
+    AUTHLIB_TRACE_PHASE(trace, "check_blacklist");
+    bool revoked = co_await runOn(ioPool, [&]() { return auth.database.isTokenBlacklisted(refreshToken); });
+    if (revoked) {
+        co_return fail({ErrorCode::InvalidToken, "Token has been revoked"});
+    }
+
+    AUTHLIB_TRACE_PHASE(trace, "issue_tokens");
+    co_return auth.jwtHandler.createAccessToken(decoded.value().userId, decoded.value().email);
+}
+
+asio::awaitable<json> AsyncAuthService::logoutAsync(std::string accessToken, std::string refreshToken) {
+    Result<void> result = co_await tryLogoutAsync(std::move(accessToken), std::move(refreshToken));
+    result.valueOrThrow();
+    co_return json{{"success", true}};
+}
+
+asio::awaitable<Result<void>> AsyncAuthService::tryLogoutAsync(std::string accessToken, std::string refreshToken) {
+    co_return co_await runOn(ioPool, [&]() { return auth.tryLogout(accessToken, refreshToken); });
+}
+
+AuthService& AsyncAuthService::blocking() {
+    return auth;
+}
+
+} // namespace authlib
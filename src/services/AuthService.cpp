@@ -1,9 +1,34 @@
 #include <authlib/services/AuthService.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/observability/Tracing.h>
 #include <authlib/utils/Validators.h>
 #include <authlib/utils/exceptions.h>
+#include <chrono>
+#include <optional>
 
 namespace authlib {
 
+namespace {
+
+PasswordHandler makePasswordHandler(const Config& config) {
+    PasswordHashParams params;
+    params.algorithm = PasswordHandler::algorithmFromName(config.PASSWORD_HASH_ALGORITHM);
+    params.iterations = config.PASSWORD_HASH_ITERATIONS;
+    params.memoryKiB = config.PASSWORD_ARGON2_MEMORY_KIB;
+    params.timeCost = config.PASSWORD_ARGON2_TIME_COST;
+    params.parallelism = config.PASSWORD_ARGON2_PARALLELISM;
+
+    if (params.algorithm == PasswordAlgorithm::Pbkdf2Sha256 && config.PASSWORD_HASH_TARGET_MS > 0) {
+        params.iterations = PasswordHandler::calibrateIterations(
+            std::chrono::milliseconds(config.PASSWORD_HASH_TARGET_MS),
+            config.PASSWORD_HASH_ITERATIONS
+        );
+    }
+    return PasswordHandler(params);
+}
+
+} // namespace
+
 json AuthResponse::toJson() const {
     return json{
         {"success", success},
@@ -13,113 +38,267 @@ json AuthResponse::toJson() const {
     };
 }
 
+void AuthResponse::appendJson(std::string& out) const {
+    out.reserve(
+        out.size() + 256 + accessToken.size() + refreshToken.size()
+        + user.email.size() + user.firstName.size() + user.lastName.size()
+    );
+    JsonWriter writer(out);
+    writeJson(writer);
+}
+
+void AuthResponse::writeJson(JsonWriter& writer) const {
+    writer.beginObject().key("success").boolean(success).key("user");
+    user.writeJson(writer);
+    writer.key("accessToken").string(accessToken)
+        .key("refreshToken").string(refreshToken)
+        .endObject();
+}
+
 AuthService::AuthService(Database& database, const Config& config)
+    : AuthService(database, std::make_shared<ConfigStore>(std::make_shared<const Config>(config))) {}
+
+AuthService::AuthService(Database& database, std::shared_ptr<ConfigStore> configStore, const std::string& tenantId)
     : database(database),
-      userService(database),
-      jwtHandler(config),
-      config(config) {}
+      configStore(std::move(configStore)),
+      passwordHandler(makePasswordHandler(*this->configStore->snapshot())),
+      passwordPolicy(PasswordPolicy::fromConfig(*this->configStore->snapshot())),
+      userService(
+          database,
+          passwordHandler,
+          passwordPolicy,
+          EmailCanonicalizer::fromConfig(*this->configStore->snapshot())
+      ),
+      jwtHandler(this->configStore, tenantId) {}
 
 AuthResponse AuthService::registerUser(const RegisterInput& input) {
-    // Validate inputs
-    EmailValidator::validate(input.email);
-    PasswordValidator::validate(input.password);
+    return tryRegisterUser(input).valueOrThrow();
+}
+
+Result<AuthResponse> AuthService::tryRegisterUser(const RegisterInput& input) {
+    ScopedTimer timer(Metric::Register);
+    AUTHLIB_TRACE_REQUEST(trace, "register");
+    auto fail = [&](AuthError error) {
+        timer.fail();
+        AUTHLIB_TRACE_FAIL(trace);
+        return error;
+    };
 
-    // Create user
+    // Validate inputs; tryCheckNewUser checks the email, applies the
+    // password policy, reports every violation at once and makes sure the
+    // email is free
+    AUTHLIB_TRACE_PHASE(trace, "validate");
     CreateUserInput userInput{input.email, input.password, input.firstName, input.lastName};
-    User user = userService.createUser(userInput);
+    Result<void> checked = userService.tryCheckNewUser(userInput);
+    if (!checked) {
+        return fail(checked.error());
+    }
+
+    // Create user (createUser's steps, split so each phase is traced)
+    AUTHLIB_TRACE_PHASE(trace, "hash_password");
+    std::string passwordHash = passwordHandler.hashPassword(userInput.password);
+    AUTHLIB_TRACE_PHASE(trace, "insert_user");
+    Result<User> inserted = insertNewUser(userInput, passwordHash);
+    if (!inserted) {
+        return fail(inserted.error());
+    }
+    User& user = inserted.value();
 
     // Generate tokens
-    json tokens = generateTokens(user);
+    AUTHLIB_TRACE_PHASE(trace, "issue_tokens");
+    TokenPair tokens = generateTokens(user);
 
-    return {
-        true,
-        user,
-        tokens["accessToken"].get<std::string>(),
-        tokens["refreshToken"].get<std::string>()
-    };
+    return AuthResponse{true, std::move(user), std::move(tokens.accessToken), std::move(tokens.refreshToken)};
 }
 
 AuthResponse AuthService::login(const LoginInput& input) {
+    return tryLogin(input).valueOrThrow();
+}
+
+Result<AuthResponse> AuthService::tryLogin(const LoginInput& input) {
+    ScopedTimer timer(Metric::Login);
+    AUTHLIB_TRACE_REQUEST(trace, "login");
+    auto fail = [&](AuthError error) {
+        timer.fail();
+        AUTHLIB_TRACE_FAIL(trace);
+        return error;
+    };
+
     // Validate inputs
-    EmailValidator::validate(input.email);
+    AUTHLIB_TRACE_PHASE(trace, "validate");
+    Result<void> valid = validateLogin(input);
+    if (!valid) {
+        return fail(valid.error());
+    }
 
     // Find user
-    User user = userService.getUserByEmail(input.email);
-
-    // Check if user is active
-    if (!user.isActive) {
-        throw InvalidCredentials("User account is deactivated");
+    AUTHLIB_TRACE_PHASE(trace, "lookup_user");
+    Result<User> found = findActiveUser(input.email);
+    if (!found) {
+        return fail(found.error());
     }
+    User& user = found.value();
 
     // Verify password
-    if (!passwordHandler.verifyPassword(input.password, user.passwordHash)) {
-        throw InvalidCredentials("Invalid email or password");
+    AUTHLIB_TRACE_PHASE(trace, "verify_password");
+    Result<void> checked = checkPassword(input.password, user);
+    if (!checked) {
+        return fail(checked.error());
+    }
+
+    // Upgrade hashes made under an older algorithm or cost while we hold the plaintext
+    if (passwordHandler.needsRehashing(user.passwordHash)) {
+        AUTHLIB_TRACE_PHASE(trace, "rehash_password");
+        user = userService.updatePasswordHash(user.id, passwordHandler.hashPassword(input.password));
     }
 
     // Update last login
-    userService.updateLastLogin(user.id);
+    AUTHLIB_TRACE_PHASE(trace, "update_last_login");
+    user = userService.updateLastLogin(user.id);
 
     // Generate tokens
-    json tokens = generateTokens(user);
+    AUTHLIB_TRACE_PHASE(trace, "issue_tokens");
+    TokenPair tokens = generateTokens(user);
 
-    return {
-        true,
-        user,
-        tokens["accessToken"].get<std::string>(),
-        tokens["refreshToken"].get<std::string>()
-    };
+    return AuthResponse{true, std::move(user), std::move(tokens.accessToken), std::move(tokens.refreshToken)};
 }
 
 TokenPayload AuthService::verifyToken(const std::string& token) {
     return jwtHandler.verifyToken(token);
 }
 
+Result<TokenPayload> AuthService::tryVerifyToken(const std::string& token) {
+    return jwtHandler.tryVerifyToken(token);
+}
+
 json AuthService::refreshAccessToken(const std::string& refreshToken) {
-    TokenPayload decoded = jwtHandler.verifyToken(refreshToken);
+    return json{{"accessToken", tryRefreshAccessToken(refreshToken).valueOrThrow()}};
+}
+
+Result<std::string> AuthService::tryRefreshAccessToken(const std::string& refreshToken) {
+    ScopedTimer timer(Metric::Refresh);
+    AUTHLIB_TRACE_REQUEST(trace, "refresh");
+    auto fail = [&](AuthError error) {
+        timer.fail();
+        AUTHLIB_TRACE_FAIL(trace);
+        return error;
+    };
 
-    if (decoded.type != "refresh") {
-        throw InvalidToken("Invalid token type");
+    AUTHLIB_TRACE_PHASE(trace, "verify_token");
+    Result<TokenPayload> decoded = verifyRefreshToken(refreshToken);
+    if (!decoded) {
+        return fail(decoded.error());
     }
 
     // Check if token is blacklisted
+    AUTHLIB_TRACE_PHASE(trace, "check_blacklist");
     if (database.isTokenBlacklisted(refreshToken)) {
-        throw InvalidToken("Token has been revoked");
+        return fail({ErrorCode::InvalidToken, "Token has been revoked"});
     }
 
     // Generate new access token
-    std::string accessToken = jwtHandler.createAccessToken(decoded.userId, decoded.email);
-
-    return json{{"accessToken", accessToken}};
+    AUTHLIB_TRACE_PHASE(trace, "issue_tokens");
+    return jwtHandler.createAccessToken(decoded.value().userId, decoded.value().email);
 }
 
 json AuthService::logout(const std::string& accessToken, const std::string& refreshToken) {
-    TokenPayload accessPayload = jwtHandler.decodeToken(accessToken);
-    TokenPayload refreshPayload = jwtHandler.decodeToken(refreshToken);
+    tryLogout(accessToken, refreshToken).valueOrThrow();
+    return json{{"success", true}};
+}
+
+Result<void> AuthService::tryLogout(const std::string& accessToken, const std::string& refreshToken) {
+    ScopedTimer timer(Metric::Logout);
+    AUTHLIB_TRACE_REQUEST(trace, "logout");
+    auto fail = [&](AuthError error) {
+        timer.fail();
+        AUTHLIB_TRACE_FAIL(trace);
+        return error;
+    };
+
+    // Only the holder of a validly signed pair can revoke it; decoding
+    // alone would let anyone blacklist (or fill the table with) forged
+    // tokens
+    AUTHLIB_TRACE_PHASE(trace, "verify_tokens");
+    Result<TokenPayload> accessPayload = jwtHandler.tryVerifyToken(accessToken);
+    if (!accessPayload) {
+        return fail(accessPayload.error());
+    }
+    Result<TokenPayload> refreshPayload = jwtHandler.tryVerifyToken(refreshToken);
+    if (!refreshPayload) {
+        return fail(refreshPayload.error());
+    }
+    if (accessPayload.value().type != "access" || refreshPayload.value().type != "refresh") {
+        return fail({ErrorCode::InvalidToken, "Invalid token type"});
+    }
+    if (accessPayload.value().userId != refreshPayload.value().userId) {
+        return fail({ErrorCode::InvalidToken, "Tokens belong to different users"});
+    }
 
     // Blacklist both tokens
     TokenBlacklist accessEntry;
     accessEntry.token = accessToken;
-    accessEntry.userId = accessPayload.userId;
-    accessEntry.expiresAt = accessPayload.exp;
+    accessEntry.userId = accessPayload.value().userId;
+    accessEntry.expiresAt = accessPayload.value().exp;
 
     TokenBlacklist refreshEntry;
     refreshEntry.token = refreshToken;
-    refreshEntry.userId = refreshPayload.userId;
-    refreshEntry.expiresAt = refreshPayload.exp;
+    refreshEntry.userId = refreshPayload.value().userId;
+    refreshEntry.expiresAt = refreshPayload.value().exp;
 
+    AUTHLIB_TRACE_PHASE(trace, "blacklist_tokens");
     database.blacklistToken(accessEntry);
     database.blacklistToken(refreshEntry);
+    return {};
+}
 
-    return json{{"success", true}};
+Result<void> AuthService::validateLogin(const LoginInput& input) {
+    ScopedTimer validate(Metric::Validate);
+    if (const char* problem = EmailValidator::problem(input.email)) {
+        validate.fail();
+        return AuthError{ErrorCode::ValidationError, problem};
+    }
+    return {};
 }
 
-json AuthService::generateTokens(const User& user) {
-    std::string accessToken = jwtHandler.createAccessToken(user.id, user.email);
-    std::string refreshToken = jwtHandler.createRefreshToken(user.id, user.email);
+Result<User> AuthService::findActiveUser(const std::string& email) {
+    std::optional<User> found = userService.tryGetUserByEmail(email);
+    if (!found) {
+        return AuthError{ErrorCode::UserNotFound, "User with email " + email + " not found"};
+    }
+    if (!found->isActive) {
+        return AuthError{ErrorCode::InvalidCredentials, "User account is deactivated"};
+    }
+    return std::move(*found);
+}
 
-    return json{
-        {"accessToken", accessToken},
-        {"refreshToken", refreshToken}
+Result<void> AuthService::checkPassword(const std::string& password, const User& user) {
+    if (!passwordHandler.verifyPassword(password, user.passwordHash)) {
+        return AuthError{ErrorCode::InvalidCredentials, "Invalid email or password"};
+    }
+    return {};
+}
+
+Result<User> AuthService::insertNewUser(const CreateUserInput& input, const std::string& passwordHash) {
+    try {
+        return userService.insertUser(input, passwordHash);
+    } catch (const UserAlreadyExists& e) {
+        // Only a concurrent registration of the same email gets here
+        return AuthError{ErrorCode::UserAlreadyExists, e.what()};
+    }
+}
+
+Result<TokenPayload> AuthService::verifyRefreshToken(const std::string& refreshToken) {
+    Result<TokenPayload> decoded = jwtHandler.tryVerifyToken(refreshToken);
+    if (decoded && decoded.value().type != "refresh") {
+        return AuthError{ErrorCode::InvalidToken, "Invalid token type"};
+    }
+    return decoded;
+}
+
+TokenPair AuthService::generateTokens(const User& user) {
+    return {
+        jwtHandler.createAccessToken(user.id, user.email),
+        jwtHandler.createRefreshToken(user.id, user.email)
     };
 }
 
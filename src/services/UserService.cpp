@@ -1,36 +1,69 @@
 #include <authlib/services/UserService.h>
+#include <authlib/observability/Metrics.h>
 #include <authlib/utils/PasswordHandler.h>
+#include <authlib/utils/PasswordPolicy.h>
 #include <authlib/utils/Validators.h>
 #include <authlib/utils/exceptions.h>
 
 namespace authlib {
 
-UserService::UserService(Database& database) : database(database) {}
+UserService::UserService(
+    Database& database,
+    const PasswordHandler& passwordHandler,
+    std::shared_ptr<const PasswordPolicy> passwordPolicy,
+    const EmailCanonicalizer& emailCanonicalizer
+)
+    : database(database),
+      passwordHandler(passwordHandler),
+      passwordPolicy(std::move(passwordPolicy)),
+      emailCanonicalizer(emailCanonicalizer) {}
 
 User UserService::createUser(const CreateUserInput& input) {
+    checkNewUser(input);
+    return insertUser(input, passwordHandler.hashPassword(input.password));
+}
+
+void UserService::checkNewUser(const CreateUserInput& input) {
+    tryCheckNewUser(input).valueOrThrow();
+}
+
+Result<void> UserService::tryCheckNewUser(const CreateUserInput& input) {
     // Validate email and password
-    EmailValidator::validate(input.email);
-    PasswordValidator::validate(input.password);
+    {
+        ScopedTimer validate(Metric::Validate);
+        if (const char* problem = EmailValidator::problem(input.email)) {
+            validate.fail();
+            return AuthError{ErrorCode::ValidationError, problem};
+        }
+        std::string violations = passwordPolicy
+            ? passwordPolicy->violationMessage(input.password, input.email)
+            : PasswordValidator::defaultPolicy().violationMessage(input.password);
+        if (!violations.empty()) {
+            validate.fail();
+            return AuthError{ErrorCode::ValidationError, std::move(violations)};
+        }
+    }
 
     // Check if user exists
-    try {
-        getUserByEmail(input.email);
-        throw UserAlreadyExists("User with email " + input.email + " already exists");
-    } catch (const UserNotFound&) {
-        // Expected - user doesn't exist yet
+    if (tryGetUserByEmail(input.email)) {
+        return AuthError{ErrorCode::UserAlreadyExists, "User with email " + input.email + " already exists"};
     }
+    return {};
+}
 
-    // Hash password
-    PasswordHandler passwordHandler;
+User UserService::insertUser(const CreateUserInput& input, const std::string& passwordHash) {
     User user;
     user.email = input.email;
-    user.passwordHash = passwordHandler.hashPassword(input.password);
+    user.emailCanonical = emailCanonicalizer.canonicalize(input.email);
+    user.emailHash = EmailCanonicalizer::hash(user.emailCanonical);
+    user.passwordHash = passwordHash;
     user.firstName = input.firstName;
     user.lastName = input.lastName;
     user.isActive = true;
     user.isVerified = false;
 
-    // Insert user into database
+    // Insert user into database; the UNIQUE index on email_canonical
+    // catches a concurrent registration that passed checkNewUser
     return database.insertUser(user);
 }
 
@@ -39,7 +72,11 @@ User UserService::getUserById(uint32_t userId) {
 }
 
 User UserService::getUserByEmail(const std::string& email) {
-    return database.findUserByEmail(email);
+    return database.findUserByEmail(emailCanonicalizer.canonicalize(email));
+}
+
+std::optional<User> UserService::tryGetUserByEmail(const std::string& email) {
+    return database.tryFindUserByEmail(emailCanonicalizer.canonicalize(email));
 }
 
 User UserService::updateUser(uint32_t userId, const User& updates) {
@@ -75,9 +112,13 @@ User UserService::verifyUser(uint32_t userId) {
 }
 
 User UserService::updateLastLogin(uint32_t userId) {
-    User user = getUserById(userId);
-    user.lastLogin = std::time(nullptr);
-    return updateUser(userId, user);
+    database.updateLastLogin(userId, std::time(nullptr));
+    return getUserById(userId);
+}
+
+User UserService::updatePasswordHash(uint32_t userId, const std::string& passwordHash) {
+    database.updatePasswordHash(userId, passwordHash, std::time(nullptr));
+    return getUserById(userId);
 }
 
 } // namespace authlib
@@ -0,0 +1,496 @@
+#include <authlib/session/SessionStore.h>
+#include <authlib/utils/SecureRandom.h>
+#include <authlib/utils/exceptions.h>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+// Sessions are keyed by their raw 32 random bytes. The bytes are uniform,
+// so the hash is the first 8 of them and the shard the next 8: no hashing
+// work at all, and shard choice and bucket choice stay independent.
+//
+// Each shard's wheel holds exactly one entry per session. An entry that
+// comes due looks its session up: gone means revoked (drop it), expired
+// means expire it, and anything else was touched and is rescheduled at its
+// new expiresAt. Cascading from the upper levels reschedules the same way.
+
+namespace authlib {
+
+namespace {
+
+constexpr size_t ID_BYTES = 32;
+constexpr size_t ENCODED_ID_LENGTH = 43;
+
+constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+using SessionKey = std::array<unsigned char, ID_BYTES>;
+
+struct KeyHash {
+    size_t operator()(const SessionKey& key) const noexcept {
+        uint64_t prefix;
+        std::memcpy(&prefix, key.data(), sizeof(prefix));
+        return static_cast<size_t>(prefix);
+    }
+};
+
+struct SessionRecord {
+    uint32_t userId;
+    bool queued; // on the shard's write-behind list; sits in what would be padding
+    std::time_t createdAt;
+    std::time_t expiresAt;
+    std::string metadata;
+};
+
+std::string encodeId(const SessionKey& key) {
+    std::string out;
+    out.reserve(ENCODED_ID_LENGTH);
+    size_t i = 0;
+    for (; i + 3 <= ID_BYTES; i += 3) {
+        uint32_t n = (key[i] << 16) | (key[i + 1] << 8) | key[i + 2];
+        out.push_back(ALPHABET[(n >> 18) & 63]);
+        out.push_back(ALPHABET[(n >> 12) & 63]);
+        out.push_back(ALPHABET[(n >> 6) & 63]);
+        out.push_back(ALPHABET[n & 63]);
+    }
+    // 32 = 30 + 2: two bytes left, three characters
+    uint32_t n = (key[i] << 16) | (key[i + 1] << 8);
+    out.push_back(ALPHABET[(n >> 18) & 63]);
+    out.push_back(ALPHABET[(n >> 12) & 63]);
+    out.push_back(ALPHABET[(n >> 6) & 63]);
+    return out;
+}
+
+std::array<int8_t, 256> makeDecodeTable() {
+    std::array<int8_t, 256> table;
+    table.fill(-1);
+    for (int i = 0; i < 64; ++i) {
+        table[static_cast<unsigned char>(ALPHABET[i])] = static_cast<int8_t>(i);
+    }
+    return table;
+}
+
+const std::array<int8_t, 256> DECODE = makeDecodeTable();
+
+// Strict: exactly 43 alphabet characters with the unused low bits zero, so
+// every session has one spelling
+bool decodeId(const std::string& id, SessionKey& key) {
+    if (id.size() != ENCODED_ID_LENGTH) {
+        return false;
+    }
+    uint32_t values[ENCODED_ID_LENGTH];
+    for (size_t i = 0; i < ENCODED_ID_LENGTH; ++i) {
+        int8_t value = DECODE[static_cast<unsigned char>(id[i])];
+        if (value < 0) {
+            return false;
+        }
+        values[i] = static_cast<uint32_t>(value);
+    }
+    if (values[ENCODED_ID_LENGTH - 1] & 3) {
+        return false;
+    }
+    size_t in = 0;
+    size_t out = 0;
+    for (; out + 3 <= ID_BYTES; out += 3, in += 4) {
+        uint32_t n = (values[in] << 18) | (values[in + 1] << 12) | (values[in + 2] << 6) | values[in + 3];
+        key[out] = static_cast<unsigned char>(n >> 16);
+        key[out + 1] = static_cast<unsigned char>(n >> 8);
+        key[out + 2] = static_cast<unsigned char>(n);
+    }
+    uint32_t n = (values[in] << 18) | (values[in + 1] << 12) | (values[in + 2] << 6);
+    key[out] = static_cast<unsigned char>(n >> 16);
+    key[out + 1] = static_cast<unsigned char>(n >> 8);
+    return true;
+}
+
+/**
+ * Four levels of 64 slots. Level n slots are 64^n seconds wide; an entry
+ * sits in the lowest level whose range covers its deadline and drops a
+ * level each time the level below wraps round to it.
+ */
+class TimingWheel {
+public:
+    static constexpr int LEVELS = 4;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr std::time_t SLOT_MASK = (1 << SLOT_BITS) - 1;
+    static constexpr std::time_t RANGE = std::time_t(1) << (SLOT_BITS * LEVELS);
+
+    explicit TimingWheel(std::time_t start) : current(start) {}
+
+    // Deadlines beyond the range park in the top level and are
+    // rescheduled from there when they come round
+    void schedule(const SessionKey& key, std::time_t deadline) {
+        std::time_t delta = deadline - current;
+        if (delta < 0) {
+            deadline = current;
+            delta = 0;
+        } else if (delta >= RANGE) {
+            deadline = current + RANGE - 1;
+            delta = RANGE - 1;
+        }
+        int level = 0;
+        while (delta >= (std::time_t(1) << (SLOT_BITS * (level + 1)))) {
+            ++level;
+        }
+        slots[level][(deadline >> (SLOT_BITS * level)) & SLOT_MASK].push_back(key);
+    }
+
+    /**
+     * Process every second up to and including `to`. `deadlineOf(key)`
+     * returns the live session's expiresAt or 0 if it is gone;
+     * `expired(key)` removes one.
+     */
+    template <typename DeadlineOf, typename Expired>
+    void advance(std::time_t to, DeadlineOf&& deadlineOf, Expired&& expired) {
+        for (; current <= to; ++current) {
+            for (int level = 1; level < LEVELS; ++level) {
+                if ((current >> (SLOT_BITS * (level - 1))) & SLOT_MASK) {
+                    break;
+                }
+                reschedule(slots[level][(current >> (SLOT_BITS * level)) & SLOT_MASK], deadlineOf);
+            }
+
+            scratch.swap(slots[0][current & SLOT_MASK]);
+            for (const SessionKey& key : scratch) {
+                std::time_t deadline = deadlineOf(key);
+                if (deadline == 0) {
+                    continue;
+                }
+                if (deadline <= current) {
+                    expired(key);
+                } else {
+                    schedule(key, deadline);
+                }
+            }
+            scratch.clear();
+        }
+    }
+
+private:
+    std::time_t current; // the next second to process
+    std::array<std::array<std::vector<SessionKey>, 1 << SLOT_BITS>, LEVELS> slots;
+    std::vector<SessionKey> scratch;
+
+    template <typename DeadlineOf>
+    void reschedule(std::vector<SessionKey>& slot, DeadlineOf& deadlineOf) {
+        scratch.swap(slot);
+        for (const SessionKey& key : scratch) {
+            std::time_t deadline = deadlineOf(key);
+            if (deadline != 0) {
+                schedule(key, deadline);
+            }
+        }
+        scratch.clear();
+    }
+};
+
+} // namespace
+
+namespace detail {
+
+class SessionShard {
+public:
+    explicit SessionShard(std::time_t start) : wheel(start) {}
+
+    std::mutex mutex;
+    std::unordered_map<SessionKey, SessionRecord, KeyHash> sessions;
+    TimingWheel wheel;
+    std::vector<SessionKey> dirty;   // created or touched since the last flush
+    std::vector<SessionKey> removed; // revoked since the last flush
+
+    void markDirty(const SessionKey& key, SessionRecord& record) {
+        if (!record.queued) {
+            record.queued = true;
+            dirty.push_back(key);
+        }
+    }
+};
+
+} // namespace detail
+
+SessionStoreOptions SessionStoreOptions::fromConfig(const Config& config) {
+    SessionStoreOptions options;
+    options.shards = config.SESSION_SHARDS;
+    options.ttlSeconds = config.SESSION_TTL_SECONDS;
+    options.sweepIntervalMs = config.SESSION_SWEEP_INTERVAL_MS;
+    options.persist = config.SESSION_PERSIST;
+    return options;
+}
+
+SessionStore::SessionStore(const SessionStoreOptions& options, Database* database)
+    : options(options), database(database), shardMask(0), stopping(false) {
+    if (this->options.persist && !database) {
+        throw ConfigError("SESSION_PERSIST needs a Database");
+    }
+    if (this->options.ttlSeconds == 0) {
+        throw ConfigError("Session TTL must be positive");
+    }
+
+    size_t count = 1;
+    while (count < this->options.shards) {
+        count <<= 1;
+    }
+    shardMask = count - 1;
+    const std::time_t start = now();
+    for (size_t i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<detail::SessionShard>(start));
+    }
+
+    if (this->options.sweepIntervalMs > 0) {
+        sweeper = std::thread([this]() { sweepLoop(); });
+    }
+}
+
+SessionStore::~SessionStore() {
+    {
+        std::lock_guard<std::mutex> lock(sweepMutex);
+        stopping = true;
+    }
+    sweepWake.notify_all();
+    if (sweeper.joinable()) {
+        sweeper.join();
+    }
+    try {
+        flush();
+    } catch (const std::exception&) {
+        // Nowhere to report it from a destructor; the sessions expire anyway
+    }
+}
+
+std::time_t SessionStore::now() const {
+    return options.clock ? options.clock() : std::time(nullptr);
+}
+
+detail::SessionShard& SessionStore::shardFor(const unsigned char* key) const {
+    uint64_t bits;
+    std::memcpy(&bits, key + 8, sizeof(bits));
+    return *shards[static_cast<size_t>(bits) & shardMask];
+}
+
+std::string SessionStore::create(uint32_t userId, const std::string& metadata, uint32_t ttlSeconds) {
+    const std::time_t createdAt = now();
+    const std::time_t expiresAt = createdAt + (ttlSeconds ? ttlSeconds : options.ttlSeconds);
+
+    SessionKey key;
+    while (true) {
+        SecureRandom::fill(key.data(), key.size());
+        detail::SessionShard& shard = shardFor(key.data());
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.sessions.try_emplace(key, SessionRecord{userId, false, createdAt, expiresAt, metadata});
+        if (!inserted) {
+            continue;
+        }
+        shard.wheel.schedule(key, expiresAt);
+        if (options.persist) {
+            shard.markDirty(key, it->second);
+        }
+        break;
+    }
+    return encodeId(key);
+}
+
+bool SessionStore::validate(const std::string& sessionId, Session* session) const {
+    SessionKey key;
+    if (!decodeId(sessionId, key)) {
+        return false;
+    }
+    const std::time_t at = now();
+
+    detail::SessionShard& shard = shardFor(key.data());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(key);
+    if (it == shard.sessions.end() || it->second.expiresAt <= at) {
+        return false;
+    }
+    if (session) {
+        session->id.assign(reinterpret_cast<const char*>(key.data()), key.size());
+        session->userId = it->second.userId;
+        session->createdAt = it->second.createdAt;
+        session->expiresAt = it->second.expiresAt;
+        session->metadata = it->second.metadata;
+    }
+    return true;
+}
+
+bool SessionStore::touch(const std::string& sessionId, uint32_t ttlSeconds) {
+    SessionKey key;
+    if (!decodeId(sessionId, key)) {
+        return false;
+    }
+    const std::time_t at = now();
+
+    detail::SessionShard& shard = shardFor(key.data());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(key);
+    if (it == shard.sessions.end() || it->second.expiresAt <= at) {
+        return false;
+    }
+    it->second.expiresAt = at + (ttlSeconds ? ttlSeconds : options.ttlSeconds);
+    if (options.persist) {
+        shard.markDirty(key, it->second);
+    }
+    return true;
+}
+
+bool SessionStore::revoke(const std::string& sessionId) {
+    SessionKey key;
+    if (!decodeId(sessionId, key)) {
+        return false;
+    }
+
+    detail::SessionShard& shard = shardFor(key.data());
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.sessions.erase(key) == 0) {
+        return false;
+    }
+    if (options.persist) {
+        shard.removed.push_back(key);
+    }
+    return true;
+}
+
+size_t SessionStore::revokeUser(uint32_t userId) {
+    size_t revoked = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        for (auto it = shard->sessions.begin(); it != shard->sessions.end();) {
+            if (it->second.userId != userId) {
+                ++it;
+                continue;
+            }
+            if (options.persist) {
+                shard->removed.push_back(it->first);
+            }
+            it = shard->sessions.erase(it);
+            ++revoked;
+        }
+    }
+    return revoked;
+}
+
+size_t SessionStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->sessions.size();
+    }
+    return total;
+}
+
+size_t SessionStore::expire() {
+    const std::time_t at = now();
+    size_t expired = 0;
+    for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        auto& sessions = shard->sessions;
+        shard->wheel.advance(at,
+            [&sessions](const SessionKey& key) -> std::time_t {
+                auto it = sessions.find(key);
+                return it == sessions.end() ? 0 : it->second.expiresAt;
+            },
+            [&sessions, &expired](const SessionKey& key) {
+                // The database copy goes with deleteSessions' expiry sweep
+                sessions.erase(key);
+                ++expired;
+            });
+    }
+    return expired;
+}
+
+void SessionStore::flush() {
+    if (!options.persist) {
+        return;
+    }
+
+    // One flush at a time, from the swap to the last write: otherwise a
+    // snapshot taken before a revoke could be saved after that revoke's
+    // delete, bringing the session back (or an older expiresAt)
+    std::lock_guard<std::mutex> serialized(flushMutex);
+
+    std::vector<std::vector<SessionKey>> dirty(shards.size());
+    std::vector<std::vector<SessionKey>> removed(shards.size());
+    std::vector<Session> saves;
+    std::vector<std::string> removes;
+    for (size_t i = 0; i < shards.size(); ++i) {
+        detail::SessionShard& shard = *shards[i];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        dirty[i].swap(shard.dirty);
+        removed[i].swap(shard.removed);
+        for (const SessionKey& key : dirty[i]) {
+            auto it = shard.sessions.find(key);
+            if (it == shard.sessions.end()) {
+                continue;
+            }
+            it->second.queued = false;
+            Session session;
+            session.id.assign(reinterpret_cast<const char*>(key.data()), key.size());
+            session.userId = it->second.userId;
+            session.createdAt = it->second.createdAt;
+            session.expiresAt = it->second.expiresAt;
+            session.metadata = it->second.metadata;
+            saves.push_back(std::move(session));
+        }
+        for (const SessionKey& key : removed[i]) {
+            removes.emplace_back(reinterpret_cast<const char*>(key.data()), key.size());
+        }
+    }
+
+    try {
+        database->saveSessions(saves);
+        database->deleteSessions(removes, now());
+    } catch (...) {
+        // Put everything back for the next flush
+        for (size_t i = 0; i < shards.size(); ++i) {
+            detail::SessionShard& shard = *shards[i];
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            for (const SessionKey& key : dirty[i]) {
+                auto it = shard.sessions.find(key);
+                if (it != shard.sessions.end()) {
+                    shard.markDirty(key, it->second);
+                }
+            }
+            shard.removed.insert(shard.removed.end(), removed[i].begin(), removed[i].end());
+        }
+        throw;
+    }
+}
+
+size_t SessionStore::restore() {
+    if (!database) {
+        throw ConfigError("SessionStore::restore needs a Database");
+    }
+
+    size_t restored = 0;
+    for (const Session& session : database->loadSessions(now())) {
+        if (session.id.size() != ID_BYTES) {
+            continue;
+        }
+        SessionKey key;
+        std::memcpy(key.data(), session.id.data(), ID_BYTES);
+        detail::SessionShard& shard = shardFor(key.data());
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.sessions.try_emplace(
+            key, SessionRecord{session.userId, false, session.createdAt, session.expiresAt, session.metadata});
+        if (inserted) {
+            shard.wheel.schedule(key, session.expiresAt);
+            ++restored;
+        }
+    }
+    return restored;
+}
+
+void SessionStore::sweepLoop() {
+    std::unique_lock<std::mutex> lock(sweepMutex);
+    while (!sweepWake.wait_for(lock, std::chrono::milliseconds(options.sweepIntervalMs), [this]() { return stopping; })) {
+        lock.unlock();
+        expire();
+        try {
+            flush();
+        } catch (const std::exception&) {
+            // Requeued; the next sweep retries
+        }
+        lock.lock();
+    }
+}
+
+} // namespace authlib
@@ -0,0 +1,237 @@
+#include <authlib/sidecar/VerifySidecar.h>
+#include <authlib/utils/exceptions.h>
+#include <boost/asio/bind_executor.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/write.hpp>
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// The frame loop works on raw bytes: complete frames are cut out of the
+// read buffer with completeFrameSize, answered, and their responses
+// appended to an output buffer. One write is in flight at a time; reads
+// continue alongside it until MAX_QUEUED_OUTPUT bytes of responses are
+// waiting behind it, so a client that pipelines more than a socket buffer
+// isn't left blocked on its own send. A connection's handlers run on its
+// strand.
+
+namespace authlib {
+
+namespace asio = boost::asio;
+using stream_protocol = asio::local::stream_protocol;
+
+namespace detail {
+
+class VerifySidecarLoop {
+public:
+    explicit VerifySidecarLoop(uint32_t threads) : context(static_cast<int>(threads)), acceptor(context) {}
+
+    asio::io_context context;
+    asio::executor_work_guard<asio::io_context::executor_type> work = asio::make_work_guard(context);
+    stream_protocol::acceptor acceptor;
+    std::vector<std::thread> threads;
+};
+
+} // namespace detail
+
+namespace {
+
+// Responses held back while a write is in flight before reads pause
+constexpr size_t MAX_QUEUED_OUTPUT = 4 * sidecar::MAX_FRAME_BYTES;
+
+class Connection : public std::enable_shared_from_this<Connection> {
+public:
+    Connection(stream_protocol::socket socket, VerifySidecar& owner)
+        : socket(std::move(socket)), strand(asio::make_strand(this->socket.get_executor())), owner(owner) {}
+
+    void read() {
+        reading = true;
+        socket.async_read_some(
+            asio::buffer(buffer),
+            asio::bind_executor(strand, [self = shared_from_this()](boost::system::error_code ec, size_t n) {
+                self->onRead(ec, n);
+            })
+        );
+    }
+
+private:
+    stream_protocol::socket socket;
+    asio::strand<stream_protocol::socket::executor_type> strand;
+    VerifySidecar& owner;
+    std::array<char, 16384> buffer;
+    std::string input;
+    std::string queued;  // answered, waiting for the current write
+    std::string writing; // owned by the write in flight
+    bool reading = false;
+    bool closed = false;
+
+    void onRead(boost::system::error_code ec, size_t bytes) {
+        reading = false;
+        if (ec) {
+            closed = true;
+            return;
+        }
+        input.append(buffer.data(), bytes);
+
+        try {
+            size_t consumed = 0;
+            size_t frameSize;
+            while ((frameSize = sidecar::completeFrameSize(input.data() + consumed, input.size() - consumed)) != 0) {
+                sidecar::VerifyFrame request = sidecar::decodeRequest(input.data() + consumed, frameSize);
+                sidecar::encodeResponse(queued, request.id, owner.verify(request.tokens));
+                consumed += frameSize;
+            }
+            input.erase(0, consumed);
+        } catch (const std::exception&) {
+            // Malformed frame: the stream can't be resynchronised
+            closed = true;
+            boost::system::error_code ignored;
+            socket.close(ignored);
+            return;
+        }
+
+        if (writing.empty()) {
+            write();
+        }
+        if (queued.size() < MAX_QUEUED_OUTPUT) {
+            read();
+        }
+    }
+
+    void write() {
+        if (queued.empty()) {
+            return;
+        }
+        writing.swap(queued);
+        asio::async_write(
+            socket,
+            asio::buffer(writing),
+            asio::bind_executor(strand, [self = shared_from_this()](boost::system::error_code ec, size_t) {
+                self->onWrite(ec);
+            })
+        );
+    }
+
+    void onWrite(boost::system::error_code ec) {
+        writing.clear();
+        if (ec) {
+            closed = true;
+            return;
+        }
+        write();
+        if (!reading && !closed && queued.size() < MAX_QUEUED_OUTPUT) {
+            read();
+        }
+    }
+};
+
+void acceptNext(stream_protocol::acceptor& acceptor, VerifySidecar& owner) {
+    acceptor.async_accept([&acceptor, &owner](boost::system::error_code ec, stream_protocol::socket socket) {
+        if (ec == asio::error::operation_aborted) {
+            return;
+        }
+        if (!ec) {
+            std::make_shared<Connection>(std::move(socket), owner)->read();
+        }
+        acceptNext(acceptor, owner);
+    });
+}
+
+// Unlinks a socket left at path by an earlier run. Anything else there
+// is left alone and reported with false.
+bool removeStaleSocket(const std::string& path) {
+    struct stat info;
+    if (::lstat(path.c_str(), &info) != 0) {
+        return true;
+    }
+    if (!S_ISSOCK(info.st_mode)) {
+        return false;
+    }
+    ::unlink(path.c_str());
+    return true;
+}
+
+} // namespace
+
+VerifySidecarOptions VerifySidecarOptions::fromConfig(const Config& config) {
+    VerifySidecarOptions options;
+    options.socketPath = config.VERIFY_SOCKET_PATH;
+    options.threads = config.VERIFY_THREADS;
+    return options;
+}
+
+VerifySidecar::VerifySidecar(
+    Database& database,
+    std::shared_ptr<ConfigStore> configStore,
+    const VerifySidecarOptions& options
+) : database(database), jwtHandler(std::move(configStore)), options(options) {}
+
+VerifySidecar::~VerifySidecar() {
+    stop();
+}
+
+void VerifySidecar::start() {
+    if (loop) {
+        return;
+    }
+
+    if (!removeStaleSocket(options.socketPath)) {
+        throw ConfigError("VERIFY_SOCKET_PATH " + options.socketPath + " exists and is not a socket");
+    }
+    auto next = std::make_unique<detail::VerifySidecarLoop>(std::max(1u, options.threads));
+    stream_protocol::endpoint endpoint(options.socketPath);
+    next->acceptor.open(endpoint.protocol());
+    next->acceptor.bind(endpoint);
+    next->acceptor.listen(asio::socket_base::max_listen_connections);
+    acceptNext(next->acceptor, *this);
+
+    for (uint32_t i = 0; i < std::max(1u, options.threads); ++i) {
+        next->threads.emplace_back([context = &next->context]() { context->run(); });
+    }
+    loop = std::move(next);
+}
+
+void VerifySidecar::stop() {
+    if (!loop) {
+        return;
+    }
+    loop->context.stop();
+    for (auto& thread : loop->threads) {
+        thread.join();
+    }
+    loop.reset();
+    removeStaleSocket(options.socketPath);
+}
+
+std::vector<sidecar::VerifyResult> VerifySidecar::verify(const std::vector<std::string>& tokens) {
+    std::vector<sidecar::VerifyResult> results(tokens.size());
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        sidecar::VerifyResult& result = results[i];
+        Result<TokenPayload> verified = jwtHandler.tryVerifyToken(tokens[i]);
+        if (!verified) {
+            result.status = sidecar::VerifyStatus::Invalid;
+            continue;
+        }
+        const TokenPayload& payload = verified.value();
+        result.refresh = payload.type == "refresh";
+        result.userId = payload.userId;
+        result.expiresAt = payload.exp;
+        result.email = payload.email;
+
+        try {
+            result.status = database.isTokenBlacklisted(tokens[i])
+                ? sidecar::VerifyStatus::Revoked
+                : sidecar::VerifyStatus::Valid;
+        } catch (const std::exception&) {
+            result.status = sidecar::VerifyStatus::Unavailable;
+        }
+    }
+    return results;
+}
+
+} // namespace authlib
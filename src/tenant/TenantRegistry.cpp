@@ -0,0 +1,256 @@
+#include <authlib/tenant/TenantRegistry.h>
+#include <authlib/utils/PasswordHandler.h>
+#include <authlib/utils/exceptions.h>
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <algorithm>
+
+// The registry lock only covers the LRU bookkeeping. The first request for
+// a tenant leaves a shared_future in the LRU and builds the Tenant outside
+// the lock; later requests for it wait on that future rather than on the
+// registry, so a slow open never stalls the other tenants.
+
+namespace authlib {
+
+namespace {
+
+bool isValidTenantId(const std::string& tenantId) {
+    if (tenantId.empty() || tenantId.size() > 64) {
+        return false;
+    }
+    return std::all_of(tenantId.begin(), tenantId.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+    });
+}
+
+std::string deriveTenantKey(const std::string& masterKey, const std::string& tenantId) {
+    static const char HEX[] = "0123456789abcdef";
+
+    const std::string message = "authlib-tenant:" + tenantId;
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    HMAC(EVP_sha256(), masterKey.data(), static_cast<int>(masterKey.size()),
+        reinterpret_cast<const unsigned char*>(message.data()), message.size(), digest, &length);
+
+    std::string key;
+    key.reserve(length * 2);
+    for (unsigned int i = 0; i < length; ++i) {
+        key.push_back(HEX[digest[i] >> 4]);
+        key.push_back(HEX[digest[i] & 0xf]);
+    }
+    return key;
+}
+
+void replaceAll(std::string& text, const std::string& from, const std::string& to) {
+    for (size_t at = text.find(from); at != std::string::npos; at = text.find(from, at + to.size())) {
+        text.replace(at, from.size(), to);
+    }
+}
+
+} // namespace
+
+Tenant::Tenant(const std::string& tenantId, std::shared_ptr<const Config> config)
+    : tenantId(tenantId),
+      store(std::make_shared<ConfigStore>(config)),
+      jwtHandler(store, tenantId),
+      db(config->DATABASE_URL, 5000, config->DATABASE_SHARDS) {
+    db.setProfiling(DatabaseProfileOptions::fromConfig(*config));
+}
+
+const std::string& Tenant::id() const {
+    return tenantId;
+}
+
+void Tenant::open() {
+    // A throw leaves the flag unset, so the next call retries
+    std::call_once(opened, [this]() {
+        db.initialize();
+        authService = std::make_unique<AuthService>(db, store, tenantId);
+    });
+}
+
+Database& Tenant::database() {
+    open();
+    return db;
+}
+
+AuthService& Tenant::auth() {
+    open();
+    return *authService;
+}
+
+TokenPayload Tenant::verifyToken(const std::string& token) {
+    return jwtHandler.verifyToken(token);
+}
+
+std::shared_ptr<ConfigStore> Tenant::configStore() {
+    return store;
+}
+
+TenantRegistryOptions TenantRegistryOptions::fromConfig(const Config& config) {
+    TenantRegistryOptions options;
+    options.maxOpenTenants = config.TENANT_MAX_OPEN;
+    options.idleSeconds = config.TENANT_IDLE_SECONDS;
+    return options;
+}
+
+TenantRegistry::TenantRegistry(TenantResolver resolver, const TenantRegistryOptions& options)
+    : resolver(std::move(resolver)), options(options), opens(0) {
+    if (this->options.maxOpenTenants == 0) {
+        throw ConfigError("TenantRegistry needs room for at least one open tenant");
+    }
+}
+
+std::shared_ptr<Tenant> TenantRegistry::get(const std::string& tenantId) {
+    return acquire(tenantId, nullptr);
+}
+
+std::shared_ptr<Tenant> TenantRegistry::acquire(const std::string& tenantId, std::shared_ptr<Tenant> built) {
+    std::promise<std::shared_ptr<Tenant>> opening;
+    std::shared_future<std::shared_ptr<Tenant>> tenant;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const Clock::time_point now = Clock::now();
+        evictIdle(now);
+
+        auto it = index.find(tenantId);
+        if (it != index.end()) {
+            lru.splice(lru.begin(), lru, it->second);
+            it->second->lastUsed = now;
+            tenant = it->second->tenant;
+        } else {
+            generation = ++opens;
+            tenant = opening.get_future().share();
+            lru.push_front({tenantId, tenant, now, generation});
+            index[tenantId] = lru.begin();
+        }
+    }
+
+    if (generation != 0) {
+        try {
+            opening.set_value(built ? std::move(built) : build(tenantId));
+
+            // Only a successful open makes room, so an id the resolver
+            // rejects can't push good tenants out
+            std::lock_guard<std::mutex> lock(mutex);
+            while (lru.size() > options.maxOpenTenants) {
+                index.erase(lru.back().tenantId);
+                lru.pop_back();
+            }
+        } catch (...) {
+            opening.set_exception(std::current_exception());
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = index.find(tenantId);
+            if (it != index.end() && it->second->generation == generation) {
+                lru.erase(it->second);
+                index.erase(it);
+            }
+        }
+    }
+    return tenant.get();
+}
+
+std::shared_ptr<Tenant> TenantRegistry::build(const std::string& tenantId) {
+    std::shared_ptr<const Config> config = resolver(tenantId);
+    if (!config) {
+        throw TenantNotFound("Unknown tenant " + tenantId);
+    }
+    return std::make_shared<Tenant>(tenantId, std::move(config));
+}
+
+std::shared_future<std::shared_ptr<Tenant>> TenantRegistry::findOpen(const std::string& tenantId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const Clock::time_point now = Clock::now();
+    evictIdle(now);
+
+    auto it = index.find(tenantId);
+    if (it == index.end()) {
+        return {};
+    }
+    lru.splice(lru.begin(), lru, it->second);
+    it->second->lastUsed = now;
+    return it->second->tenant;
+}
+
+TokenPayload TenantRegistry::verifyToken(const std::string& token) {
+    const std::string tenantId = JWTHandler::tenantOf(token);
+    if (tenantId.empty()) {
+        throw InvalidToken("Token has no tenant");
+    }
+
+    try {
+        std::shared_future<std::shared_ptr<Tenant>> open = findOpen(tenantId);
+        if (open.valid()) {
+            return open.get()->verifyToken(token);
+        }
+
+        // The tid is still unverified here. Check the signature on a Tenant
+        // built outside the LRU and add it only for a genuine token, so
+        // forged tenant ids never take (or evict) a slot. Building opens
+        // no database, and the Tenant that verified is the one kept, so a
+        // tenant's keys are set up once, not once here and again on open.
+        std::shared_ptr<Tenant> candidate = build(tenantId);
+        TokenPayload payload = candidate->verifyToken(token);
+        acquire(tenantId, std::move(candidate));
+        return payload;
+    } catch (const TenantNotFound&) {
+        throw InvalidToken("Token names an unknown tenant");
+    }
+}
+
+void TenantRegistry::evict(const std::string& tenantId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(tenantId);
+    if (it != index.end()) {
+        lru.erase(it->second);
+        index.erase(it);
+    }
+}
+
+size_t TenantRegistry::openCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
+
+void TenantRegistry::evictIdle(Clock::time_point now) {
+    if (options.idleSeconds == 0) {
+        return;
+    }
+    const Clock::time_point cutoff = now - std::chrono::seconds(options.idleSeconds);
+    while (!lru.empty() && lru.back().lastUsed < cutoff) {
+        index.erase(lru.back().tenantId);
+        lru.pop_back();
+    }
+}
+
+TenantResolver TenantRegistry::templateResolver(std::shared_ptr<const Config> base) {
+    if (base->DATABASE_URL.find("{tenant}") == std::string::npos) {
+        throw ConfigError("DATABASE_URL needs a {tenant} placeholder so tenants get separate databases");
+    }
+
+    auto prepared = std::make_shared<Config>(*base);
+    if (PasswordHandler::algorithmFromName(prepared->PASSWORD_HASH_ALGORITHM) == PasswordAlgorithm::Pbkdf2Sha256
+        && prepared->PASSWORD_HASH_TARGET_MS > 0) {
+        prepared->PASSWORD_HASH_ITERATIONS = PasswordHandler::calibrateIterations(
+            std::chrono::milliseconds(prepared->PASSWORD_HASH_TARGET_MS),
+            prepared->PASSWORD_HASH_ITERATIONS
+        );
+        prepared->PASSWORD_HASH_TARGET_MS = 0;
+    }
+
+    return [prepared = std::shared_ptr<const Config>(std::move(prepared))](const std::string& tenantId) {
+        if (!isValidTenantId(tenantId)) {
+            throw TenantNotFound("Invalid tenant id");
+        }
+        auto config = std::make_shared<Config>(*prepared);
+        replaceAll(config->DATABASE_URL, "{tenant}", tenantId);
+        config->JWT_SECRET_KEY = deriveTenantKey(prepared->JWT_SECRET_KEY, tenantId);
+        if (!prepared->JWT_PREVIOUS_SECRET_KEY.empty()) {
+            config->JWT_PREVIOUS_SECRET_KEY = deriveTenantKey(prepared->JWT_PREVIOUS_SECRET_KEY, tenantId);
+        }
+        return std::shared_ptr<const Config>(std::move(config));
+    };
+}
+
+} // namespace authlib
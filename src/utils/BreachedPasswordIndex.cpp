@@ -0,0 +1,444 @@
+#include <authlib/utils/BreachedPasswordIndex.h>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/sha.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// File layout (integers little-endian; the header is written as a struct,
+// so the format is only produced and read on little-endian hosts):
+//
+//   header   64 bytes, see FileHeader
+//   fanout   (65536 + 1) x u64: index of the first entry whose key has
+//            each 16-bit prefix, plus the total count
+//   entries  entryCount x u64, sorted: first 8 bytes of SHA-1 read as a
+//            big-endian number
+//   bloom    bloomBlocks x 64 bytes (optional)
+//
+// A lookup reads one fanout pair, then interpolation-searches the bucket.
+// SHA-1 output is uniform, so the first probe usually lands within a few
+// entries of the target and a hit or miss costs two or three cache lines.
+
+namespace authlib {
+
+namespace {
+
+constexpr char MAGIC[8] = {'A', 'U', 'T', 'H', 'B', 'P', 'I', '1'};
+constexpr uint32_t FORMAT_VERSION = 1;
+constexpr size_t FANOUT_BUCKETS = 1 << 16;
+constexpr size_t BLOOM_BLOCK_BYTES = 64;
+constexpr uint32_t MAX_BLOOM_HASHES = 7; // 9 bits each from one 64-bit mix
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t bloomHashes;
+    uint64_t entryCount;
+    uint64_t fanoutOffset;
+    uint64_t entriesOffset;
+    uint64_t bloomOffset; // 0 when there is no filter
+    uint64_t bloomBlocks;
+    uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 64, "index header must stay 64 bytes");
+
+inline uint64_t loadLittleEndian64(const unsigned char* p) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | p[i];
+    }
+    return value;
+}
+
+inline void storeLittleEndian64(unsigned char* p, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        p[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+}
+
+inline uint64_t keyFromDigest(const unsigned char* digest) {
+    uint64_t key = 0;
+    for (int i = 0; i < 8; ++i) {
+        key = (key << 8) | digest[i];
+    }
+    return key;
+}
+
+inline uint64_t mix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Blocked Bloom filter: every probe for a key lands in the same 512-bit block
+inline void bloomPositions(uint64_t key, uint64_t blocks, uint32_t hashes, uint64_t& block, uint32_t bits[]) {
+    block = key % blocks;
+    uint64_t h = mix(key);
+    for (uint32_t i = 0; i < hashes; ++i) {
+        bits[i] = static_cast<uint32_t>((h >> (9 * i)) & 511);
+    }
+}
+
+// The one-shot SHA1() looks the algorithm up on every call under OpenSSL 3,
+// which costs several times the hash itself; fetch it once and keep a
+// digest context per thread.
+const EVP_MD* sha1Algorithm() {
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    static const EVP_MD* md = EVP_MD_fetch(nullptr, "SHA1", nullptr);
+#else
+    static const EVP_MD* md = EVP_sha1();
+#endif
+    return md;
+}
+
+void sha1(const std::string& data, unsigned char digest[SHA_DIGEST_LENGTH]) {
+    thread_local std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> ctx(EVP_MD_CTX_new(), &EVP_MD_CTX_free);
+    unsigned int length = 0;
+    if (!ctx
+        || !EVP_DigestInit_ex(ctx.get(), sha1Algorithm(), nullptr)
+        || !EVP_DigestUpdate(ctx.get(), data.data(), data.size())
+        || !EVP_DigestFinal_ex(ctx.get(), digest, &length)) {
+        throw std::runtime_error("SHA-1 digest failed");
+    }
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseDumpLine(const std::string& line, uint64_t& key) {
+    if (line.size() < 40) {
+        return false;
+    }
+    key = 0;
+    for (size_t i = 0; i < 40; ++i) {
+        int v = hexValue(line[i]);
+        if (v < 0) {
+            return false;
+        }
+        if (i < 16) {
+            key = (key << 4) | static_cast<uint64_t>(v);
+        }
+    }
+    return line.size() == 40 || line[40] == ':';
+}
+
+} // namespace
+
+BreachedPasswordIndex::BreachedPasswordIndex(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(
+        path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Cannot open breached password index: " + path);
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Cannot stat breached password index: " + path);
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    HANDLE mapping = length ? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Cannot map breached password index: " + path);
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    base = static_cast<const unsigned char*>(view);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open breached password index: " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot stat breached password index: " + path);
+    }
+    length = static_cast<size_t>(st.st_size);
+    void* view = length ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Cannot map breached password index: " + path);
+    }
+    // Lookups are random; readahead would only pull in pages we never touch
+    madvise(view, length, MADV_RANDOM);
+    base = static_cast<const unsigned char*>(view);
+#endif
+
+    FileHeader header;
+    bool valid = length >= sizeof(header);
+    if (valid) {
+        std::memcpy(&header, base, sizeof(header));
+        valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0
+            && header.version == FORMAT_VERSION
+            && header.fanoutOffset <= length
+            && (length - header.fanoutOffset) / 8 >= FANOUT_BUCKETS + 1
+            && header.entriesOffset <= length
+            && (length - header.entriesOffset) / 8 >= header.entryCount
+            && header.bloomHashes <= MAX_BLOOM_HASHES
+            && (header.bloomOffset == 0
+                || (header.bloomOffset <= length
+                    && header.bloomBlocks > 0
+                    && header.bloomHashes > 0
+                    && (length - header.bloomOffset) / BLOOM_BLOCK_BYTES >= header.bloomBlocks));
+    }
+    if (valid) {
+        fanout = base + header.fanoutOffset;
+        valid = loadLittleEndian64(fanout + FANOUT_BUCKETS * 8) == header.entryCount;
+    }
+    if (!valid) {
+        unmap();
+        throw std::runtime_error("Not a valid breached password index: " + path);
+    }
+
+    entries = base + header.entriesOffset;
+    entryCount = header.entryCount;
+    if (header.bloomOffset != 0) {
+        bloom = base + header.bloomOffset;
+        bloomBlocks = header.bloomBlocks;
+        bloomHashes = header.bloomHashes;
+    }
+}
+
+BreachedPasswordIndex::~BreachedPasswordIndex() {
+    unmap();
+}
+
+void BreachedPasswordIndex::unmap() {
+    if (!base) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+#else
+    munmap(const_cast<unsigned char*>(base), length);
+#endif
+    base = nullptr;
+}
+
+bool BreachedPasswordIndex::contains(const std::string& password) const {
+    unsigned char digest[SHA_DIGEST_LENGTH];
+    sha1(password, digest);
+    bool found = containsSha1(digest);
+    OPENSSL_cleanse(digest, sizeof(digest));
+    return found;
+}
+
+bool BreachedPasswordIndex::containsSha1(const unsigned char digest[20]) const {
+    return containsKey(keyFromDigest(digest));
+}
+
+bool BreachedPasswordIndex::containsKey(uint64_t key) const {
+    if (bloom) {
+        uint64_t block;
+        uint32_t bits[MAX_BLOOM_HASHES];
+        bloomPositions(key, bloomBlocks, bloomHashes, block, bits);
+        const unsigned char* line = bloom + block * BLOOM_BLOCK_BYTES;
+        for (uint32_t i = 0; i < bloomHashes; ++i) {
+            if (!(line[bits[i] >> 3] & (1u << (bits[i] & 7)))) {
+                return false;
+            }
+        }
+    }
+
+    size_t bucket = static_cast<size_t>(key >> 48);
+    uint64_t lo = loadLittleEndian64(fanout + bucket * 8);
+    uint64_t hi = loadLittleEndian64(fanout + (bucket + 1) * 8); // exclusive
+    if (lo >= hi || hi > entryCount) {
+        return false;
+    }
+
+    // Interpolation search; a bounded number of probes, then binary search
+    // so adversarially skewed buckets cannot degrade to a linear walk
+    for (int probes = 0; hi - lo > 16; ++probes) {
+        uint64_t first = loadLittleEndian64(entries + lo * 8);
+        uint64_t last = loadLittleEndian64(entries + (hi - 1) * 8);
+        if (key < first || key > last) {
+            return false;
+        }
+        uint64_t mid;
+        if (probes < 6 && last > first) {
+            double fraction = static_cast<double>(key - first) / static_cast<double>(last - first);
+            mid = lo + static_cast<uint64_t>(fraction * static_cast<double>(hi - 1 - lo));
+            mid = std::min(std::max(mid, lo), hi - 1);
+        } else {
+            mid = lo + (hi - lo) / 2;
+        }
+        uint64_t probe = loadLittleEndian64(entries + mid * 8);
+        if (probe == key) {
+            return true;
+        }
+        if (probe < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    for (uint64_t i = lo; i < hi; ++i) {
+        uint64_t probe = loadLittleEndian64(entries + i * 8);
+        if (probe >= key) {
+            return probe == key;
+        }
+    }
+    return false;
+}
+
+size_t BreachedPasswordIndex::size() const {
+    return static_cast<size_t>(entryCount);
+}
+
+bool BreachedPasswordIndex::hasBloomFilter() const {
+    return bloom != nullptr;
+}
+
+BreachedIndexBuildStats BreachedPasswordIndex::build(
+    const std::string& textDumpPath,
+    const std::string& outputPath,
+    uint32_t bloomBitsPerEntry
+) {
+    std::ifstream input(textDumpPath);
+    if (!input) {
+        throw std::runtime_error("Cannot open password dump: " + textDumpPath);
+    }
+    std::fstream output(outputPath, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!output) {
+        throw std::runtime_error("Cannot create breached password index: " + outputPath);
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.fanoutOffset = sizeof(FileHeader);
+    header.entriesOffset = header.fanoutOffset + (FANOUT_BUCKETS + 1) * 8;
+
+    // Entries stream straight to disk; the header and fanout are written
+    // last, once the counts are known
+    std::vector<uint64_t> fanoutCounts(FANOUT_BUCKETS + 1, 0);
+    output.seekp(static_cast<std::streamoff>(header.entriesOffset));
+
+    BreachedIndexBuildStats stats;
+    std::vector<unsigned char> chunk;
+    chunk.reserve(1 << 20);
+    std::string line;
+    uint64_t previous = 0;
+    bool first = true;
+    while (std::getline(input, line)) {
+        ++stats.linesRead;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        uint64_t key;
+        if (!parseDumpLine(line, key)) {
+            throw std::runtime_error(
+                "Malformed line " + std::to_string(stats.linesRead) + " in " + textDumpPath
+            );
+        }
+        if (!first && key < previous) {
+            throw std::runtime_error(
+                "Password dump must be ordered by hash (line " + std::to_string(stats.linesRead) + ")"
+            );
+        }
+        if (!first && key == previous) {
+            continue; // distinct SHA-1s sharing a 64-bit prefix
+        }
+        first = false;
+        previous = key;
+
+        ++fanoutCounts[static_cast<size_t>(key >> 48) + 1];
+        unsigned char bytes[8];
+        storeLittleEndian64(bytes, key);
+        chunk.insert(chunk.end(), bytes, bytes + 8);
+        if (chunk.size() >= (1 << 20)) {
+            output.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+            chunk.clear();
+        }
+        ++stats.entries;
+    }
+    output.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunk.size()));
+    chunk.clear();
+    header.entryCount = stats.entries;
+
+    if (bloomBitsPerEntry > 0 && stats.entries > 0) {
+        uint64_t totalBits = stats.entries * bloomBitsPerEntry;
+        header.bloomBlocks = (totalBits + BLOOM_BLOCK_BYTES * 8 - 1) / (BLOOM_BLOCK_BYTES * 8);
+        header.bloomHashes = static_cast<uint32_t>(std::lround(bloomBitsPerEntry * std::log(2.0)));
+        header.bloomHashes = std::max<uint32_t>(1, std::min(header.bloomHashes, MAX_BLOOM_HASHES));
+        header.bloomOffset = header.entriesOffset + stats.entries * 8;
+
+        std::vector<unsigned char> filter(header.bloomBlocks * BLOOM_BLOCK_BYTES, 0);
+        output.seekg(static_cast<std::streamoff>(header.entriesOffset));
+        std::vector<unsigned char> buffer(1 << 20);
+        uint64_t remaining = stats.entries;
+        while (remaining > 0) {
+            size_t batch = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size() / 8));
+            output.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(batch * 8));
+            for (size_t i = 0; i < batch; ++i) {
+                uint64_t block;
+                uint32_t bits[MAX_BLOOM_HASHES];
+                bloomPositions(loadLittleEndian64(&buffer[i * 8]), header.bloomBlocks, header.bloomHashes, block, bits);
+                unsigned char* target = &filter[block * BLOOM_BLOCK_BYTES];
+                for (uint32_t h = 0; h < header.bloomHashes; ++h) {
+                    target[bits[h] >> 3] |= static_cast<unsigned char>(1u << (bits[h] & 7));
+                }
+            }
+            remaining -= batch;
+        }
+        output.seekp(static_cast<std::streamoff>(header.bloomOffset));
+        output.write(reinterpret_cast<const char*>(filter.data()), static_cast<std::streamsize>(filter.size()));
+        stats.bloomBytes = filter.size();
+    }
+
+    std::vector<unsigned char> fanout((FANOUT_BUCKETS + 1) * 8);
+    uint64_t running = 0;
+    for (size_t bucket = 0; bucket <= FANOUT_BUCKETS; ++bucket) {
+        running += fanoutCounts[bucket];
+        storeLittleEndian64(&fanout[bucket * 8], running);
+    }
+
+    unsigned char headerBytes[sizeof(FileHeader)];
+    std::memcpy(headerBytes, &header, sizeof(header));
+    output.seekp(0);
+    output.write(reinterpret_cast<const char*>(headerBytes), sizeof(headerBytes));
+    output.write(reinterpret_cast<const char*>(fanout.data()), static_cast<std::streamsize>(fanout.size()));
+    output.flush();
+    if (!output) {
+        throw std::runtime_error("Failed writing breached password index: " + outputPath);
+    }
+    return stats;
+}
+
+} // namespace authlib
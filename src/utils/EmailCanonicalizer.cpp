@@ -0,0 +1,120 @@
+#include <authlib/utils/EmailCanonicalizer.h>
+#include <cstring>
+
+// Canonicalization runs once when a user is written and once per lookup, so
+// the stored email_canonical column can be matched with plain equality and
+// the UNIQUE index. Provider rules only cover mailboxes whose aliasing is
+// documented; anything else keeps its local part verbatim (apart from case).
+
+namespace authlib {
+
+namespace {
+
+struct ProviderRule {
+    const char* domain;
+    const char* canonicalDomain;
+    bool ignoreDots;
+    char tagSeparator;
+};
+
+constexpr ProviderRule PROVIDER_RULES[] = {
+    {"gmail.com", "gmail.com", true, '+'},
+    {"googlemail.com", "gmail.com", true, '+'},
+    {"outlook.com", "outlook.com", false, '+'},
+    {"hotmail.com", "hotmail.com", false, '+'},
+    {"live.com", "live.com", false, '+'},
+    {"icloud.com", "icloud.com", false, '+'},
+    {"fastmail.com", "fastmail.com", false, '+'},
+    {"protonmail.com", "protonmail.com", false, '+'},
+    {"proton.me", "proton.me", false, '+'}
+};
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+char toLower(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+const ProviderRule* findRule(const std::string& domain) {
+    for (const auto& rule : PROVIDER_RULES) {
+        if (domain == rule.domain) {
+            return &rule;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace
+
+EmailCanonicalizer::EmailCanonicalizer(const EmailCanonicalizerOptions& options) : options(options) {}
+
+EmailCanonicalizer EmailCanonicalizer::fromConfig(const Config& config) {
+    EmailCanonicalizerOptions options;
+    options.foldLocalPart = config.EMAIL_FOLD_LOCAL_PART;
+    options.providerRules = config.EMAIL_PROVIDER_RULES;
+    return EmailCanonicalizer(options);
+}
+
+std::string EmailCanonicalizer::canonicalize(const std::string& email) const {
+    size_t at = email.rfind('@');
+    if (at == std::string::npos) {
+        std::string folded(email);
+        for (auto& c : folded) {
+            c = toLower(c);
+        }
+        return folded;
+    }
+
+    std::string domain = email.substr(at + 1);
+    for (auto& c : domain) {
+        c = toLower(c);
+    }
+    if (!domain.empty() && domain.back() == '.') {
+        domain.pop_back();
+    }
+
+    const ProviderRule* rule = options.providerRules ? findRule(domain) : nullptr;
+    size_t localEnd = at;
+    if (rule) {
+        const void* tag = std::memchr(email.data(), rule->tagSeparator, at);
+        if (tag) {
+            localEnd = static_cast<size_t>(static_cast<const char*>(tag) - email.data());
+        }
+        domain = rule->canonicalDomain;
+    }
+
+    std::string canonical;
+    canonical.reserve(localEnd + 1 + domain.size());
+    for (size_t i = 0; i < localEnd; ++i) {
+        char c = email[i];
+        if (rule && rule->ignoreDots && c == '.') {
+            continue;
+        }
+        canonical.push_back(options.foldLocalPart ? toLower(c) : c);
+    }
+    canonical.push_back('@');
+    canonical += domain;
+    return canonical;
+}
+
+uint64_t EmailCanonicalizer::hash(const std::string& canonical) noexcept {
+    uint64_t h = FNV_OFFSET;
+    for (unsigned char c : canonical) {
+        h = (h ^ c) * FNV_PRIME;
+    }
+    // FNV-1a alone leaves the high bits poorly mixed for short keys, and
+    // shard routing takes them modulo small counts
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+const EmailCanonicalizerOptions& EmailCanonicalizer::getOptions() const {
+    return options;
+}
+
+} // namespace authlib
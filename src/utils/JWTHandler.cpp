@@ -1,19 +1,116 @@
 #include <authlib/utils/JWTHandler.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/utils/SecureRandom.h>
 #include <authlib/utils/exceptions.h>
 #include <jwt-cpp/jwt.h>
 #include <ctime>
 
+// Each call takes one snapshot from the ConfigStore and uses it throughout,
+// so a concurrent reload can't pair one version's secret with another's
+// expiry. After a secret rotation a token that fails the current key's
+// signature check gets exactly one more HMAC, against the previous key,
+// until the grace window closes.
+//
+// Verification reports failures through error codes (jwt-cpp's
+// error_code overloads, non-throwing JSON parsing), so a flood of forged
+// or expired tokens costs no stack unwinding. jwt::decode has no such
+// overload; the shape check in front of it keeps ordinary junk away.
+
 namespace authlib {
 
-JWTHandler::JWTHandler(const Config& config) : config(config) {}
+namespace {
+
+template <typename Decoded>
+std::error_code verifySignature(const Decoded& decoded, const std::string& secret) {
+    std::error_code ec;
+    jwt::verify()
+        .allow_algorithm(jwt::algorithm::hs256{ secret })
+        .with_issuer("authlib")
+        .verify(decoded, ec);
+    return ec;
+}
+
+bool isBase64Url(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '-' || c == '_';
+}
+
+// Three non-empty base64url segments separated by dots
+bool looksLikeJwt(const std::string& token) {
+    int dots = 0;
+    size_t segment = 0;
+    for (char c : token) {
+        if (c == '.') {
+            if (segment == 0 || ++dots > 2) {
+                return false;
+            }
+            segment = 0;
+        } else if (isBase64Url(c)) {
+            ++segment;
+        } else {
+            return false;
+        }
+    }
+    return dots == 2 && segment > 0;
+}
+
+bool readPayload(const json& payload, TokenPayload& result) {
+    if (!payload.is_object()) {
+        return false;
+    }
+    auto userId = payload.find("userId");
+    auto email = payload.find("email");
+    auto type = payload.find("type");
+    if (userId == payload.end() || !userId->is_number_unsigned()
+        || email == payload.end() || !email->is_string()
+        || type == payload.end() || !type->is_string()) {
+        return false;
+    }
+    result.userId = userId->get<uint32_t>();
+    result.email = email->get<std::string>();
+    result.type = type->get<std::string>();
+
+    auto jti = payload.find("jti");
+    if (jti != payload.end()) {
+        if (!jti->is_string()) {
+            return false;
+        }
+        result.jti = jti->get<std::string>();
+    }
+    for (auto [name, field] : {std::make_pair("iat", &result.iat), std::make_pair("exp", &result.exp)}) {
+        auto claim = payload.find(name);
+        if (claim != payload.end()) {
+            if (!claim->is_number_unsigned()) {
+                return false;
+            }
+            *field = claim->get<uint32_t>();
+        }
+    }
+    auto tid = payload.find("tid");
+    if (tid != payload.end()) {
+        if (!tid->is_string()) {
+            return false;
+        }
+        result.tenantId = tid->get<std::string>();
+    }
+    return true;
+}
+
+} // namespace
+
+JWTHandler::JWTHandler(const Config& config)
+    : configStore(std::make_shared<ConfigStore>(std::make_shared<const Config>(config))) {}
+
+JWTHandler::JWTHandler(std::shared_ptr<ConfigStore> configStore, std::string tenantId)
+    : configStore(std::move(configStore)), tenantId(std::move(tenantId)) {}
 
 std::string JWTHandler::createAccessToken(
     uint32_t userId,
     const std::string& email,
     const json& additionalClaims
 ) {
+    const Config& config = configStore->view();
     uint32_t expirySeconds = config.JWT_ACCESS_TOKEN_EXPIRY_MINUTES * 60;
-    return createToken(userId, email, "access", expirySeconds, additionalClaims);
+    return createToken(config, userId, email, "access", expirySeconds, additionalClaims);
 }
 
 std::string JWTHandler::createRefreshToken(
@@ -21,17 +118,21 @@ std::string JWTHandler::createRefreshToken(
     const std::string& email,
     const json& additionalClaims
 ) {
+    const Config& config = configStore->view();
     uint32_t expirySeconds = config.JWT_REFRESH_TOKEN_EXPIRY_DAYS * 86400;
-    return createToken(userId, email, "refresh", expirySeconds, additionalClaims);
+    return createToken(config, userId, email, "refresh", expirySeconds, additionalClaims);
 }
 
 std::string JWTHandler::createToken(
+    const Config& config,
     uint32_t userId,
     const std::string& email,
     const std::string& type,
     uint32_t expirySeconds,
     const json& additionalClaims
 ) {
+    ScopedTimer timer(Metric::Sign);
+
     if (userId == 0) {
         throw ValidationError("userId must be a positive number");
     }
@@ -45,11 +146,15 @@ std::string JWTHandler::createToken(
     try {
         auto token = jwt::create()
             .set_issuer("authlib")
+            .set_id(SecureRandom::token(16))
             .set_issued_at(std::chrono::system_clock::now())
             .set_expires_at(std::chrono::system_clock::now() + std::chrono::seconds(expirySeconds))
-            .set_payload_claim("userId", jwt::claim(static_cast<int>(userId)))
+            .set_payload_claim("userId", jwt::claim(picojson::value(static_cast<int64_t>(userId))))
             .set_payload_claim("email", jwt::claim(email))
             .set_payload_claim("type", jwt::claim(type));
+        if (!tenantId.empty()) {
+            token.set_payload_claim("tid", jwt::claim(tenantId));
+        }
 
         // Add additional claims
         for (auto& [key, value] : additionalClaims.items()) {
@@ -63,20 +168,58 @@ std::string JWTHandler::createToken(
 }
 
 TokenPayload JWTHandler::verifyToken(const std::string& token) {
+    return tryVerifyToken(token).valueOrThrow();
+}
+
+Result<TokenPayload> JWTHandler::tryVerifyToken(const std::string& token) {
+    ScopedTimer timer(Metric::Verify);
+    auto fail = [&timer](const std::string& reason) {
+        timer.fail();
+        return AuthError{ErrorCode::InvalidToken, "Token verification failed: " + reason};
+    };
+    if (!looksLikeJwt(token)) {
+        return fail("malformed token");
+    }
+
+    const Config& config = configStore->view();
     try {
         auto decoded = jwt::decode(token);
-        decoded.verify(jwt::algorithm::hs256{ config.JWT_SECRET_KEY });
+        std::error_code ec = verifySignature(decoded, config.JWT_SECRET_KEY);
+        if (ec && ec.category() == jwt::error::signature_verification_error_category()
+            && !config.JWT_PREVIOUS_SECRET_KEY.empty()
+            && std::time(nullptr) < config.JWT_PREVIOUS_SECRET_EXPIRES_AT) {
+            ec = verifySignature(decoded, config.JWT_PREVIOUS_SECRET_KEY);
+        }
+        if (ec) {
+            return fail(ec.message());
+        }
 
-        return parsePayload(decoded.get_payload());
+        TokenPayload payload;
+        if (!readPayload(json::parse(decoded.get_payload(), nullptr, false), payload)) {
+            return fail("malformed claims");
+        }
+        if (payload.tenantId != tenantId) {
+            return fail("Token belongs to another tenant");
+        }
+        return payload;
     } catch (const std::exception& e) {
-        throw InvalidToken(std::string("Token verification failed: ") + e.what());
+        return fail(e.what());
     }
 }
 
 TokenPayload JWTHandler::decodeToken(const std::string& token) {
     try {
         auto decoded = jwt::decode(token);
-        return parsePayload(decoded.get_payload());
+        return parsePayload(json::parse(decoded.get_payload()));
+    } catch (...) {
+        throw InvalidToken("Failed to decode token");
+    }
+}
+
+std::string JWTHandler::tenantOf(const std::string& token) {
+    try {
+        auto decoded = jwt::decode(token);
+        return decoded.has_payload_claim("tid") ? decoded.get_payload_claim("tid").as_string() : "";
     } catch (...) {
         throw InvalidToken("Failed to decode token");
     }
@@ -84,17 +227,9 @@ TokenPayload JWTHandler::decodeToken(const std::string& token) {
 
 TokenPayload JWTHandler::parsePayload(const json& payload) {
     TokenPayload result;
-    result.userId = payload.at("userId").get<uint32_t>();
-    result.email = payload.at("email").get<std::string>();
-    result.type = payload.at("type").get<std::string>();
-
-    if (payload.contains("iat")) {
-        result.iat = payload.at("iat").get<uint32_t>();
+    if (!readPayload(payload, result)) {
+        throw InvalidToken("Malformed token claims");
     }
-    if (payload.contains("exp")) {
-        result.exp = payload.at("exp").get<uint32_t>();
-    }
-
     return result;
 }
 
@@ -0,0 +1,134 @@
+#include <authlib/utils/JsonWriter.h>
+#include <charconv>
+
+// One comma flag covers objects and arrays alike: it is set after every
+// complete value and cleared by an opening bracket or a key, so the next
+// key or array element knows whether it follows a sibling.
+
+namespace authlib {
+
+namespace {
+
+// Characters that can be copied as-is: printable ASCII other than " and \,
+// and every byte of a multi-byte UTF-8 sequence
+bool isPlain(unsigned char c) {
+    return c >= 0x20 && c != '"' && c != '\\';
+}
+
+template <typename Integer>
+void appendInteger(std::string& out, Integer value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+} // namespace
+
+void JsonWriter::separate() {
+    if (needsComma) {
+        out.push_back(',');
+    }
+}
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out.push_back('{');
+    needsComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    out.push_back('}');
+    needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out.push_back('[');
+    needsComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    out.push_back(']');
+    needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    out.push_back('"');
+    out.append(name);
+    out.append("\":", 2);
+    needsComma = false;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string(std::string_view value) {
+    separate();
+    appendEscaped(out, value);
+    needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(int64_t value) {
+    separate();
+    appendInteger(out, value);
+    needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::number(uint64_t value) {
+    separate();
+    appendInteger(out, value);
+    needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool value) {
+    separate();
+    out.append(value ? "true" : "false");
+    needsComma = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out.append("null", 4);
+    needsComma = true;
+    return *this;
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view value) {
+    static const char HEX[] = "0123456789abcdef";
+
+    out.push_back('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < value.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(value[i]);
+        if (isPlain(c)) {
+            continue;
+        }
+        // Copy the plain run before this character in one append
+        out.append(value.data() + runStart, i - runStart);
+        runStart = i + 1;
+        switch (c) {
+            case '"': out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            case '\b': out.append("\\b", 2); break;
+            case '\f': out.append("\\f", 2); break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0xf]};
+                out.append(escaped, 6);
+            }
+        }
+    }
+    out.append(value.data() + runStart, value.size() - runStart);
+    out.push_back('"');
+}
+
+} // namespace authlib
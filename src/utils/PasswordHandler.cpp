@@ -1,61 +1,522 @@
 #include <authlib/utils/PasswordHandler.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/utils/SecureRandom.h>
+#include <authlib/utils/exceptions.h>
+#include "Pbkdf2Batch.h"
 #include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <stdexcept>
+#include <vector>
 
-// Simplified bcrypt implementation (production should use bcrypt library)
-// For now using OpenSSL PBKDF2 as fallback
+#ifdef WITH_ARGON2
+#include <argon2.h>
+#endif
+
+// PBKDF2-HMAC-SHA256 via OpenSSL, or Argon2id via libargon2 when built with
+// it. Both are encoded as PHC strings so the salt and cost travel with the
+// hash:  $pbkdf2-sha256$i=10000$<salt>$<hash>
+//        $argon2id$v=19$m=65536,t=3,p=1$<salt>$<hash>
+// Salt and hash use the PHC "B64" alphabet (standard base64, no padding).
 
 namespace authlib {
 
-std::string PasswordHandler::hashPassword(const std::string& password) {
-    // This is a simplified implementation
-    // In production, integrate with crypt() or bcrypt library
-    unsigned char hash[32];
-    unsigned int hash_len = 32;
+namespace {
+
+constexpr const char* PBKDF2_ID = "pbkdf2-sha256";
+constexpr const char* ARGON2ID_ID = "argon2id";
+constexpr uint32_t ARGON2_VERSION = 0x13;
+constexpr size_t SALT_LENGTH = 16;
+constexpr size_t HASH_LENGTH = 32;
+constexpr uint32_t MAX_ITERATIONS = 0x7fffffff;
+
+constexpr char B64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+struct ParsedHash {
+    PasswordHashParams params;
+    std::vector<unsigned char> salt;
+    std::vector<unsigned char> hash;
+};
+
+std::string encodeB64(const unsigned char* data, size_t length) {
+    std::string out;
+    out.reserve((length * 4 + 2) / 3);
+
+    size_t i = 0;
+    for (; i + 3 <= length; i += 3) {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += B64_ALPHABET[(n >> 18) & 63];
+        out += B64_ALPHABET[(n >> 12) & 63];
+        out += B64_ALPHABET[(n >> 6) & 63];
+        out += B64_ALPHABET[n & 63];
+    }
+    if (length - i == 1) {
+        uint32_t n = data[i] << 16;
+        out += B64_ALPHABET[(n >> 18) & 63];
+        out += B64_ALPHABET[(n >> 12) & 63];
+    } else if (length - i == 2) {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8);
+        out += B64_ALPHABET[(n >> 18) & 63];
+        out += B64_ALPHABET[(n >> 12) & 63];
+        out += B64_ALPHABET[(n >> 6) & 63];
+    }
+    return out;
+}
+
+int decodeB64Char(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+bool decodeB64(const std::string& in, std::vector<unsigned char>& out) {
+    if (in.size() % 4 == 1) {
+        return false;
+    }
+    out.clear();
+    out.reserve(in.size() * 3 / 4);
+
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : in) {
+        int value = decodeB64Char(c);
+        if (value < 0) {
+            return false;
+        }
+        buffer = (buffer << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out.push_back(static_cast<unsigned char>((buffer >> bits) & 0xff));
+        }
+    }
+    return true;
+}
+
+bool parseNumber(const std::string& text, uint32_t& out) {
+    if (text.empty() || text.size() > 10) {
+        return false;
+    }
+    uint64_t value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (value == 0 || value > MAX_ITERATIONS) {
+        return false;
+    }
+    out = static_cast<uint32_t>(value);
+    return true;
+}
+
+// "k1=v1,k2=v2" with keys in a fixed order, e.g. "m=65536,t=3,p=1"
+bool parseParams(const std::string& text, const char* keys, uint32_t* values[]) {
+    size_t pos = 0;
+    for (size_t k = 0; keys[k] != '\0'; ++k) {
+        if (k > 0) {
+            if (pos >= text.size() || text[pos] != ',') {
+                return false;
+            }
+            ++pos;
+        }
+        if (pos + 2 > text.size() || text[pos] != keys[k] || text[pos + 1] != '=') {
+            return false;
+        }
+        pos += 2;
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        if (!parseNumber(text.substr(pos, end - pos), *values[k])) {
+            return false;
+        }
+        pos = end;
+    }
+    return pos == text.size();
+}
+
+// Split "$id$[v=..$]params$salt$hash" into its fields
+bool parseHash(const std::string& encoded, ParsedHash& parsed) {
+    if (encoded.empty() || encoded[0] != '$') {
+        return false;
+    }
+
+    std::vector<std::string> fields;
+    size_t start = 1;
+    while (true) {
+        size_t end = encoded.find('$', start);
+        fields.push_back(encoded.substr(start, end == std::string::npos ? std::string::npos : end - start));
+        if (end == std::string::npos) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    if (fields.size() == 4 && fields[0] == PBKDF2_ID) {
+        parsed.params.algorithm = PasswordAlgorithm::Pbkdf2Sha256;
+        uint32_t* values[] = {&parsed.params.iterations};
+        if (!parseParams(fields[1], "i", values)) {
+            return false;
+        }
+    } else if (fields.size() == 5 && fields[0] == ARGON2ID_ID) {
+        parsed.params.algorithm = PasswordAlgorithm::Argon2id;
+        uint32_t version = 0;
+        uint32_t* versionValue[] = {&version};
+        uint32_t* values[] = {
+            &parsed.params.memoryKiB,
+            &parsed.params.timeCost,
+            &parsed.params.parallelism
+        };
+        if (!parseParams(fields[1], "v", versionValue) || version != ARGON2_VERSION
+            || !parseParams(fields[2], "mtp", values)) {
+            return false;
+        }
+        fields.erase(fields.begin() + 1);
+    } else {
+        return false;
+    }
+
+    return decodeB64(fields[2], parsed.salt)
+        && decodeB64(fields[3], parsed.hash)
+        && !parsed.salt.empty()
+        && !parsed.hash.empty();
+}
+
+#ifdef WITH_ARGON2
+
+// Per-thread scratch arena handed to libargon2 through its allocation
+// callbacks. The m_cost buffer stays mapped between hashes, so a worker
+// takes the page faults for it once rather than on every call. libargon2
+// still wipes the blocks before handing them back.
+struct ScratchArena {
+    uint8_t* memory = nullptr;
+    size_t capacity = 0;
+    bool inUse = false;
+
+    ~ScratchArena() {
+        std::free(memory);
+    }
+
+    void release() {
+        std::free(memory);
+        memory = nullptr;
+        capacity = 0;
+    }
+};
+
+thread_local ScratchArena scratchArena;
+
+int arenaAllocate(uint8_t** memory, size_t bytes) {
+    ScratchArena& arena = scratchArena;
+    if (arena.inUse) {
+        return ARGON2_MEMORY_ALLOCATION_ERROR;
+    }
+    if (arena.capacity < bytes) {
+        arena.release();
+        arena.memory = static_cast<uint8_t*>(std::malloc(bytes));
+        if (!arena.memory) {
+            return ARGON2_MEMORY_ALLOCATION_ERROR;
+        }
+        arena.capacity = bytes;
+    }
+    arena.inUse = true;
+    *memory = arena.memory;
+    return ARGON2_OK;
+}
+
+void arenaFree(uint8_t*, size_t) {
+    scratchArena.inUse = false;
+}
+
+void deriveArgon2id(
+    const std::string& password,
+    const unsigned char* salt,
+    size_t saltLength,
+    const PasswordHashParams& params,
+    unsigned char* out,
+    size_t outLength
+) {
+    argon2_context context{};
+    context.out = out;
+    context.outlen = static_cast<uint32_t>(outLength);
+    context.pwd = reinterpret_cast<uint8_t*>(const_cast<char*>(password.data()));
+    context.pwdlen = static_cast<uint32_t>(password.size());
+    context.salt = const_cast<uint8_t*>(salt);
+    context.saltlen = static_cast<uint32_t>(saltLength);
+    context.t_cost = params.timeCost;
+    context.m_cost = params.memoryKiB;
+    context.lanes = params.parallelism;
+    context.threads = params.parallelism;
+    context.version = ARGON2_VERSION;
+    context.allocate_cbk = arenaAllocate;
+    context.free_cbk = arenaFree;
+    context.flags = ARGON2_DEFAULT_FLAGS;
 
-    // Generate salt (simplified)
-    unsigned char salt[16];
-    for (int i = 0; i < 16; ++i) {
-        salt[i] = static_cast<unsigned char>(rand() % 256);
+    int result = argon2_ctx(&context, Argon2_id);
+    if (result != ARGON2_OK) {
+        throw std::runtime_error(std::string("Password hashing failed: ") + argon2_error_message(result));
     }
+}
+
+#endif // WITH_ARGON2
 
-    // Use PBKDF2 for demonstration
+void derivePbkdf2(
+    const std::string& password,
+    const unsigned char* salt,
+    size_t saltLength,
+    uint32_t iterations,
+    unsigned char* out,
+    size_t outLength
+) {
     if (!PKCS5_PBKDF2_HMAC(
             password.c_str(),
-            password.length(),
+            static_cast<int>(password.length()),
             salt,
-            sizeof(salt),
-            10000,
+            static_cast<int>(saltLength),
+            static_cast<int>(iterations),
             EVP_sha256(),
-            hash_len,
-            hash
+            static_cast<int>(outLength),
+            out
         )) {
         throw std::runtime_error("Password hashing failed");
     }
+}
+
+void deriveKey(
+    const std::string& password,
+    const unsigned char* salt,
+    size_t saltLength,
+    const PasswordHashParams& params,
+    unsigned char* out,
+    size_t outLength
+) {
+    switch (params.algorithm) {
+        case PasswordAlgorithm::Pbkdf2Sha256:
+            derivePbkdf2(password, salt, saltLength, params.iterations, out, outLength);
+            return;
+        case PasswordAlgorithm::Argon2id:
+#ifdef WITH_ARGON2
+            deriveArgon2id(password, salt, saltLength, params, out, outLength);
+            return;
+#else
+            throw std::runtime_error("Argon2id support was not compiled in");
+#endif
+    }
+}
+
+std::chrono::nanoseconds timeDerivation(uint32_t iterations) {
+    static const std::string probe = "calibration-probe";
+    unsigned char salt[SALT_LENGTH] = {0};
+    unsigned char out[HASH_LENGTH];
+
+    // Best of three to filter out scheduler noise
+    auto best = std::chrono::nanoseconds::max();
+    for (int run = 0; run < 3; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        derivePbkdf2(probe, salt, sizeof(salt), iterations, out, sizeof(out));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed));
+    }
+    return best;
+}
+
+uint32_t scaleIterations(uint32_t iterations, std::chrono::nanoseconds measured, std::chrono::nanoseconds target) {
+    double ratio = static_cast<double>(target.count()) / std::max<int64_t>(measured.count(), 1);
+    double scaled = std::min(static_cast<double>(MAX_ITERATIONS), iterations * ratio);
+    // Round to the nearest thousand so hashes from a fleet share parameters
+    return static_cast<uint32_t>(std::max(1.0, std::round(scaled / 1000.0)) * 1000.0);
+}
+
+std::string formatHash(const PasswordHashParams& params, const unsigned char* salt, const unsigned char* hash) {
+    std::string result = "$";
+    if (params.algorithm == PasswordAlgorithm::Argon2id) {
+        result += ARGON2ID_ID;
+        result += "$v=" + std::to_string(ARGON2_VERSION);
+        result += "$m=" + std::to_string(params.memoryKiB);
+        result += ",t=" + std::to_string(params.timeCost);
+        result += ",p=" + std::to_string(params.parallelism);
+    } else {
+        result += PBKDF2_ID;
+        result += "$i=" + std::to_string(params.iterations);
+    }
+    result += "$" + encodeB64(salt, SALT_LENGTH);
+    result += "$" + encodeB64(hash, HASH_LENGTH);
+    return result;
+}
+
+} // namespace
+
+PasswordHandler::PasswordHandler() {}
+
+PasswordHandler::PasswordHandler(uint32_t iterations) {
+    if (iterations == 0 || iterations > MAX_ITERATIONS) {
+        throw ValidationError("Password hash iterations out of range");
+    }
+    params.iterations = iterations;
+}
 
-    // Return hash as hex string (simplified)
-    std::string result;
-    result.reserve(hash_len * 2);
-    for (unsigned int i = 0; i < hash_len; ++i) {
-        char buf[3];
-        sprintf(buf, "%02x", hash[i]);
-        result += buf;
+PasswordHandler::PasswordHandler(const PasswordHashParams& params) : params(params) {
+    if (params.iterations == 0 || params.iterations > MAX_ITERATIONS) {
+        throw ValidationError("Password hash iterations out of range");
     }
+    if (params.algorithm == PasswordAlgorithm::Argon2id) {
+        if (!isAlgorithmAvailable(PasswordAlgorithm::Argon2id)) {
+            throw ValidationError("Argon2id support was not compiled in");
+        }
+        if (params.timeCost == 0 || params.parallelism == 0 || params.parallelism > 0xffffff) {
+            throw ValidationError("Argon2id time cost and parallelism must be positive");
+        }
+        if (params.memoryKiB < 8 * params.parallelism) {
+            throw ValidationError("Argon2id memory must be at least 8 KiB per lane");
+        }
+    }
+}
+
+std::string PasswordHandler::hashPassword(const std::string& password) const {
+    ScopedTimer timer(Metric::Hash);
+    unsigned char hash[HASH_LENGTH];
+    unsigned char salt[SALT_LENGTH];
+    SecureRandom::fill(salt, sizeof(salt));
+
+    deriveKey(password, salt, sizeof(salt), params, hash, sizeof(hash));
+
+    std::string result = formatHash(params, salt, hash);
+    OPENSSL_cleanse(hash, sizeof(hash));
     return result;
 }
 
-bool PasswordHandler::verifyPassword(const std::string& password, const std::string& hash) {
+std::vector<std::string> PasswordHandler::hashPasswordBatch(const std::vector<std::string>& passwords) const {
+    std::vector<std::string> results;
+    results.reserve(passwords.size());
+
+    if (params.algorithm != PasswordAlgorithm::Pbkdf2Sha256) {
+        // Argon2id is memory-bound; lanes would only contend for bandwidth
+        for (const auto& password : passwords) {
+            results.push_back(hashPassword(password));
+        }
+        return results;
+    }
+
+    size_t count = passwords.size();
+    std::vector<unsigned char> salts(count * SALT_LENGTH);
+    std::vector<unsigned char> hashes(count * HASH_LENGTH);
+    std::vector<detail::Pbkdf2Job> jobs(count);
+    SecureRandom::fill(salts.data(), salts.size());
+    for (size_t i = 0; i < count; ++i) {
+        jobs[i] = {&passwords[i], &salts[i * SALT_LENGTH], SALT_LENGTH, &hashes[i * HASH_LENGTH]};
+    }
+
+    detail::pbkdf2Sha256Batch(jobs.data(), count, params.iterations);
+
+    for (size_t i = 0; i < count; ++i) {
+        results.push_back(formatHash(params, &salts[i * SALT_LENGTH], &hashes[i * HASH_LENGTH]));
+    }
+    OPENSSL_cleanse(hashes.data(), hashes.size());
+    return results;
+}
+
+bool PasswordHandler::verifyPassword(const std::string& password, const std::string& hash) const {
+    ScopedTimer timer(Metric::HashVerify);
+    ParsedHash parsed;
+    if (!parseHash(hash, parsed)) {
+        return false;
+    }
+
     try {
-        std::string newHash = hashPassword(password);
-        return newHash == hash;
+        std::vector<unsigned char> candidate(parsed.hash.size());
+        deriveKey(
+            password,
+            parsed.salt.data(),
+            parsed.salt.size(),
+            parsed.params,
+            candidate.data(),
+            candidate.size()
+        );
+        bool matches = CRYPTO_memcmp(candidate.data(), parsed.hash.data(), candidate.size()) == 0;
+        OPENSSL_cleanse(candidate.data(), candidate.size());
+        return matches;
     } catch (...) {
         return false;
     }
 }
 
-bool PasswordHandler::needsRehashing(const std::string& hash) {
-    return hash.length() < 32;
+bool PasswordHandler::needsRehashing(const std::string& hash) const {
+    ParsedHash parsed;
+    if (!parseHash(hash, parsed)) {
+        return true;
+    }
+    if (parsed.params.algorithm != params.algorithm
+        || parsed.salt.size() != SALT_LENGTH
+        || parsed.hash.size() != HASH_LENGTH) {
+        return true;
+    }
+    if (params.algorithm == PasswordAlgorithm::Argon2id) {
+        return parsed.params.memoryKiB != params.memoryKiB
+            || parsed.params.timeCost != params.timeCost
+            || parsed.params.parallelism != params.parallelism;
+    }
+    return parsed.params.iterations != params.iterations;
+}
+
+uint32_t PasswordHandler::getIterations() const {
+    return params.iterations;
+}
+
+const PasswordHashParams& PasswordHandler::getParams() const {
+    return params;
+}
+
+bool PasswordHandler::isAlgorithmAvailable(PasswordAlgorithm algorithm) {
+#ifdef WITH_ARGON2
+    (void)algorithm;
+    return true;
+#else
+    return algorithm == PasswordAlgorithm::Pbkdf2Sha256;
+#endif
+}
+
+PasswordAlgorithm PasswordHandler::algorithmFromName(const std::string& name) {
+    if (name == PBKDF2_ID) {
+        return PasswordAlgorithm::Pbkdf2Sha256;
+    }
+    if (name == ARGON2ID_ID) {
+        return PasswordAlgorithm::Argon2id;
+    }
+    throw ValidationError("Unknown password hash algorithm: " + name);
+}
+
+std::string PasswordHandler::batchBackend() {
+    return detail::pbkdf2BatchBackend();
+}
+
+void PasswordHandler::releaseScratchMemory() {
+#ifdef WITH_ARGON2
+    if (!scratchArena.inUse) {
+        scratchArena.release();
+    }
+#endif
+}
+
+uint32_t PasswordHandler::calibrateIterations(std::chrono::milliseconds target, uint32_t floor) {
+    if (target.count() <= 0) {
+        return std::max(floor, 1u);
+    }
+    auto targetNs = std::chrono::duration_cast<std::chrono::nanoseconds>(target);
+
+    // Probe with a cheap run, then re-measure the estimate once to correct
+    // for fixed per-call overhead.
+    uint32_t estimate = scaleIterations(DEFAULT_ITERATIONS, timeDerivation(DEFAULT_ITERATIONS), targetNs);
+    estimate = scaleIterations(estimate, timeDerivation(estimate), targetNs);
+
+    return std::max({estimate, floor, 1u});
 }
 
 } // namespace authlib
@@ -0,0 +1,219 @@
+#include <authlib/utils/PasswordHashPool.h>
+#include <authlib/utils/exceptions.h>
+#include <openssl/crypto.h>
+
+namespace authlib {
+
+namespace {
+
+uint64_t microsBetween(
+    std::chrono::steady_clock::time_point from,
+    std::chrono::steady_clock::time_point to
+) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(to - from).count()
+    );
+}
+
+void updateMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// Passwords are copied into the task; scrub the copy once it has been used
+void wipe(std::string& secret) {
+    if (!secret.empty()) {
+        OPENSSL_cleanse(&secret[0], secret.size());
+    }
+}
+
+} // namespace
+
+double HashPoolStats::meanWaitMicros() const {
+    return completed ? static_cast<double>(totalWaitMicros) / completed : 0.0;
+}
+
+double HashPoolStats::meanServiceMicros() const {
+    return completed ? static_cast<double>(totalServiceMicros) / completed : 0.0;
+}
+
+PasswordHashPool::PasswordHashPool(size_t workers, size_t queueCapacity, PasswordHandler handler)
+    : handler(handler),
+      queueCapacity(queueCapacity),
+      stopping(false),
+      submitted(0),
+      rejected(0),
+      completed(0),
+      totalWaitMicros(0),
+      maxWaitMicros(0),
+      totalServiceMicros(0),
+      maxServiceMicros(0) {
+    if (queueCapacity == 0) {
+        throw ValidationError("queueCapacity must be a positive number");
+    }
+    if (workers == 0) {
+        workers = std::thread::hardware_concurrency();
+        if (workers == 0) {
+            workers = 1;
+        }
+    }
+
+    threads.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        threads.emplace_back(&PasswordHashPool::workerLoop, this);
+    }
+}
+
+PasswordHashPool::PasswordHashPool(const Config& config, PasswordHandler handler)
+    : PasswordHashPool(config.PASSWORD_HASH_POOL_WORKERS, config.PASSWORD_HASH_POOL_QUEUE_CAPACITY, handler) {}
+
+PasswordHashPool::~PasswordHashPool() {
+    shutdown();
+}
+
+std::future<std::string> PasswordHashPool::hashAsync(const std::string& password) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> result = promise->get_future();
+
+    submit([this, promise, password = std::string(password)]() mutable {
+        try {
+            promise->set_value(handler.hashPassword(password));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+        wipe(password);
+    });
+
+    return result;
+}
+
+void PasswordHashPool::hashAsync(const std::string& password, HashCallback callback) {
+    submit([this, callback = std::move(callback), password = std::string(password)]() mutable {
+        std::string hash;
+        std::exception_ptr error;
+        try {
+            hash = handler.hashPassword(password);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        wipe(password);
+        callback(std::move(hash), error);
+    });
+}
+
+std::future<bool> PasswordHashPool::verifyAsync(const std::string& password, const std::string& hash) {
+    auto promise = std::make_shared<std::promise<bool>>();
+    std::future<bool> result = promise->get_future();
+
+    submit([this, promise, password = std::string(password), hash]() mutable {
+        try {
+            promise->set_value(handler.verifyPassword(password, hash));
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+        wipe(password);
+    });
+
+    return result;
+}
+
+void PasswordHashPool::verifyAsync(
+    const std::string& password,
+    const std::string& hash,
+    VerifyCallback callback
+) {
+    submit([this, callback = std::move(callback), password = std::string(password), hash]() mutable {
+        bool matches = false;
+        std::exception_ptr error;
+        try {
+            matches = handler.verifyPassword(password, hash);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        wipe(password);
+        callback(matches, error);
+    });
+}
+
+HashPoolStats PasswordHashPool::stats() const {
+    HashPoolStats result;
+    result.workers = threads.size();
+    result.queueCapacity = queueCapacity;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        result.queueDepth = queue.size();
+    }
+    result.submitted = submitted.load(std::memory_order_relaxed);
+    result.rejected = rejected.load(std::memory_order_relaxed);
+    result.completed = completed.load(std::memory_order_relaxed);
+    result.totalWaitMicros = totalWaitMicros.load(std::memory_order_relaxed);
+    result.maxWaitMicros = maxWaitMicros.load(std::memory_order_relaxed);
+    result.totalServiceMicros = totalServiceMicros.load(std::memory_order_relaxed);
+    result.maxServiceMicros = maxServiceMicros.load(std::memory_order_relaxed);
+    return result;
+}
+
+void PasswordHashPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void PasswordHashPool::submit(std::function<void()> work) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            throw AuthException("Password hash pool is shut down");
+        }
+        if (queue.size() >= queueCapacity) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            throw HashQueueFull();
+        }
+        queue.push_back(Task{std::move(work), std::chrono::steady_clock::now()});
+    }
+    submitted.fetch_add(1, std::memory_order_relaxed);
+    available.notify_one();
+}
+
+void PasswordHashPool::workerLoop() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            task = std::move(queue.front());
+            queue.pop_front();
+        }
+
+        auto startedAt = std::chrono::steady_clock::now();
+        try {
+            task.run();
+        } catch (...) {
+            // A throwing user callback must not take the worker down with it
+        }
+        auto finishedAt = std::chrono::steady_clock::now();
+
+        uint64_t waited = microsBetween(task.enqueuedAt, startedAt);
+        uint64_t served = microsBetween(startedAt, finishedAt);
+        totalWaitMicros.fetch_add(waited, std::memory_order_relaxed);
+        totalServiceMicros.fetch_add(served, std::memory_order_relaxed);
+        updateMax(maxWaitMicros, waited);
+        updateMax(maxServiceMicros, served);
+        completed.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+} // namespace authlib
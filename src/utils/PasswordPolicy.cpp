@@ -0,0 +1,353 @@
+#include <authlib/utils/PasswordPolicy.h>
+#include <authlib/utils/exceptions.h>
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <stdexcept>
+
+// The policy is compiled once: character classes come from a 256-entry
+// table, forbidden substrings from an Aho-Corasick DFA and dictionary words
+// from a sorted hash table, so check() makes one pass over the password
+// (plus a short scan for the caller's email local part) and never locks.
+
+namespace authlib {
+
+namespace {
+
+enum CharClassBit : uint8_t {
+    UPPER = 1,
+    LOWER = 2,
+    DIGIT = 4,
+    SPECIAL = 8
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        if (c >= 'A' && c <= 'Z') {
+            table[c] = UPPER;
+        } else if (c >= 'a' && c <= 'z') {
+            table[c] = LOWER;
+        } else if (c >= '0' && c <= '9') {
+            table[c] = DIGIT;
+        } else {
+            table[c] = SPECIAL;
+        }
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> makeFoldTable() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        table[c] = static_cast<uint8_t>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    }
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = makeCharClasses();
+constexpr std::array<uint8_t, 256> FOLD = makeFoldTable();
+
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+constexpr size_t MIN_EMAIL_LOCAL_PART = 3;
+
+uint64_t foldedHash(const std::string& text) {
+    uint64_t hash = FNV_OFFSET;
+    for (unsigned char c : text) {
+        hash = (hash ^ FOLD[c]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+std::string fold(const std::string& text) {
+    std::string out(text);
+    for (auto& c : out) {
+        c = static_cast<char>(FOLD[static_cast<unsigned char>(c)]);
+    }
+    return out;
+}
+
+bool containsFolded(const std::string& haystack, const char* needle, size_t needleLength) {
+    if (needleLength == 0 || needleLength > haystack.size()) {
+        return false;
+    }
+    for (size_t i = 0; i + needleLength <= haystack.size(); ++i) {
+        size_t j = 0;
+        while (j < needleLength
+            && FOLD[static_cast<unsigned char>(haystack[i + j])] == FOLD[static_cast<unsigned char>(needle[j])]) {
+            ++j;
+        }
+        if (j == needleLength) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> items;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string item = list.substr(start, end - start);
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+        start = end + 1;
+    }
+    return items;
+}
+
+} // namespace
+
+PasswordPolicy::PasswordPolicy(const PasswordPolicyOptions& options) : options(options) {
+    if (options.minLength > options.maxLength) {
+        throw ValidationError("Password policy minimum length exceeds maximum");
+    }
+    requiredClasses = (options.requireUppercase ? UPPER : 0)
+        | (options.requireLowercase ? LOWER : 0)
+        | (options.requireDigit ? DIGIT : 0)
+        | (options.requireSpecial ? SPECIAL : 0);
+
+    compileSubstrings();
+    compileDictionary();
+}
+
+void PasswordPolicy::compileSubstrings() {
+    std::vector<std::string> patterns;
+    for (const auto& substring : options.forbiddenSubstrings) {
+        if (!substring.empty()) {
+            patterns.push_back(fold(substring));
+        }
+    }
+    if (patterns.empty()) {
+        return;
+    }
+
+    // Only bytes that occur in some pattern get their own column
+    classCount = 1;
+    for (const auto& pattern : patterns) {
+        for (unsigned char c : pattern) {
+            if (byteClass[c] == 0) {
+                byteClass[c] = static_cast<uint8_t>(classCount++);
+            }
+        }
+    }
+    for (int c = 'A'; c <= 'Z'; ++c) {
+        byteClass[c] = byteClass[FOLD[c]];
+    }
+
+    // Trie, with -1 marking missing edges until failure links fill them in
+    std::vector<int64_t> edges(classCount, -1);
+    accepting.assign(1, 0);
+    for (const auto& pattern : patterns) {
+        size_t state = 0;
+        for (unsigned char c : pattern) {
+            int64_t& next = edges[state * classCount + byteClass[c]];
+            if (next < 0) {
+                next = static_cast<int64_t>(accepting.size());
+                accepting.push_back(0);
+                edges.resize(edges.size() + classCount, -1);
+            }
+            state = static_cast<size_t>(edges[state * classCount + byteClass[c]]);
+        }
+        accepting[state] = 1;
+    }
+
+    size_t stateCount = accepting.size();
+    std::vector<size_t> failure(stateCount, 0);
+    std::deque<size_t> queue;
+    for (size_t k = 0; k < classCount; ++k) {
+        if (edges[k] < 0) {
+            edges[k] = 0;
+        } else {
+            queue.push_back(static_cast<size_t>(edges[k]));
+        }
+    }
+    while (!queue.empty()) {
+        size_t state = queue.front();
+        queue.pop_front();
+        accepting[state] |= accepting[failure[state]];
+        for (size_t k = 0; k < classCount; ++k) {
+            int64_t& next = edges[state * classCount + k];
+            int64_t fallback = edges[failure[state] * classCount + k];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                failure[static_cast<size_t>(next)] = static_cast<size_t>(fallback);
+                queue.push_back(static_cast<size_t>(next));
+            }
+        }
+    }
+
+    transitions.assign(edges.begin(), edges.end());
+}
+
+void PasswordPolicy::compileDictionary() {
+    for (const auto& word : options.dictionary) {
+        if (word.empty()) {
+            continue;
+        }
+        dictionaryHashes.emplace_back(foldedHash(word), static_cast<uint32_t>(dictionaryWords.size()));
+        dictionaryWords.push_back(fold(word));
+    }
+    std::sort(dictionaryHashes.begin(), dictionaryHashes.end());
+}
+
+std::shared_ptr<const PasswordPolicy> PasswordPolicy::fromConfig(const Config& config) {
+    PasswordPolicyOptions options;
+    options.minLength = config.PASSWORD_MIN_LENGTH;
+    options.maxLength = config.PASSWORD_MAX_LENGTH;
+    options.requireUppercase = config.PASSWORD_REQUIRE_UPPERCASE;
+    options.requireLowercase = config.PASSWORD_REQUIRE_LOWERCASE;
+    options.requireDigit = config.PASSWORD_REQUIRE_DIGIT;
+    options.requireSpecial = config.PASSWORD_REQUIRE_SPECIAL;
+    options.forbidEmailLocalPart = config.PASSWORD_FORBID_EMAIL;
+    options.forbiddenSubstrings = splitList(config.PASSWORD_FORBIDDEN_SUBSTRINGS);
+
+    if (!config.PASSWORD_DICTIONARY_PATH.empty()) {
+        std::ifstream file(config.PASSWORD_DICTIONARY_PATH);
+        if (!file) {
+            throw std::runtime_error("Cannot open password dictionary: " + config.PASSWORD_DICTIONARY_PATH);
+        }
+        std::string line;
+        while (std::getline(file, line)) {
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (!line.empty()) {
+                options.dictionary.push_back(line);
+            }
+        }
+    }
+
+    if (!config.PASSWORD_BREACHED_INDEX_PATH.empty()) {
+        options.breachedPasswords = std::make_shared<BreachedPasswordIndex>(config.PASSWORD_BREACHED_INDEX_PATH);
+    }
+
+    return std::make_shared<const PasswordPolicy>(options);
+}
+
+std::vector<PolicyViolation> PasswordPolicy::check(const std::string& password, const std::string& email) const {
+    uint8_t classes = 0;
+    uint64_t hash = FNV_OFFSET;
+    uint32_t state = 0;
+    uint8_t forbidden = 0;
+    const bool scanSubstrings = !transitions.empty();
+
+    for (unsigned char c : password) {
+        classes |= CHAR_CLASSES[c];
+        hash = (hash ^ FOLD[c]) * FNV_PRIME;
+        if (scanSubstrings) {
+            state = transitions[state * classCount + byteClass[c]];
+            forbidden |= accepting[state];
+        }
+    }
+
+    std::vector<PolicyViolation> violations;
+    if (password.size() < options.minLength) {
+        violations.push_back(PolicyViolation::TooShort);
+    }
+    if (password.size() > options.maxLength) {
+        violations.push_back(PolicyViolation::TooLong);
+    }
+    uint8_t missing = requiredClasses & ~classes;
+    if (missing & UPPER) {
+        violations.push_back(PolicyViolation::MissingUppercase);
+    }
+    if (missing & LOWER) {
+        violations.push_back(PolicyViolation::MissingLowercase);
+    }
+    if (missing & DIGIT) {
+        violations.push_back(PolicyViolation::MissingDigit);
+    }
+    if (missing & SPECIAL) {
+        violations.push_back(PolicyViolation::MissingSpecial);
+    }
+    if (forbidden) {
+        violations.push_back(PolicyViolation::ForbiddenSubstring);
+    }
+
+    auto range = std::equal_range(
+        dictionaryHashes.begin(),
+        dictionaryHashes.end(),
+        std::make_pair(hash, uint32_t(0)),
+        [](const auto& a, const auto& b) { return a.first < b.first; }
+    );
+    for (auto it = range.first; it != range.second; ++it) {
+        const std::string& word = dictionaryWords[it->second];
+        if (word.size() == password.size() && containsFolded(password, word.data(), word.size())) {
+            violations.push_back(PolicyViolation::DictionaryWord);
+            break;
+        }
+    }
+
+    if (options.forbidEmailLocalPart && !email.empty()) {
+        size_t localLength = std::min(email.find('@'), email.size());
+        if (localLength >= MIN_EMAIL_LOCAL_PART && containsFolded(password, email.data(), localLength)) {
+            violations.push_back(PolicyViolation::ContainsEmail);
+        }
+    }
+
+    if (options.breachedPasswords && options.breachedPasswords->contains(password)) {
+        violations.push_back(PolicyViolation::Breached);
+    }
+
+    return violations;
+}
+
+void PasswordPolicy::validate(const std::string& password, const std::string& email) const {
+    std::string message = violationMessage(password, email);
+    if (!message.empty()) {
+        throw ValidationError(message);
+    }
+}
+
+std::string PasswordPolicy::violationMessage(const std::string& password, const std::string& email) const {
+    std::string message;
+    for (auto violation : check(password, email)) {
+        if (!message.empty()) {
+            message += "; ";
+        }
+        message += describe(violation);
+    }
+    return message;
+}
+
+std::string PasswordPolicy::describe(PolicyViolation violation) const {
+    switch (violation) {
+        case PolicyViolation::TooShort:
+            return "Password must be at least " + std::to_string(options.minLength) + " characters long";
+        case PolicyViolation::TooLong:
+            return "Password must not exceed " + std::to_string(options.maxLength) + " characters";
+        case PolicyViolation::MissingUppercase:
+            return "Password must contain an uppercase letter";
+        case PolicyViolation::MissingLowercase:
+            return "Password must contain a lowercase letter";
+        case PolicyViolation::MissingDigit:
+            return "Password must contain a number";
+        case PolicyViolation::MissingSpecial:
+            return "Password must contain a special character";
+        case PolicyViolation::ForbiddenSubstring:
+            return "Password contains a word that is not allowed";
+        case PolicyViolation::DictionaryWord:
+            return "Password is too common";
+        case PolicyViolation::ContainsEmail:
+            return "Password must not contain your email address";
+        case PolicyViolation::Breached:
+            return "Password has appeared in a known data breach; choose a different one";
+    }
+    return "Password does not meet the policy";
+}
+
+const PasswordPolicyOptions& PasswordPolicy::getOptions() const {
+    return options;
+}
+
+} // namespace authlib
@@ -0,0 +1,77 @@
+/**
+ * Multi-lane PBKDF2-HMAC-SHA256 (internal)
+ */
+
+#ifndef AUTHLIB_PBKDF2_BATCH_H
+#define AUTHLIB_PBKDF2_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace authlib {
+namespace detail {
+
+// One PBKDF2 chain with a 32-byte output (a single PBKDF2 block).
+// `inner`/`outer` are the HMAC key midstates, `u` the previous HMAC
+// output and `t` the running XOR of every U, all as big-endian words.
+struct Pbkdf2Lane {
+    uint32_t inner[8];
+    uint32_t outer[8];
+    uint32_t u[8];
+    uint32_t t[8];
+};
+
+// Advances up to `width` lanes by `rounds` HMAC iterations in lock-step.
+using Pbkdf2Kernel = void (*)(Pbkdf2Lane* lanes, size_t count, uint32_t rounds);
+
+struct Pbkdf2KernelInfo {
+    const char* name;
+    size_t width;
+    Pbkdf2Kernel run; // nullptr when the build does not include this ISA
+};
+
+struct Pbkdf2Job {
+    const std::string* password;
+    const unsigned char* salt;
+    size_t saltLength;
+    unsigned char* out; // 32 bytes
+};
+
+/**
+ * Run PBKDF2-HMAC-SHA256 for every job, `width` chains at a time on the
+ * widest kernel this CPU supports. Output is identical to OpenSSL's
+ * PKCS5_PBKDF2_HMAC with a 32-byte key length.
+ */
+void pbkdf2Sha256Batch(Pbkdf2Job* jobs, size_t count, uint32_t iterations);
+
+/**
+ * The same on a given kernel instead of the selected one, so tests can
+ * hold every kernel to the OpenSSL path
+ */
+void pbkdf2Sha256Batch(const Pbkdf2KernelInfo& kernel, Pbkdf2Job* jobs, size_t count, uint32_t iterations);
+
+/**
+ * Every kernel this CPU can run, fastest first, ending with the scalar
+ * OpenSSL path ({"openssl", 1, nullptr}). AUTHLIB_PBKDF2_KERNEL picks
+ * from this list; without it the first entry is used.
+ */
+std::vector<Pbkdf2KernelInfo> pbkdf2SupportedKernels();
+
+/**
+ * Name and lane count of the kernel selected for this CPU
+ */
+const char* pbkdf2BatchBackend();
+size_t pbkdf2BatchWidth();
+
+// Kernels, defined in per-ISA translation units
+Pbkdf2KernelInfo pbkdf2KernelSse2();
+Pbkdf2KernelInfo pbkdf2KernelAvx2();
+Pbkdf2KernelInfo pbkdf2KernelAvx512();
+Pbkdf2KernelInfo pbkdf2KernelShaNi();
+
+} // namespace detail
+} // namespace authlib
+
+#endif // AUTHLIB_PBKDF2_BATCH_H
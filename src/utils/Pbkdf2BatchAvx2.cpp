@@ -0,0 +1,58 @@
+#include "Pbkdf2Batch.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AVX2__)
+
+#include <immintrin.h>
+#include "Sha256Lanes.h"
+
+namespace authlib {
+namespace detail {
+
+namespace {
+
+// 8 lanes of 32-bit words. Built with -mavx2 / /arch:AVX2; only called after
+// the dispatcher has confirmed AVX2 support.
+struct Avx2Vec {
+    static constexpr size_t WIDTH = 8;
+    __m256i v;
+
+    static Avx2Vec set1(uint32_t x) { return {_mm256_set1_epi32(static_cast<int>(x))}; }
+    static Avx2Vec load(const uint32_t* p) { return {_mm256_load_si256(reinterpret_cast<const __m256i*>(p))}; }
+    static void store(uint32_t* p, Avx2Vec x) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), x.v); }
+    static Avx2Vec add(Avx2Vec a, Avx2Vec b) { return {_mm256_add_epi32(a.v, b.v)}; }
+    static Avx2Vec xor2(Avx2Vec a, Avx2Vec b) { return {_mm256_xor_si256(a.v, b.v)}; }
+    static Avx2Vec xor3(Avx2Vec a, Avx2Vec b, Avx2Vec c) { return {_mm256_xor_si256(_mm256_xor_si256(a.v, b.v), c.v)}; }
+    static Avx2Vec ch(Avx2Vec e, Avx2Vec f, Avx2Vec g) {
+        return {_mm256_xor_si256(g.v, _mm256_and_si256(e.v, _mm256_xor_si256(f.v, g.v)))};
+    }
+    static Avx2Vec maj(Avx2Vec a, Avx2Vec b, Avx2Vec c) {
+        return {_mm256_or_si256(_mm256_and_si256(a.v, b.v), _mm256_and_si256(c.v, _mm256_or_si256(a.v, b.v)))};
+    }
+    template <int N>
+    static Avx2Vec rotr(Avx2Vec x) { return {_mm256_or_si256(_mm256_srli_epi32(x.v, N), _mm256_slli_epi32(x.v, 32 - N))}; }
+    template <int N>
+    static Avx2Vec shr(Avx2Vec x) { return {_mm256_srli_epi32(x.v, N)}; }
+};
+
+} // namespace
+
+Pbkdf2KernelInfo pbkdf2KernelAvx2() {
+    return {"avx2", Avx2Vec::WIDTH, &sha256lanes::iterateLanes<Avx2Vec>};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#else
+
+namespace authlib {
+namespace detail {
+
+Pbkdf2KernelInfo pbkdf2KernelAvx2() {
+    return {"avx2", 0, nullptr};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#endif
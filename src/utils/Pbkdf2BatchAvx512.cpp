@@ -0,0 +1,61 @@
+#include "Pbkdf2Batch.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__AVX512F__)
+
+#include <immintrin.h>
+#include "Sha256Lanes.h"
+
+namespace authlib {
+namespace detail {
+
+namespace {
+
+// 16 lanes of 32-bit words. Built with -mavx512f / /arch:AVX512; only called
+// after the dispatcher has confirmed AVX-512F support. Uses the native
+// rotate and ternary-logic instructions for the SHA-256 boolean functions.
+struct Avx512Vec {
+    static constexpr size_t WIDTH = 16;
+    __m512i v;
+
+    static Avx512Vec set1(uint32_t x) { return {_mm512_set1_epi32(static_cast<int>(x))}; }
+    static Avx512Vec load(const uint32_t* p) { return {_mm512_load_si512(p)}; }
+    static void store(uint32_t* p, Avx512Vec x) { _mm512_store_si512(p, x.v); }
+    static Avx512Vec add(Avx512Vec a, Avx512Vec b) { return {_mm512_add_epi32(a.v, b.v)}; }
+    static Avx512Vec xor2(Avx512Vec a, Avx512Vec b) { return {_mm512_xor_si512(a.v, b.v)}; }
+    static Avx512Vec xor3(Avx512Vec a, Avx512Vec b, Avx512Vec c) {
+        return {_mm512_ternarylogic_epi32(a.v, b.v, c.v, 0x96)};
+    }
+    static Avx512Vec ch(Avx512Vec e, Avx512Vec f, Avx512Vec g) {
+        return {_mm512_ternarylogic_epi32(e.v, f.v, g.v, 0xca)};
+    }
+    static Avx512Vec maj(Avx512Vec a, Avx512Vec b, Avx512Vec c) {
+        return {_mm512_ternarylogic_epi32(a.v, b.v, c.v, 0xe8)};
+    }
+    template <int N>
+    static Avx512Vec rotr(Avx512Vec x) { return {_mm512_ror_epi32(x.v, N)}; }
+    template <int N>
+    static Avx512Vec shr(Avx512Vec x) { return {_mm512_srli_epi32(x.v, N)}; }
+};
+
+} // namespace
+
+Pbkdf2KernelInfo pbkdf2KernelAvx512() {
+    return {"avx512", Avx512Vec::WIDTH, &sha256lanes::iterateLanes<Avx512Vec>};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#else
+
+namespace authlib {
+namespace detail {
+
+Pbkdf2KernelInfo pbkdf2KernelAvx512() {
+    return {"avx512", 0, nullptr};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#endif
@@ -0,0 +1,162 @@
+#include "Pbkdf2Batch.h"
+
+#if (defined(__x86_64__) && defined(__SHA__) && defined(__SSE4_1__)) || defined(_M_X64)
+
+#include <immintrin.h>
+
+namespace authlib {
+namespace detail {
+
+namespace {
+
+// SHA-NI works on one chain at a time, so instead of widening the vectors
+// this kernel interleaves STREAMS independent chains to keep the
+// sha256rnds2 pipeline full. Built with -msha -msse4.1; only called after
+// the dispatcher has confirmed SHA extensions.
+constexpr size_t STREAMS = 4;
+
+alignas(16) const uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// Words a..h -> the ABEF/CDGH register layout sha256rnds2 expects
+inline void toShaState(const uint32_t words[8], __m128i& abef, __m128i& cdgh) {
+    __m128i dcba = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words));
+    __m128i hgfe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(words + 4));
+    __m128i cdab = _mm_shuffle_epi32(dcba, 0xb1);
+    __m128i efgh = _mm_shuffle_epi32(hgfe, 0x1b);
+    abef = _mm_alignr_epi8(cdab, efgh, 8);
+    cdgh = _mm_blend_epi16(efgh, cdab, 0xf0);
+}
+
+// ABEF/CDGH -> two vectors holding words a..d and e..h
+inline void fromShaState(__m128i abef, __m128i cdgh, __m128i& dcba, __m128i& hgfe) {
+    __m128i feba = _mm_shuffle_epi32(abef, 0x1b);
+    __m128i dchg = _mm_shuffle_epi32(cdgh, 0xb1);
+    dcba = _mm_blend_epi16(feba, dchg, 0xf0);
+    hgfe = _mm_alignr_epi8(dchg, feba, 8);
+}
+
+// One compression per stream of the 64-byte block (m0..m3 per stream)
+inline void compress(__m128i abef[STREAMS], __m128i cdgh[STREAMS], __m128i m[STREAMS][4]) {
+    __m128i a[STREAMS];
+    __m128i c[STREAMS];
+    for (size_t s = 0; s < STREAMS; ++s) {
+        a[s] = abef[s];
+        c[s] = cdgh[s];
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(K + 4 * i));
+        for (size_t s = 0; s < STREAMS; ++s) {
+            __m128i w;
+            if (i < 4) {
+                w = m[s][i];
+            } else {
+                w = _mm_sha256msg2_epu32(
+                    _mm_add_epi32(
+                        _mm_sha256msg1_epu32(m[s][i & 3], m[s][(i + 1) & 3]),
+                        _mm_alignr_epi8(m[s][(i + 3) & 3], m[s][(i + 2) & 3], 4)
+                    ),
+                    m[s][(i + 3) & 3]
+                );
+                m[s][i & 3] = w;
+            }
+            __m128i msg = _mm_add_epi32(w, k);
+            c[s] = _mm_sha256rnds2_epu32(c[s], a[s], msg);
+            a[s] = _mm_sha256rnds2_epu32(a[s], c[s], _mm_shuffle_epi32(msg, 0x0e));
+        }
+    }
+
+    for (size_t s = 0; s < STREAMS; ++s) {
+        abef[s] = _mm_add_epi32(abef[s], a[s]);
+        cdgh[s] = _mm_add_epi32(cdgh[s], c[s]);
+    }
+}
+
+void iterateShaNi(Pbkdf2Lane* lanes, size_t count, uint32_t rounds) {
+    __m128i innerAbef[STREAMS], innerCdgh[STREAMS];
+    __m128i outerAbef[STREAMS], outerCdgh[STREAMS];
+    __m128i u0[STREAMS], u1[STREAMS], t0[STREAMS], t1[STREAMS];
+
+    // Missing streams repeat lane 0 and are discarded afterwards
+    for (size_t s = 0; s < STREAMS; ++s) {
+        const Pbkdf2Lane& lane = lanes[s < count ? s : 0];
+        toShaState(lane.inner, innerAbef[s], innerCdgh[s]);
+        toShaState(lane.outer, outerAbef[s], outerCdgh[s]);
+        u0[s] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane.u));
+        u1[s] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane.u + 4));
+        t0[s] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane.t));
+        t1[s] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane.t + 4));
+    }
+
+    // Second-block padding for a 32-byte message after the 64-byte key block
+    const __m128i padHigh = _mm_set_epi32(0, 0, 0, static_cast<int>(0x80000000u));
+    const __m128i padLow = _mm_set_epi32((64 + 32) * 8, 0, 0, 0);
+
+    __m128i abef[STREAMS], cdgh[STREAMS];
+    __m128i m[STREAMS][4];
+    for (uint32_t round = 0; round < rounds; ++round) {
+        for (size_t s = 0; s < STREAMS; ++s) {
+            abef[s] = innerAbef[s];
+            cdgh[s] = innerCdgh[s];
+            m[s][0] = u0[s];
+            m[s][1] = u1[s];
+            m[s][2] = padHigh;
+            m[s][3] = padLow;
+        }
+        compress(abef, cdgh, m);
+
+        for (size_t s = 0; s < STREAMS; ++s) {
+            fromShaState(abef[s], cdgh[s], m[s][0], m[s][1]);
+            m[s][2] = padHigh;
+            m[s][3] = padLow;
+            abef[s] = outerAbef[s];
+            cdgh[s] = outerCdgh[s];
+        }
+        compress(abef, cdgh, m);
+
+        for (size_t s = 0; s < STREAMS; ++s) {
+            fromShaState(abef[s], cdgh[s], u0[s], u1[s]);
+            t0[s] = _mm_xor_si128(t0[s], u0[s]);
+            t1[s] = _mm_xor_si128(t1[s], u1[s]);
+        }
+    }
+
+    for (size_t s = 0; s < count && s < STREAMS; ++s) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[s].u), u0[s]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[s].u + 4), u1[s]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[s].t), t0[s]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes[s].t + 4), t1[s]);
+    }
+}
+
+} // namespace
+
+Pbkdf2KernelInfo pbkdf2KernelShaNi() {
+    return {"sha-ni", STREAMS, &iterateShaNi};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#else
+
+namespace authlib {
+namespace detail {
+
+Pbkdf2KernelInfo pbkdf2KernelShaNi() {
+    return {"sha-ni", 0, nullptr};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#endif
@@ -0,0 +1,57 @@
+#include "Pbkdf2Batch.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <emmintrin.h>
+#include "Sha256Lanes.h"
+
+namespace authlib {
+namespace detail {
+
+namespace {
+
+// 4 lanes of 32-bit words; SSE2 is part of the x86-64 baseline
+struct Sse2Vec {
+    static constexpr size_t WIDTH = 4;
+    __m128i v;
+
+    static Sse2Vec set1(uint32_t x) { return {_mm_set1_epi32(static_cast<int>(x))}; }
+    static Sse2Vec load(const uint32_t* p) { return {_mm_load_si128(reinterpret_cast<const __m128i*>(p))}; }
+    static void store(uint32_t* p, Sse2Vec x) { _mm_store_si128(reinterpret_cast<__m128i*>(p), x.v); }
+    static Sse2Vec add(Sse2Vec a, Sse2Vec b) { return {_mm_add_epi32(a.v, b.v)}; }
+    static Sse2Vec xor2(Sse2Vec a, Sse2Vec b) { return {_mm_xor_si128(a.v, b.v)}; }
+    static Sse2Vec xor3(Sse2Vec a, Sse2Vec b, Sse2Vec c) { return {_mm_xor_si128(_mm_xor_si128(a.v, b.v), c.v)}; }
+    static Sse2Vec ch(Sse2Vec e, Sse2Vec f, Sse2Vec g) {
+        return {_mm_xor_si128(g.v, _mm_and_si128(e.v, _mm_xor_si128(f.v, g.v)))};
+    }
+    static Sse2Vec maj(Sse2Vec a, Sse2Vec b, Sse2Vec c) {
+        return {_mm_or_si128(_mm_and_si128(a.v, b.v), _mm_and_si128(c.v, _mm_or_si128(a.v, b.v)))};
+    }
+    template <int N>
+    static Sse2Vec rotr(Sse2Vec x) { return {_mm_or_si128(_mm_srli_epi32(x.v, N), _mm_slli_epi32(x.v, 32 - N))}; }
+    template <int N>
+    static Sse2Vec shr(Sse2Vec x) { return {_mm_srli_epi32(x.v, N)}; }
+};
+
+} // namespace
+
+Pbkdf2KernelInfo pbkdf2KernelSse2() {
+    return {"sse2", Sse2Vec::WIDTH, &sha256lanes::iterateLanes<Sse2Vec>};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#else
+
+namespace authlib {
+namespace detail {
+
+Pbkdf2KernelInfo pbkdf2KernelSse2() {
+    return {"sse2", 0, nullptr};
+}
+
+} // namespace detail
+} // namespace authlib
+
+#endif
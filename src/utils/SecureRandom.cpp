@@ -0,0 +1,186 @@
+#include <authlib/utils/SecureRandom.h>
+#include <openssl/crypto.h>
+#include <openssl/rand.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sys/random.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#endif
+
+// Each thread owns a 4 KiB buffer of OS randomness and hands out slices of
+// it, wiping every byte as it is consumed so a later memory disclosure
+// cannot recover salts or tokens already issued. A fork generation counter
+// (bumped in the child by pthread_atfork) makes a forked child refill
+// rather than replay the parent's buffered bytes.
+
+namespace authlib {
+
+namespace {
+
+constexpr size_t BUFFER_SIZE = 4096;
+// Larger requests bypass the buffer instead of draining it
+constexpr size_t DIRECT_THRESHOLD = 256;
+
+std::atomic<uint64_t> forkGeneration{0};
+
+void readSystemRandom(unsigned char* out, size_t length) {
+#if defined(__linux__)
+    while (length > 0) {
+        ssize_t n = getrandom(out, length, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break; // ENOSYS on old kernels: fall through to OpenSSL
+        }
+        out += n;
+        length -= static_cast<size_t>(n);
+    }
+    if (length == 0) {
+        return;
+    }
+#endif
+    while (length > 0) {
+        int chunk = static_cast<int>(std::min<size_t>(length, 1 << 20));
+        if (RAND_bytes(out, chunk) != 1) {
+            throw std::runtime_error("Secure random generator failed");
+        }
+        out += chunk;
+        length -= static_cast<size_t>(chunk);
+    }
+}
+
+bool registerForkHandler() {
+#if defined(__unix__) || defined(__APPLE__)
+    pthread_atfork(nullptr, nullptr, [] {
+        forkGeneration.fetch_add(1, std::memory_order_relaxed);
+    });
+#endif
+    return true;
+}
+
+struct ThreadBuffer {
+    unsigned char data[BUFFER_SIZE];
+    size_t position = BUFFER_SIZE; // empty until first use
+    uint64_t generation = 0;
+
+    ~ThreadBuffer() {
+        OPENSSL_cleanse(data, sizeof(data));
+    }
+
+    void take(unsigned char* out, size_t length) {
+        uint64_t current = forkGeneration.load(std::memory_order_relaxed);
+        if (generation != current) {
+            OPENSSL_cleanse(data, sizeof(data));
+            position = BUFFER_SIZE;
+            generation = current;
+        }
+
+        while (length > 0) {
+            if (position == BUFFER_SIZE) {
+                readSystemRandom(data, BUFFER_SIZE);
+                position = 0;
+            }
+            size_t n = std::min(length, BUFFER_SIZE - position);
+            std::memcpy(out, data + position, n);
+            OPENSSL_cleanse(data + position, n);
+            position += n;
+            out += n;
+            length -= n;
+        }
+    }
+
+    void release() {
+        OPENSSL_cleanse(data, sizeof(data));
+        position = BUFFER_SIZE;
+    }
+};
+
+ThreadBuffer& threadBuffer() {
+    static const bool forkHandlerRegistered = registerForkHandler();
+    (void)forkHandlerRegistered;
+    thread_local ThreadBuffer buffer;
+    return buffer;
+}
+
+constexpr char TOKEN_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+} // namespace
+
+void SecureRandom::fill(unsigned char* out, size_t length) {
+    if (length >= DIRECT_THRESHOLD) {
+        readSystemRandom(out, length);
+        return;
+    }
+    threadBuffer().take(out, length);
+}
+
+std::string SecureRandom::bytes(size_t length) {
+    std::string out(length, '\0');
+    fill(reinterpret_cast<unsigned char*>(&out[0]), length);
+    return out;
+}
+
+std::string SecureRandom::token(size_t length) {
+    std::string raw = bytes(length);
+    const auto* data = reinterpret_cast<const unsigned char*>(raw.data());
+
+    std::string out;
+    out.reserve((length * 4 + 2) / 3);
+    size_t i = 0;
+    for (; i + 3 <= length; i += 3) {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        out += TOKEN_ALPHABET[(n >> 18) & 63];
+        out += TOKEN_ALPHABET[(n >> 12) & 63];
+        out += TOKEN_ALPHABET[(n >> 6) & 63];
+        out += TOKEN_ALPHABET[n & 63];
+    }
+    if (length - i == 1) {
+        uint32_t n = data[i] << 16;
+        out += TOKEN_ALPHABET[(n >> 18) & 63];
+        out += TOKEN_ALPHABET[(n >> 12) & 63];
+    } else if (length - i == 2) {
+        uint32_t n = (data[i] << 16) | (data[i + 1] << 8);
+        out += TOKEN_ALPHABET[(n >> 18) & 63];
+        out += TOKEN_ALPHABET[(n >> 12) & 63];
+        out += TOKEN_ALPHABET[(n >> 6) & 63];
+    }
+
+    OPENSSL_cleanse(&raw[0], raw.size());
+    return out;
+}
+
+std::string SecureRandom::hex(size_t length) {
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::string raw = bytes(length);
+
+    std::string out;
+    out.reserve(length * 2);
+    for (unsigned char c : raw) {
+        out += DIGITS[c >> 4];
+        out += DIGITS[c & 15];
+    }
+
+    OPENSSL_cleanse(&raw[0], raw.size());
+    return out;
+}
+
+uint64_t SecureRandom::nextU64() {
+    uint64_t value;
+    fill(reinterpret_cast<unsigned char*>(&value), sizeof(value));
+    return value;
+}
+
+void SecureRandom::releaseThreadBuffer() {
+    threadBuffer().release();
+}
+
+} // namespace authlib
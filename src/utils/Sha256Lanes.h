@@ -0,0 +1,180 @@
+/**
+ * Lane-parallel SHA-256 / PBKDF2 iteration core (internal)
+ *
+ * Included by the per-ISA kernel translation units. Each one defines a
+ * vector type V in an anonymous namespace exposing:
+ *   WIDTH, set1, load, store, add, xor2, xor3, ch, maj, rotr<N>, shr<N>
+ * and instantiates iterateLanes<V>. Because V has internal linkage, so does
+ * every instantiation, and code built with -mavx2/-mavx512f never leaks
+ * into callers compiled for the baseline ISA.
+ */
+
+#ifndef AUTHLIB_SHA256_LANES_H
+#define AUTHLIB_SHA256_LANES_H
+
+#include <cstddef>
+#include <cstdint>
+#include "Pbkdf2Batch.h"
+
+namespace authlib {
+namespace detail {
+namespace sha256lanes {
+
+alignas(64) constexpr uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+// Padding words of a second SHA-256 block holding a 32-byte message after
+// a 64-byte key block: 0x80 terminator, zeros, bit length 768.
+constexpr uint32_t PAD_WORD = 0x80000000;
+constexpr uint32_t PAD_LENGTH_BITS = (64 + 32) * 8;
+
+template <typename V>
+inline V bigSigma0(V x) {
+    return V::xor3(V::template rotr<2>(x), V::template rotr<13>(x), V::template rotr<22>(x));
+}
+
+template <typename V>
+inline V bigSigma1(V x) {
+    return V::xor3(V::template rotr<6>(x), V::template rotr<11>(x), V::template rotr<25>(x));
+}
+
+template <typename V>
+inline V smallSigma0(V x) {
+    return V::xor3(V::template rotr<7>(x), V::template rotr<18>(x), V::template shr<3>(x));
+}
+
+template <typename V>
+inline V smallSigma1(V x) {
+    return V::xor3(V::template rotr<17>(x), V::template rotr<19>(x), V::template shr<10>(x));
+}
+
+// One SHA-256 compression of the block `w` (clobbered) into `state`
+template <typename V>
+inline void compress(V state[8], V w[16]) {
+    V a = state[0], b = state[1], c = state[2], d = state[3];
+    V e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; ++i) {
+        if (i >= 16) {
+            w[i & 15] = V::add(
+                V::add(smallSigma1(w[(i - 2) & 15]), w[(i - 7) & 15]),
+                V::add(smallSigma0(w[(i - 15) & 15]), w[i & 15])
+            );
+        }
+        V t1 = V::add(
+            V::add(h, bigSigma1(e)),
+            V::add(V::ch(e, f, g), V::add(V::set1(K[i]), w[i & 15]))
+        );
+        V t2 = V::add(bigSigma0(a), V::maj(a, b, c));
+        h = g;
+        g = f;
+        f = e;
+        e = V::add(d, t1);
+        d = c;
+        c = b;
+        b = a;
+        a = V::add(t1, t2);
+    }
+
+    state[0] = V::add(state[0], a);
+    state[1] = V::add(state[1], b);
+    state[2] = V::add(state[2], c);
+    state[3] = V::add(state[3], d);
+    state[4] = V::add(state[4], e);
+    state[5] = V::add(state[5], f);
+    state[6] = V::add(state[6], g);
+    state[7] = V::add(state[7], h);
+}
+
+// HMAC of a 32-byte message given precomputed key midstates
+template <typename V>
+inline void hmac32(const V inner[8], const V outer[8], V message[8]) {
+    V w[16];
+    V state[8];
+
+    for (int i = 0; i < 8; ++i) {
+        w[i] = message[i];
+        state[i] = inner[i];
+    }
+    w[8] = V::set1(PAD_WORD);
+    for (int i = 9; i < 15; ++i) {
+        w[i] = V::set1(0);
+    }
+    w[15] = V::set1(PAD_LENGTH_BITS);
+    compress(state, w);
+
+    for (int i = 0; i < 8; ++i) {
+        w[i] = state[i];
+        state[i] = outer[i];
+    }
+    w[8] = V::set1(PAD_WORD);
+    for (int i = 9; i < 15; ++i) {
+        w[i] = V::set1(0);
+    }
+    w[15] = V::set1(PAD_LENGTH_BITS);
+    compress(state, w);
+
+    for (int i = 0; i < 8; ++i) {
+        message[i] = state[i];
+    }
+}
+
+template <typename V>
+void iterateLanes(Pbkdf2Lane* lanes, size_t count, uint32_t rounds) {
+    constexpr size_t W = V::WIDTH;
+    alignas(64) uint32_t column[W];
+
+    // Transpose lane-major state into one vector per word. Missing lanes
+    // repeat lane 0 and are discarded afterwards.
+    V inner[8], outer[8], u[8], t[8];
+    for (int word = 0; word < 8; ++word) {
+        for (size_t lane = 0; lane < W; ++lane) {
+            column[lane] = lanes[lane < count ? lane : 0].inner[word];
+        }
+        inner[word] = V::load(column);
+        for (size_t lane = 0; lane < W; ++lane) {
+            column[lane] = lanes[lane < count ? lane : 0].outer[word];
+        }
+        outer[word] = V::load(column);
+        for (size_t lane = 0; lane < W; ++lane) {
+            column[lane] = lanes[lane < count ? lane : 0].u[word];
+        }
+        u[word] = V::load(column);
+        for (size_t lane = 0; lane < W; ++lane) {
+            column[lane] = lanes[lane < count ? lane : 0].t[word];
+        }
+        t[word] = V::load(column);
+    }
+
+    for (uint32_t round = 0; round < rounds; ++round) {
+        hmac32(inner, outer, u);
+        for (int word = 0; word < 8; ++word) {
+            t[word] = V::xor2(t[word], u[word]);
+        }
+    }
+
+    for (int word = 0; word < 8; ++word) {
+        V::store(column, u[word]);
+        for (size_t lane = 0; lane < count; ++lane) {
+            lanes[lane].u[word] = column[lane];
+        }
+        V::store(column, t[word]);
+        for (size_t lane = 0; lane < count; ++lane) {
+            lanes[lane].t[word] = column[lane];
+        }
+    }
+}
+
+} // namespace sha256lanes
+} // namespace detail
+} // namespace authlib
+
+#endif // AUTHLIB_SHA256_LANES_H
@@ -1,52 +1,117 @@
 #include <authlib/utils/Validators.h>
-#include <regex>
+#include <authlib/utils/BreachedPasswordIndex.h>
+#include <authlib/utils/PasswordPolicy.h>
+#include <array>
+#include <cstdint>
 
 namespace authlib {
 
-void EmailValidator::validate(const std::string& email) {
-    if (email.empty()) {
-        throw ValidationError("Email must not be empty");
+namespace {
+
+// Single-pass DFA for the language of the original
+//   [a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,}
+// The domain is accepted when its last '.' has at least one character
+// before it and only letters (two or more) after it, which is exactly the
+// set of splits the regex could choose.
+
+enum CharClass : uint8_t { LETTER, DIGIT, DOT, HYPHEN, LOCAL_ONLY, AT, OTHER, CLASS_COUNT };
+
+enum State : uint8_t {
+    START,
+    LOCAL,       // one or more local-part characters
+    AFTER_AT,    // '@' seen, domain empty
+    DOMAIN,      // domain with no usable TLD yet
+    AFTER_DOT,   // '.' preceded by at least one domain character
+    TLD_ONE,     // one letter after that '.'
+    TLD,         // two or more letters after it: accepting
+    DEAD,
+    STATE_COUNT
+};
+
+constexpr std::array<uint8_t, 256> makeClassTable() {
+    std::array<uint8_t, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        table[c] = OTHER;
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            table[c] = LETTER;
+        } else if (c >= '0' && c <= '9') {
+            table[c] = DIGIT;
+        }
     }
+    table['.'] = DOT;
+    table['-'] = HYPHEN;
+    table['_'] = LOCAL_ONLY;
+    table['%'] = LOCAL_ONLY;
+    table['+'] = LOCAL_ONLY;
+    table['@'] = AT;
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> CHAR_CLASS = makeClassTable();
+
+//                                        LETTER     DIGIT   DOT        HYPHEN  LOCAL_ONLY AT        OTHER
+constexpr uint8_t TRANSITIONS[STATE_COUNT][CLASS_COUNT] = {
+    /* START     */ {LOCAL,     LOCAL,  LOCAL,     LOCAL,  LOCAL,     DEAD,     DEAD},
+    /* LOCAL     */ {LOCAL,     LOCAL,  LOCAL,     LOCAL,  LOCAL,     AFTER_AT, DEAD},
+    /* AFTER_AT  */ {DOMAIN,    DOMAIN, DOMAIN,    DOMAIN, DEAD,      DEAD,     DEAD},
+    /* DOMAIN    */ {DOMAIN,    DOMAIN, AFTER_DOT, DOMAIN, DEAD,      DEAD,     DEAD},
+    /* AFTER_DOT */ {TLD_ONE,   DOMAIN, AFTER_DOT, DOMAIN, DEAD,      DEAD,     DEAD},
+    /* TLD_ONE   */ {TLD,       DOMAIN, AFTER_DOT, DOMAIN, DEAD,      DEAD,     DEAD},
+    /* TLD       */ {TLD,       DOMAIN, AFTER_DOT, DOMAIN, DEAD,      DEAD,     DEAD},
+    /* DEAD      */ {DEAD,      DEAD,   DEAD,      DEAD,   DEAD,      DEAD,     DEAD},
+};
 
-    std::regex emailRegex(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
-    if (!std::regex_match(email, emailRegex)) {
-        throw ValidationError("Invalid email format");
+constexpr size_t MAX_EMAIL_LENGTH = 254;
+
+} // namespace
+
+bool EmailValidator::isValid(const std::string& email) noexcept {
+    if (email.empty() || email.length() > MAX_EMAIL_LENGTH) {
+        return false;
     }
 
-    if (email.length() > 254) {
-        throw ValidationError("Email must not exceed 254 characters");
+    uint8_t state = START;
+    for (char c : email) {
+        state = TRANSITIONS[state][CHAR_CLASS[static_cast<unsigned char>(c)]];
     }
+    return state == TLD;
 }
 
-void PasswordValidator::validate(const std::string& password) {
-    if (password.empty()) {
-        throw ValidationError("Password must not be empty");
+void EmailValidator::validate(const std::string& email) {
+    if (const char* message = problem(email)) {
+        throw ValidationError(message);
     }
+}
 
-    if (password.length() < 8) {
-        throw ValidationError("Password must be at least 8 characters long");
+const char* EmailValidator::problem(const std::string& email) noexcept {
+    if (email.empty()) {
+        return "Email must not be empty";
     }
 
-    if (password.length() > 128) {
-        throw ValidationError("Password must not exceed 128 characters");
+    if (email.length() > MAX_EMAIL_LENGTH) {
+        return "Email must not exceed 254 characters";
     }
 
-    bool hasUpperCase = false;
-    bool hasLowerCase = false;
-    bool hasNumber = false;
-    bool hasSpecialChar = false;
-
-    for (char c : password) {
-        if (std::isupper(c)) hasUpperCase = true;
-        else if (std::islower(c)) hasLowerCase = true;
-        else if (std::isdigit(c)) hasNumber = true;
-        else if (!std::isalnum(c)) hasSpecialChar = true;
+    if (!isValid(email)) {
+        return "Invalid email format";
     }
+    return nullptr;
+}
+
+const PasswordPolicy& PasswordValidator::defaultPolicy() {
+    static const PasswordPolicy policy;
+    return policy;
+}
+
+void PasswordValidator::validate(const std::string& password) {
+    defaultPolicy().validate(password);
+}
+
+void PasswordValidator::validate(const std::string& password, const BreachedPasswordIndex* breached) {
+    validate(password);
 
-    if (!hasUpperCase || !hasLowerCase || !hasNumber || !hasSpecialChar) {
-        throw ValidationError(
-            "Password must contain uppercase, lowercase, number, and special character"
-        );
+    if (breached && breached->contains(password)) {
+        throw ValidationError("Password has appeared in a known data breach; choose a different one");
     }
 }
 
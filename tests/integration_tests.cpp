@@ -1,10 +1,61 @@
 #include <gtest/gtest.h>
-#include <authlib/AuthService.h>
-#include <authlib/UserService.h>
+#include <authlib/services/AuthService.h>
+#include <authlib/services/UserService.h>
 #include <authlib/config/Config.h>
+#include <authlib/config/ConfigStore.h>
 #include <authlib/database/Database.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/observability/Tracing.h>
+#include <authlib/session/SessionStore.h>
+#include <authlib/tenant/TenantRegistry.h>
+#include <authlib/utils/BreachedPasswordIndex.h>
+#include <authlib/utils/EmailCanonicalizer.h>
+#include <authlib/utils/JsonWriter.h>
+#include <authlib/utils/PasswordHandler.h>
+#include <authlib/utils/PasswordHashPool.h>
+#include <authlib/utils/PasswordPolicy.h>
+#include <authlib/utils/Result.h>
+#include <authlib/utils/SecureRandom.h>
+#include <authlib/utils/Validators.h>
+#include <authlib/utils/exceptions.h>
+#include "utils/Pbkdf2Batch.h"
+#ifdef AUTHLIB_WITH_COROUTINES
+#include <authlib/services/AsyncAuthService.h>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#endif
+#ifdef AUTHLIB_WITH_SERVER
+#include <authlib/server/HttpServer.h>
+#include <authlib/sidecar/VerifyClient.h>
+#include <authlib/sidecar/VerifySidecar.h>
+#include <boost/asio/connect.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#endif
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cctype>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <future>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <regex>
+#include <set>
+#include <sstream>
 #include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 using namespace authlib;
 
@@ -19,7 +70,9 @@ protected:
     static Config config;
     
     static void SetUpTestSuite() {
-        // Initialize database for testing
+        // Initialize database for testing, starting from an empty file so
+        // reruns don't collide with users registered last time
+        std::remove("./authlib_test.db");
         db.initialize();
     }
 
@@ -134,6 +187,8 @@ TEST_F(AuthLibIntegrationTest, ShouldGenerateValidJWTTokens) {
     EXPECT_EQ(payload.userId, result.user.id);
     EXPECT_EQ(payload.email, result.user.email);
     EXPECT_EQ(payload.type, "access");
+    EXPECT_FALSE(payload.jti.empty());
+    EXPECT_NE(payload.jti, authService.verifyToken(result.refreshToken).jti);
 }
 
 // ==================== User Login Tests ====================
@@ -200,6 +255,28 @@ TEST_F(AuthLibIntegrationTest, ShouldRejectNonExistentEmail) {
     );
 }
 
+TEST_F(AuthLibIntegrationTest, ShouldUpgradeOutdatedHashOnLogin) {
+    AuthService authService(db, config);
+    UserService userService(db);
+
+    RegisterInput registerInput{
+        "rehash@example.com",
+        "SecurePass123!",
+        "Re",
+        "Hash"
+    };
+    authService.registerUser(registerInput);
+
+    Config stronger = config;
+    stronger.PASSWORD_HASH_ITERATIONS = config.PASSWORD_HASH_ITERATIONS + 1000;
+    AuthService upgradedService(db, stronger);
+
+    upgradedService.login({"rehash@example.com", "SecurePass123!"});
+
+    auto user = userService.getUserByEmail("rehash@example.com");
+    EXPECT_FALSE(PasswordHandler(stronger.PASSWORD_HASH_ITERATIONS).needsRehashing(user.passwordHash));
+}
+
 // ==================== Token Management Tests ====================
 
 TEST_F(AuthLibIntegrationTest, ShouldVerifyValidAccessToken) {
@@ -229,6 +306,29 @@ TEST_F(AuthLibIntegrationTest, ShouldRejectInvalidToken) {
     );
 }
 
+TEST_F(AuthLibIntegrationTest, ShouldAcceptPreviousSecretDuringGraceWindow) {
+    auto store = std::make_shared<ConfigStore>(std::make_shared<const Config>(config));
+    JWTHandler jwtHandler(store);
+    std::string oldToken = jwtHandler.createAccessToken(7, "rotate@example.com");
+
+    auto rotated = std::make_shared<Config>(config);
+    rotated->JWT_SECRET_KEY = config.JWT_SECRET_KEY + "-rotated";
+    store->publish(rotated);
+
+    std::string newToken = jwtHandler.createAccessToken(7, "rotate@example.com");
+    EXPECT_EQ(jwtHandler.verifyToken(oldToken).userId, 7u);
+    EXPECT_EQ(jwtHandler.verifyToken(newToken).userId, 7u);
+
+    // Rotating again without a grace window retires the original key
+    auto retired = std::make_shared<Config>(*rotated);
+    retired->JWT_SECRET_KEY = config.JWT_SECRET_KEY + "-retired";
+    retired->JWT_KEY_ROTATION_GRACE_SECONDS = 0;
+    store->publish(retired);
+
+    EXPECT_THROW(jwtHandler.verifyToken(oldToken), InvalidToken);
+    EXPECT_THROW(jwtHandler.verifyToken(newToken), InvalidToken);
+}
+
 TEST_F(AuthLibIntegrationTest, ShouldRefreshAccessToken) {
     AuthService authService(db, config);
     
@@ -294,6 +394,53 @@ TEST_F(AuthLibIntegrationTest, ShouldLogoutAndBlacklistTokens) {
         authService.refreshAccessToken(registerResult.refreshToken),
         InvalidToken
     );
+
+    // Only a verified access/refresh pair can be revoked
+    auto other = authService.registerUser({"logout2@example.com", "SecurePass123!", "Logout", "Two"});
+    EXPECT_EQ(authService.tryLogout("header.payload.signature", other.refreshToken).code(), ErrorCode::InvalidToken);
+    EXPECT_EQ(authService.tryLogout(other.refreshToken, other.accessToken).code(), ErrorCode::InvalidToken);
+    EXPECT_EQ(authService.tryLogout(registerResult.accessToken, other.refreshToken).code(), ErrorCode::InvalidToken);
+    EXPECT_FALSE(db.isTokenBlacklisted(other.refreshToken));
+}
+
+TEST_F(AuthLibIntegrationTest, ShouldReturnExpectedFailuresWithoutThrowing) {
+    AuthService authService(db, config);
+    auto registered = authService.tryRegisterUser({"result@example.com", "SecurePass123!", "Result", "Test"});
+    ASSERT_TRUE(registered.ok());
+
+    EXPECT_EQ(authService.tryRegisterUser({"result@example.com", "SecurePass123!", "", ""}).code(),
+        ErrorCode::UserAlreadyExists);
+    auto weak = authService.tryRegisterUser({"weak@example.com", "weak", "", ""});
+    EXPECT_EQ(weak.code(), ErrorCode::ValidationError);
+    EXPECT_NE(weak.error().message.find("at least 8 characters"), std::string::npos);
+
+    Metrics::reset();
+    auto wrongPassword = authService.tryLogin({"result@example.com", "WrongPass123!"});
+    ASSERT_FALSE(wrongPassword);
+    EXPECT_EQ(wrongPassword.code(), ErrorCode::InvalidCredentials);
+    EXPECT_EQ(wrongPassword.error().message, "Invalid email or password");
+    EXPECT_EQ(authService.tryLogin({"nobody@example.com", "SecurePass123!"}).code(), ErrorCode::UserNotFound);
+    EXPECT_EQ(authService.tryLogin({"not-an-email", "SecurePass123!"}).code(), ErrorCode::ValidationError);
+    // Returned failures still count as errors in the metrics
+    EXPECT_EQ(Metrics::snapshot(Metric::Login).errors, 3u);
+
+    auto login = authService.tryLogin({"result@example.com", "SecurePass123!"});
+    ASSERT_TRUE(login.ok());
+    EXPECT_EQ(login.value().user.id, registered.value().user.id);
+    EXPECT_EQ(authService.tryVerifyToken(login.value().accessToken).value().userId, registered.value().user.id);
+    EXPECT_EQ(authService.tryVerifyToken("not.a.token").code(), ErrorCode::InvalidToken);
+    EXPECT_EQ(authService.tryVerifyToken("").code(), ErrorCode::InvalidToken);
+    EXPECT_EQ(authService.tryRefreshAccessToken(login.value().accessToken).error().message, "Invalid token type");
+    EXPECT_TRUE(authService.tryRefreshAccessToken(login.value().refreshToken).ok());
+
+    // The throwing API raises the matching exception with the same message
+    try {
+        authService.login({"result@example.com", "WrongPass123!"});
+        FAIL() << "login should have thrown";
+    } catch (const InvalidCredentials& e) {
+        EXPECT_STREQ(e.what(), "Invalid email or password");
+    }
+    EXPECT_THROW(authService.login({"nobody@example.com", "SecurePass123!"}), UserNotFound);
 }
 
 // ==================== User Service Tests ====================
@@ -371,6 +518,25 @@ TEST_F(AuthLibIntegrationTest, ShouldVerifyUser) {
     EXPECT_TRUE(verifiedUser.isVerified);
 }
 
+TEST_F(AuthLibIntegrationTest, ShouldRetrieveUserByCanonicalEmail) {
+    UserService userService(db);
+
+    User created = userService.createUser({"Canonical.Case@Example.COM", "SecurePass123!", "Canonical", "Case"});
+    EXPECT_EQ(created.email, "Canonical.Case@Example.COM");
+    EXPECT_EQ(created.emailCanonical, "canonical.case@example.com");
+    EXPECT_EQ(created.emailHash, EmailCanonicalizer::hash("canonical.case@example.com"));
+
+    auto user = userService.getUserByEmail("canonical.case@example.com");
+    EXPECT_EQ(user.id, created.id);
+    EXPECT_EQ(user.email, "Canonical.Case@Example.COM");
+    EXPECT_EQ(userService.getUserByEmail("CANONICAL.CASE@example.com.").id, created.id);
+
+    EXPECT_THROW(
+        userService.createUser({"canonical.case@EXAMPLE.com", "SecurePass123!", "Canonical", "Case"}),
+        UserAlreadyExists
+    );
+}
+
 // ==================== End-to-End Tests ====================
 
 TEST_F(AuthLibIntegrationTest, ShouldCompleteFullWorkflow) {
@@ -425,6 +591,176 @@ TEST_F(AuthLibIntegrationTest, ShouldLoadConfiguration) {
     EXPECT_FALSE(config.DATABASE_URL.empty());
 }
 
+TEST(ConfigTest, ShouldLayerEnvironmentOverFile) {
+    const std::string path = "./authlib_test_config.json";
+    {
+        std::ofstream file(path);
+        file << R"({"PASSWORD_HASH_ITERATIONS": 600000, "PASSWORD_HASH_POOL_WORKERS": 4, "EMAIL_PROVIDER_RULES": true})";
+    }
+
+    Config fromFile(path);
+    EXPECT_EQ(fromFile.PASSWORD_HASH_ITERATIONS, 600000u);
+    EXPECT_EQ(fromFile.PASSWORD_HASH_POOL_WORKERS, 4u);
+    EXPECT_TRUE(fromFile.EMAIL_PROVIDER_RULES);
+    EXPECT_EQ(fromFile.PASSWORD_MIN_LENGTH, 8u);
+
+#ifndef _WIN32
+    setenv("PASSWORD_HASH_POOL_WORKERS", "2", 1);
+    Config overridden(path);
+    unsetenv("PASSWORD_HASH_POOL_WORKERS");
+    EXPECT_EQ(overridden.PASSWORD_HASH_POOL_WORKERS, 2u);
+    EXPECT_EQ(overridden.PASSWORD_HASH_ITERATIONS, 600000u);
+#endif
+
+    // The dump with secrets loads back to the same settings
+    {
+        std::ofstream file(path);
+        file << fromFile.toJson(true).dump(2);
+    }
+    EXPECT_EQ(Config(path).toJson(true), fromFile.toJson(true));
+    EXPECT_NE(fromFile.toJson().dump().find("<redacted>"), std::string::npos);
+    std::remove(path.c_str());
+}
+
+TEST(ConfigTest, ShouldRejectInvalidValuesWithTheirSource) {
+    const std::string path = "./authlib_test_config.json";
+    auto loadError = [&](const std::string& contents) {
+        {
+            std::ofstream file(path);
+            file << contents;
+        }
+        try {
+            Config config(path);
+        } catch (const ConfigError& e) {
+            return std::string(e.what());
+        }
+        return std::string("loaded");
+    };
+
+    std::string message = loadError(R"({"PASSWORD_HASH_ITERATIONS": 5})");
+    EXPECT_NE(message.find(path), std::string::npos) << message;
+    EXPECT_NE(message.find("PASSWORD_HASH_ITERATIONS=5 is out of range [1000, 10000000]"), std::string::npos) << message;
+
+    message = loadError(R"({"PASSWORD_HASH_ITERATOINS": 600000})");
+    EXPECT_NE(message.find("unknown setting \"PASSWORD_HASH_ITERATOINS\""), std::string::npos) << message;
+
+    message = loadError(R"({"PASSWORD_REQUIRE_DIGIT": "yes"})");
+    EXPECT_NE(message.find("PASSWORD_REQUIRE_DIGIT must be true or false"), std::string::npos) << message;
+
+    message = loadError(R"({"PASSWORD_HASH_ALGORITHM": "md5"})");
+    EXPECT_NE(message.find("must be one of: pbkdf2-sha256, argon2id"), std::string::npos) << message;
+
+    message = loadError(R"({"PASSWORD_MIN_LENGTH": 64, "PASSWORD_MAX_LENGTH": 32})");
+    EXPECT_NE(message.find("exceeds PASSWORD_MAX_LENGTH"), std::string::npos) << message;
+
+    message = loadError("{not json");
+    EXPECT_NE(message.find(path), std::string::npos) << message;
+
+#ifndef _WIN32
+    setenv("JWT_ACCESS_TOKEN_EXPIRY_MINUTES", "15m", 1);
+    message = loadError("{}");
+    unsetenv("JWT_ACCESS_TOKEN_EXPIRY_MINUTES");
+    EXPECT_NE(message.find("environment: JWT_ACCESS_TOKEN_EXPIRY_MINUTES=\"15m\""), std::string::npos) << message;
+#endif
+
+    std::remove(path.c_str());
+}
+
+TEST(ConfigStoreTest, ShouldPublishSnapshotsToRunningReaders) {
+    Config base;
+    base.JWT_SECRET_KEY = "secret-0";
+    base.JWT_ACCESS_TOKEN_EXPIRY_MINUTES = 1;
+    ConfigStore store(std::make_shared<const Config>(base));
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; ++i) {
+        readers.emplace_back([&]() {
+            std::string lastSeen = "secret-0";
+            while (!stop.load()) {
+                auto snapshot = store.snapshot();
+                // Snapshots only move forward, and each one is whole
+                EXPECT_GE(snapshot->JWT_SECRET_KEY.size(), lastSeen.size());
+                EXPECT_EQ(snapshot->JWT_ACCESS_TOKEN_EXPIRY_MINUTES, std::stoul(snapshot->JWT_SECRET_KEY.substr(7)) + 1);
+                lastSeen = snapshot->JWT_SECRET_KEY;
+                reads.fetch_add(1);
+            }
+        });
+    }
+
+    for (uint32_t i = 1; i <= 200; ++i) {
+        auto next = std::make_shared<Config>(base);
+        next->JWT_SECRET_KEY = "secret-" + std::to_string(i * 1000);
+        next->JWT_ACCESS_TOKEN_EXPIRY_MINUTES = i * 1000 + 1;
+        store.publish(next);
+        std::this_thread::yield();
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    auto last = store.snapshot();
+    EXPECT_EQ(last->JWT_SECRET_KEY, "secret-200000");
+    // view() reads the same cached snapshot without taking a reference
+    const long owners = last.use_count();
+    EXPECT_EQ(&store.view(), last.get());
+    EXPECT_EQ(last.use_count(), owners);
+    EXPECT_EQ(last->JWT_PREVIOUS_SECRET_KEY, "secret-199000");
+    EXPECT_GT(last->JWT_PREVIOUS_SECRET_EXPIRES_AT, std::time(nullptr));
+    EXPECT_GT(reads.load(), 0u);
+}
+
+TEST(ConfigStoreTest, ShouldCacheSeveralStoresPerThread) {
+    // One store per tenant: a thread moving between them keeps each cached
+    std::vector<std::unique_ptr<ConfigStore>> stores;
+    std::vector<std::shared_ptr<const Config>> held;
+    for (int i = 0; i < 4; ++i) {
+        Config config;
+        config.JWT_SECRET_KEY = "tenant-" + std::to_string(i);
+        stores.push_back(std::make_unique<ConfigStore>(std::make_shared<const Config>(config)));
+        held.push_back(stores.back()->snapshot());
+    }
+
+    // The store, `held` and this thread's cache
+    for (size_t i = 0; i < stores.size(); ++i) {
+        EXPECT_EQ(held[i].use_count(), 3);
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (size_t i = 0; i < stores.size(); ++i) {
+            EXPECT_EQ(&stores[i]->view(), held[i].get());
+        }
+    }
+    for (size_t i = 0; i < stores.size(); ++i) {
+        EXPECT_EQ(held[i].use_count(), 3) << "store " << i << " fell out of the cache";
+    }
+}
+
+TEST(ConfigStoreTest, ShouldKeepGraceWindowAcrossUnrelatedReloads) {
+    Config base;
+    base.JWT_SECRET_KEY = "first";
+    ConfigStore store(std::make_shared<const Config>(base));
+
+    auto rotated = std::make_shared<Config>(base);
+    rotated->JWT_SECRET_KEY = "second";
+    store.publish(rotated);
+    std::time_t deadline = store.snapshot()->JWT_PREVIOUS_SECRET_EXPIRES_AT;
+    uint64_t version = store.version();
+
+    auto unrelated = std::make_shared<Config>(*rotated);
+    unrelated->JWT_PREVIOUS_SECRET_KEY.clear();
+    unrelated->JWT_PREVIOUS_SECRET_EXPIRES_AT = 0;
+    unrelated->JWT_ACCESS_TOKEN_EXPIRY_MINUTES = 30;
+    store.publish(unrelated);
+
+    auto snapshot = store.snapshot();
+    EXPECT_GT(store.version(), version);
+    EXPECT_EQ(snapshot->JWT_ACCESS_TOKEN_EXPIRY_MINUTES, 30u);
+    EXPECT_EQ(snapshot->JWT_PREVIOUS_SECRET_KEY, "first");
+    EXPECT_EQ(snapshot->JWT_PREVIOUS_SECRET_EXPIRES_AT, deadline);
+}
+
 // ==================== Performance Tests ====================
 
 TEST_F(AuthLibIntegrationTest, ShouldHandleConcurrentRegistrations) {
@@ -455,3 +791,1289 @@ TEST_F(AuthLibIntegrationTest, ShouldHandleConcurrentRegistrations) {
 
     // All threads completed (would verify success count in real scenario)
 }
+
+TEST_F(AuthLibIntegrationTest, ShouldShareOneAuthServiceAcrossThreads) {
+    // Run under -DAUTHLIB_ENABLE_TSAN=ON to check for data races
+    AuthService authService(db, config);
+    constexpr int THREADS = 8;
+    constexpr int ROUNDS = 10;
+
+    std::vector<User> users;
+    for (int i = 0; i < THREADS; ++i) {
+        users.push_back(authService.registerUser({
+            "shared" + std::to_string(i) + "@example.com", "SecurePass123!", "Shared", "User"
+        }).user);
+    }
+
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < THREADS; ++i) {
+        threads.emplace_back([&, i]() {
+            UserService userService(db);
+            for (int round = 0; round < ROUNDS; ++round) {
+                try {
+                    // Every thread also reads and writes its neighbour's row
+                    const User& own = users[i];
+                    const User& other = users[(i + 1) % THREADS];
+                    auto login = authService.login({own.email, "SecurePass123!"});
+                    auto payload = authService.verifyToken(login.accessToken);
+                    if (payload.userId != own.id || login.user.id != own.id || login.user.lastLogin == 0) {
+                        failures.fetch_add(1);
+                    }
+                    if (userService.verifyUser(other.id).id != other.id) {
+                        failures.fetch_add(1);
+                    }
+                } catch (const std::exception& e) {
+                    ADD_FAILURE() << "thread " << i << ": " << e.what();
+                    failures.fetch_add(1);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(failures.load(), 0);
+    UserService userService(db);
+    for (const auto& user : users) {
+        auto stored = userService.getUserById(user.id);
+        EXPECT_TRUE(stored.isVerified);
+        EXPECT_GT(stored.lastLogin, 0);
+    }
+}
+
+#ifdef AUTHLIB_WITH_COROUTINES
+TEST_F(AuthLibIntegrationTest, ShouldKeepLoginsInFlightOnOneEventLoop) {
+    AsyncAuthService asyncAuth(db, config);
+    asyncAuth.blocking().registerUser({"coroutine@example.com", "SecurePass123!", "Coroutine", "User"});
+
+    constexpr int IN_FLIGHT = 64;
+    boost::asio::io_context loop;
+    std::thread::id loopThread;
+    std::atomic<int> completed{0};
+    std::atomic<int> failures{0};
+
+    for (int i = 0; i < IN_FLIGHT; ++i) {
+        boost::asio::co_spawn(loop, [&]() -> boost::asio::awaitable<void> {
+            try {
+                LoginInput input{"coroutine@example.com", "SecurePass123!"};
+                auto response = co_await asyncAuth.loginAsync(std::move(input));
+                // Hashing and SQLite ran on the pools; we must be back on the loop
+                if (std::this_thread::get_id() != loopThread) {
+                    failures.fetch_add(1);
+                }
+                auto payload = co_await asyncAuth.verifyTokenAsync(response.accessToken);
+                if (payload.userId != response.user.id) {
+                    failures.fetch_add(1);
+                }
+            } catch (const std::exception& e) {
+                ADD_FAILURE() << e.what();
+                failures.fetch_add(1);
+            }
+            completed.fetch_add(1);
+        }, boost::asio::detached);
+    }
+    std::thread runner([&]() {
+        loopThread = std::this_thread::get_id();
+        loop.run();
+    });
+    runner.join();
+    EXPECT_EQ(completed.load(), IN_FLIGHT);
+    EXPECT_EQ(failures.load(), 0);
+
+    // Errors surface at the co_await just like the blocking calls
+    bool rejected = false;
+    boost::asio::co_spawn(loop, [&]() -> boost::asio::awaitable<void> {
+        try {
+            LoginInput input{"coroutine@example.com", "WrongPass123!"};
+            co_await asyncAuth.loginAsync(std::move(input));
+        } catch (const InvalidCredentials&) {
+            rejected = true;
+        }
+    }, boost::asio::detached);
+    loop.restart();
+    loop.run();
+    EXPECT_TRUE(rejected);
+
+    // ...or come back as a Result from the try* coroutines, counted as errors
+    const uint64_t loginErrors = Metrics::snapshot(Metric::Login).errors;
+    ErrorCode wrongPassword = ErrorCode::None;
+    ErrorCode unknownUser = ErrorCode::None;
+    ErrorCode revoked = ErrorCode::None;
+    boost::asio::co_spawn(loop, [&]() -> boost::asio::awaitable<void> {
+        LoginInput wrong{"coroutine@example.com", "WrongPass123!"};
+        wrongPassword = (co_await asyncAuth.tryLoginAsync(std::move(wrong))).code();
+        LoginInput unknown{"nobody@example.com", "SecurePass123!"};
+        unknownUser = (co_await asyncAuth.tryLoginAsync(std::move(unknown))).code();
+
+        LoginInput input{"coroutine@example.com", "SecurePass123!"};
+        Result<AuthResponse> login = co_await asyncAuth.tryLoginAsync(std::move(input));
+        if (!login) {
+            ADD_FAILURE() << login.error().message;
+            co_return;
+        }
+        co_await asyncAuth.tryLogoutAsync(login.value().accessToken, login.value().refreshToken);
+        revoked = (co_await asyncAuth.tryRefreshAccessTokenAsync(login.value().refreshToken)).code();
+    }, boost::asio::detached);
+    loop.restart();
+    loop.run();
+    EXPECT_EQ(wrongPassword, ErrorCode::InvalidCredentials);
+    EXPECT_EQ(unknownUser, ErrorCode::UserNotFound);
+    EXPECT_EQ(revoked, ErrorCode::InvalidToken);
+    EXPECT_EQ(Metrics::snapshot(Metric::Login).errors, loginErrors + 2);
+}
+#endif
+
+#ifdef AUTHLIB_WITH_SERVER
+TEST_F(AuthLibIntegrationTest, ShouldServeAuthEndpointsOverKeepAliveHttp) {
+    namespace http = boost::beast::http;
+    using tcp = boost::asio::ip::tcp;
+
+    AuthService authService(db, config);
+    HttpServerOptions options;
+    options.address = "127.0.0.1";
+    options.port = 0;
+    options.threads = 2;
+    HttpServer server(authService, options);
+    server.start();
+    ASSERT_GT(server.port(), 0);
+
+    // One connection for every request, so keep-alive is exercised too
+    boost::asio::io_context context;
+    boost::beast::tcp_stream stream(context);
+    stream.connect(tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), server.port()));
+    boost::beast::flat_buffer buffer;
+    auto send = [&](http::verb method, const char* target, const std::string& body, const std::string& bearer = "") {
+        http::request<http::string_body> request(method, target, 11);
+        request.set(http::field::host, "localhost");
+        if (!bearer.empty()) {
+            request.set(http::field::authorization, "Bearer " + bearer);
+        }
+        request.body() = body;
+        request.prepare_payload();
+        http::write(stream, request);
+        http::response<http::string_body> response;
+        http::read(stream, buffer, response);
+        return response;
+    };
+
+    json registration = {{"email", "http@example.com"}, {"password", "SecurePass123!"}, {"firstName", "Http"}, {"lastName", "User"}};
+    auto registered = send(http::verb::post, "/auth/register", registration.dump());
+    ASSERT_EQ(registered.result(), http::status::created) << registered.body();
+    EXPECT_EQ(send(http::verb::post, "/auth/register", registration.dump()).result(), http::status::conflict);
+
+    auto login = send(http::verb::post, "/auth/login", json{{"email", "http@example.com"}, {"password", "SecurePass123!"}}.dump());
+    ASSERT_EQ(login.result(), http::status::ok) << login.body();
+    json tokens = json::parse(login.body());
+    EXPECT_TRUE(login.keep_alive());
+    EXPECT_EQ(
+        send(http::verb::post, "/auth/login", json{{"email", "http@example.com"}, {"password", "WrongPass123!"}}.dump()).result(),
+        http::status::unauthorized
+    );
+    EXPECT_EQ(
+        send(http::verb::post, "/auth/login", json{{"email", "nobody@example.com"}, {"password", "WrongPass123!"}}.dump()).result(),
+        http::status::unauthorized
+    );
+
+    auto verified = send(http::verb::get, "/auth/verify", "", tokens["accessToken"].get<std::string>());
+    ASSERT_EQ(verified.result(), http::status::ok) << verified.body();
+    EXPECT_EQ(json::parse(verified.body())["email"], "http@example.com");
+    EXPECT_EQ(send(http::verb::get, "/auth/verify", "").result(), http::status::unauthorized);
+
+    auto refreshed = send(http::verb::post, "/auth/refresh", json{{"refreshToken", tokens["refreshToken"]}}.dump());
+    ASSERT_EQ(refreshed.result(), http::status::ok) << refreshed.body();
+    EXPECT_TRUE(json::parse(refreshed.body()).contains("accessToken"));
+
+    EXPECT_EQ(
+        send(http::verb::post, "/auth/logout", json{{"accessToken", "forged.token.value"}, {"refreshToken", tokens["refreshToken"]}}.dump()).result(),
+        http::status::unauthorized
+    );
+    auto loggedOut = send(http::verb::post, "/auth/logout", json{{"accessToken", tokens["accessToken"]}, {"refreshToken", tokens["refreshToken"]}}.dump());
+    ASSERT_EQ(loggedOut.result(), http::status::ok) << loggedOut.body();
+    EXPECT_EQ(json::parse(loggedOut.body())["success"], true);
+    EXPECT_EQ(
+        send(http::verb::post, "/auth/refresh", json{{"refreshToken", tokens["refreshToken"]}}.dump()).result(),
+        http::status::unauthorized
+    );
+
+    EXPECT_EQ(send(http::verb::post, "/auth/login", "not json").result(), http::status::bad_request);
+    EXPECT_EQ(send(http::verb::get, "/auth/login", "").result(), http::status::method_not_allowed);
+    EXPECT_EQ(send(http::verb::get, "/nowhere", "").result(), http::status::not_found);
+
+    server.stop();
+}
+
+TEST_F(AuthLibIntegrationTest, ShouldVerifyBatchedAndPipelinedTokensOverUnixSocket) {
+    auto configStore = std::make_shared<ConfigStore>(std::make_shared<const Config>(config));
+    AuthService authService(db, configStore);
+    auto registered = authService.registerUser({"sidecar@example.com", "SecurePass123!", "Side", "Car"});
+
+    VerifySidecarOptions options;
+    options.socketPath = "./authlib_test_verify.sock";
+    VerifySidecar sidecar(db, configStore, options);
+    sidecar.start();
+
+    sidecar::VerifyClient client(options.socketPath);
+    auto results = client.verify({registered.accessToken, "not.a.token", registered.refreshToken});
+    ASSERT_EQ(results.size(), 3u);
+    EXPECT_EQ(results[0].status, sidecar::VerifyStatus::Valid);
+    EXPECT_EQ(results[0].userId, registered.user.id);
+    EXPECT_EQ(results[0].email, "sidecar@example.com");
+    EXPECT_FALSE(results[0].refresh);
+    EXPECT_EQ(results[1].status, sidecar::VerifyStatus::Invalid);
+    EXPECT_EQ(results[2].status, sidecar::VerifyStatus::Valid);
+    EXPECT_TRUE(results[2].refresh);
+
+    // Pipelined frames come back in order with their ids
+    uint32_t first = client.send({registered.accessToken});
+    uint32_t second = client.send({"garbage", registered.accessToken});
+    auto firstResponse = client.receive();
+    auto secondResponse = client.receive();
+    EXPECT_EQ(firstResponse.id, first);
+    EXPECT_EQ(secondResponse.id, second);
+    ASSERT_EQ(secondResponse.results.size(), 2u);
+    EXPECT_FALSE(secondResponse.results[0].valid());
+    EXPECT_TRUE(secondResponse.results[1].valid());
+
+    // A batch that can't be encoded leaves nothing half-queued
+    EXPECT_THROW(client.send({std::string(0x10000, 'x')}), std::length_error);
+    uint32_t third = client.send({registered.accessToken});
+    EXPECT_EQ(third, second + 1);
+    EXPECT_EQ(client.receive().id, third);
+
+    // Far more than a socket buffer in each direction before the first
+    // receive(): the client reads responses while it is still writing
+    std::vector<std::string> garbage(sidecar::MAX_TOKENS_PER_FRAME, "x");
+    garbage.back() = registered.accessToken;
+    std::vector<uint32_t> ids;
+    for (int i = 0; i < 64; ++i) {
+        ids.push_back(client.send(garbage));
+    }
+    for (uint32_t id : ids) {
+        auto response = client.receive();
+        EXPECT_EQ(response.id, id);
+        ASSERT_EQ(response.results.size(), garbage.size());
+        EXPECT_FALSE(response.results.front().valid());
+        EXPECT_TRUE(response.results.back().valid());
+    }
+
+    auto other = authService.registerUser({"sidecar2@example.com", "SecurePass123!", "Side", "Car"});
+    authService.logout(other.accessToken, other.refreshToken);
+    EXPECT_EQ(client.verify(other.accessToken).status, sidecar::VerifyStatus::Revoked);
+    EXPECT_EQ(client.verify(other.refreshToken).status, sidecar::VerifyStatus::Revoked);
+
+    sidecar.stop();
+
+    // A path that names an ordinary file is refused, not deleted
+    VerifySidecarOptions misconfigured;
+    misconfigured.socketPath = "./authlib_test_verify.txt";
+    std::FILE* file = std::fopen(misconfigured.socketPath.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    std::fputs("keep me", file);
+    std::fclose(file);
+    VerifySidecar refused(db, configStore, misconfigured);
+    EXPECT_THROW(refused.start(), ConfigError);
+    file = std::fopen(misconfigured.socketPath.c_str(), "r");
+    EXPECT_NE(file, nullptr);
+    if (file) {
+        std::fclose(file);
+    }
+    std::remove(misconfigured.socketPath.c_str());
+}
+#endif
+
+// ==================== Database Sharding Tests ====================
+
+namespace {
+
+void removeShardFiles(const std::string& base, uint32_t shards) {
+    for (uint32_t i = 0; i < shards; ++i) {
+        std::string path = shards == 1 ? base + ".db" : base + ".shard" + std::to_string(i) + ".db";
+        for (const char* suffix : {"", "-wal", "-shm"}) {
+            std::remove((path + suffix).c_str());
+        }
+    }
+}
+
+User shardTestUser(int i) {
+    User user;
+    user.email = "Shard" + std::to_string(i) + "@Example.com";
+    user.passwordHash = "hash";
+    user.firstName = "Shard";
+    return user;
+}
+
+} // namespace
+
+TEST(ShardedDatabaseTest, ShouldRouteRowsAndReshardWithoutChangingIds) {
+    removeShardFiles("./authlib_shard4", 4);
+    removeShardFiles("./authlib_shard2", 2);
+    removeShardFiles("./authlib_unsharded", 1);
+    removeShardFiles("./authlib_shard3", 3);
+
+    std::vector<User> users;
+    {
+        Database sharded("sqlite:///./authlib_shard4.db", 5000, 4);
+        sharded.initialize();
+        EXPECT_EQ(sharded.shardCount(), 4u);
+        std::set<uint32_t> ids;
+        std::set<uint32_t> shardsUsed;
+        for (int i = 0; i < 64; ++i) {
+            users.push_back(sharded.insertUser(shardTestUser(i)));
+            ids.insert(users.back().id);
+            shardsUsed.insert((users.back().id & 0xff) % 4);
+        }
+        EXPECT_EQ(ids.size(), users.size());
+        EXPECT_EQ(shardsUsed.size(), 4u);
+        EXPECT_THROW(sharded.insertUser(shardTestUser(5)), UserAlreadyExists);
+
+        for (const auto& user : users) {
+            EXPECT_EQ(sharded.findUserById(user.id).email, user.email);
+            EXPECT_EQ(sharded.findUserByEmail(user.emailCanonical).id, user.id);
+        }
+        sharded.updateLastLogin(users[3].id, 1700000000);
+        EXPECT_EQ(sharded.findUserById(users[3].id).lastLogin, 1700000000);
+        EXPECT_THROW(sharded.findUserById(users.back().id + 0x100 * 1000), UserNotFound);
+
+        TokenBlacklist revoked;
+        revoked.token = "header.payload.signature";
+        revoked.userId = users[0].id;
+        revoked.expiresAt = std::time(nullptr) + 3600;
+        sharded.blacklistToken(revoked);
+        sharded.blacklistToken(revoked);
+        EXPECT_TRUE(sharded.isTokenBlacklisted(revoked.token));
+        EXPECT_FALSE(sharded.isTokenBlacklisted("header.payload.other"));
+        sharded.cleanExpiredTokens();
+        EXPECT_TRUE(sharded.isTokenBlacklisted(revoked.token));
+    }
+
+    // 4 -> 2 shards keeps every id, revocation and login time
+    EXPECT_EQ(Database::reshard("sqlite:///./authlib_shard4.db", 4, "sqlite:///./authlib_shard2.db", 2), users.size());
+    {
+        Database resharded("sqlite:///./authlib_shard2.db", 5000, 2);
+        resharded.initialize();
+        for (const auto& user : users) {
+            EXPECT_EQ(resharded.findUserByEmail(user.emailCanonical).id, user.id);
+        }
+        EXPECT_EQ(resharded.findUserById(users[3].id).lastLogin, 1700000000);
+        EXPECT_TRUE(resharded.isTokenBlacklisted("header.payload.signature"));
+        User added = resharded.insertUser(shardTestUser(1000));
+        EXPECT_EQ(resharded.findUserById(added.id).email, added.email);
+    }
+    EXPECT_THROW(
+        Database::reshard("sqlite:///./authlib_shard4.db", 4, "sqlite:///./authlib_shard2.db", 2),
+        DatabaseError);
+
+    // An unsharded database renumbers on the way in, taking revocations
+    // and sessions along to the new ids
+    const std::time_t now = std::time(nullptr);
+    {
+        Database plain("sqlite:///./authlib_unsharded.db");
+        plain.initialize();
+        std::vector<Session> sessions;
+        for (int i = 0; i < 10; ++i) {
+            User user = plain.insertUser(shardTestUser(i));
+            Session session;
+            session.id = std::string(32, static_cast<char>('a' + i));
+            session.userId = user.id;
+            session.createdAt = now;
+            session.expiresAt = now + 3600;
+            sessions.push_back(session);
+        }
+        plain.saveSessions(sessions);
+        TokenBlacklist revoked;
+        revoked.token = "header.payload.renumbered";
+        revoked.userId = 4;
+        revoked.expiresAt = now + 3600;
+        plain.blacklistToken(revoked);
+    }
+    std::ostringstream idMap;
+    EXPECT_EQ(Database::reshard("sqlite:///./authlib_unsharded.db", 1, "sqlite:///./authlib_shard3.db", 3, &idMap), 10u);
+    Database renumbered("sqlite:///./authlib_shard3.db", 5000, 3);
+    renumbered.initialize();
+    std::istringstream lines(idMap.str());
+    uint32_t oldId, newId;
+    int mapped = 0;
+    std::map<uint32_t, uint32_t> newIds;
+    while (lines >> oldId >> newId) {
+        EXPECT_EQ(renumbered.findUserById(newId).email, shardTestUser(static_cast<int>(oldId) - 1).email);
+        newIds[oldId] = newId;
+        ++mapped;
+    }
+    EXPECT_EQ(mapped, 10);
+    std::vector<Session> moved = renumbered.loadSessions(now);
+    ASSERT_EQ(moved.size(), 10u);
+    for (const auto& session : moved) {
+        // Session i belonged to old id i + 1
+        const uint32_t oldOwner = static_cast<uint32_t>(session.id[0] - 'a') + 1;
+        EXPECT_EQ(session.userId, newIds[oldOwner]);
+    }
+    EXPECT_TRUE(renumbered.isTokenBlacklisted("header.payload.renumbered"));
+
+    removeShardFiles("./authlib_shard4", 4);
+    removeShardFiles("./authlib_shard2", 2);
+    removeShardFiles("./authlib_unsharded", 1);
+    removeShardFiles("./authlib_shard3", 3);
+}
+
+// ==================== Database Profiling Tests ====================
+
+TEST(DatabaseProfilingTest, ShouldProfileStatementsAndFlagFullScans) {
+    std::vector<std::string> logged;
+    DatabaseProfileOptions options;
+    options.enabled = true;
+    options.log = [&logged](const std::string& line) { logged.push_back(line); };
+
+    Database database("sqlite:///:memory:");
+    database.setProfiling(options);
+    database.initialize();
+    // The shipped schema keeps every request-path statement on a key or index
+    EXPECT_TRUE(logged.empty());
+    EXPECT_TRUE(database.checkQueryPlans().empty());
+    EXPECT_THROW(database.setProfiling(options), DatabaseError);
+
+    User user = database.insertUser(shardTestUser(1));
+    for (int i = 0; i < 3; ++i) {
+        database.findUserById(user.id);
+    }
+    EXPECT_THROW(database.findUserById(user.id + 1), UserNotFound);
+    EXPECT_FALSE(database.isTokenBlacklisted("never-revoked"));
+
+    std::vector<StatementProfile> profiles = database.statementProfiles();
+    auto find = [&profiles](const std::string& prefix, const std::string& part) -> const StatementProfile* {
+        for (const auto& profile : profiles) {
+            if (profile.sql.compare(0, prefix.size(), prefix) == 0 && profile.sql.find(part) != std::string::npos) {
+                return &profile;
+            }
+        }
+        return nullptr;
+    };
+    const StatementProfile* byId = find("SELECT", "FROM users WHERE id = ?");
+    ASSERT_NE(byId, nullptr);
+    EXPECT_EQ(byId->latency.count, 4u);
+    EXPECT_EQ(byId->rowsReturned, 3u);
+    EXPECT_EQ(byId->fullScanSteps, 0u);
+    EXPECT_GT(byId->vmSteps, 0u);
+    EXPECT_GT(byId->latency.percentile(0.5), 0u);
+    const StatementProfile* revoked = find("SELECT 1", "token_blacklist");
+    ASSERT_NE(revoked, nullptr);
+    EXPECT_EQ(revoked->latency.count, 1u);
+    EXPECT_EQ(revoked->rowsReturned, 0u);
+    for (size_t i = 1; i < profiles.size(); ++i) {
+        EXPECT_GE(profiles[i - 1].latency.sumNanos, profiles[i].latency.sumNanos);
+    }
+
+    std::vector<std::string> scans = database.checkQueryPlans({
+        "SELECT id FROM users WHERE first_name = ?",
+        "SELECT id FROM users WHERE email_canonical = ?",
+    });
+    ASSERT_EQ(scans.size(), 1u);
+    EXPECT_NE(scans[0].find("SCAN users"), std::string::npos);
+    EXPECT_NE(scans[0].find("first_name"), std::string::npos);
+
+    // Profiling off: nothing collected
+    Database plain("sqlite:///:memory:");
+    plain.initialize();
+    plain.insertUser(shardTestUser(2));
+    EXPECT_TRUE(plain.statementProfiles().empty());
+}
+
+// ==================== Session Tests ====================
+
+TEST_F(AuthLibIntegrationTest, ShouldExpireAndPersistOpaqueSessions) {
+    std::time_t clock = 1700000000;
+    SessionStoreOptions options;
+    options.shards = 8;
+    options.ttlSeconds = 3600;
+    options.sweepIntervalMs = 0;
+    options.persist = true;
+    options.clock = [&clock]() { return clock; };
+
+    std::string shortLived;
+    std::string revoked;
+    std::string touched;
+    {
+        SessionStore store(options, &db);
+        std::string id = store.create(7, "device=a");
+        EXPECT_EQ(id.size(), 43u);
+        EXPECT_NE(store.create(7), id);
+
+        Session session;
+        ASSERT_TRUE(store.validate(id, &session));
+        EXPECT_EQ(session.userId, 7u);
+        EXPECT_EQ(session.metadata, "device=a");
+        EXPECT_EQ(session.expiresAt, clock + 3600);
+        EXPECT_FALSE(store.validate(id.substr(1)));
+        EXPECT_FALSE(store.validate(std::string(43, '!')));
+
+        shortLived = store.create(8, "", 10);
+        revoked = store.create(8);
+        touched = store.create(9);
+        EXPECT_TRUE(store.revoke(revoked));
+        EXPECT_FALSE(store.revoke(revoked));
+        EXPECT_FALSE(store.validate(revoked));
+
+        clock += 9;
+        EXPECT_TRUE(store.validate(shortLived));
+        clock += 1;
+        EXPECT_FALSE(store.validate(shortLived)); // refused before any sweep
+        EXPECT_EQ(store.expire(), 1u);
+        EXPECT_EQ(store.size(), 3u);
+
+        // Crossing into the second wheel level and back out
+        clock += 3000;
+        EXPECT_TRUE(store.touch(touched));
+        clock += 590;
+        EXPECT_EQ(store.expire(), 2u); // user 7's two sessions, created at the start
+        EXPECT_TRUE(store.validate(touched));
+        EXPECT_EQ(store.revokeUser(9), 1u);
+        touched = store.create(9);
+        store.flush();
+    }
+
+    // Write-behind: a new store picks the survivors up from the database
+    SessionStore reloaded(options, &db);
+    EXPECT_EQ(reloaded.restore(), 1u);
+    EXPECT_TRUE(reloaded.validate(touched));
+    EXPECT_FALSE(reloaded.validate(revoked));
+    clock += 3600;
+    EXPECT_EQ(reloaded.expire(), 1u);
+    EXPECT_EQ(reloaded.size(), 0u);
+    reloaded.flush();
+    EXPECT_TRUE(db.loadSessions(0).empty());
+}
+
+TEST_F(AuthLibIntegrationTest, ShouldKeepRevokedSessionsGoneWhenFlushingBesideTheSweeper) {
+    SessionStoreOptions options;
+    options.sweepIntervalMs = 1;
+    options.persist = true;
+
+    // Callers revoke and flush while the sweeper and each other flush too:
+    // an older snapshot written late must not bring a session back
+    {
+        SessionStore store(options, &db);
+        auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+        std::vector<std::thread> callers;
+        for (int t = 0; t < 4; ++t) {
+            callers.emplace_back([&store, until]() {
+                std::vector<std::string> ids;
+                while (std::chrono::steady_clock::now() < until) {
+                    ids.clear();
+                    for (int i = 0; i < 16; ++i) {
+                        ids.push_back(store.create(11));
+                    }
+                    for (const auto& id : ids) {
+                        store.revoke(id);
+                    }
+                    store.flush();
+                }
+            });
+        }
+        for (auto& caller : callers) {
+            caller.join();
+        }
+    }
+    for (const Session& session : db.loadSessions(0)) {
+        ADD_FAILURE() << "session of user " << session.userId << " survived its revocation";
+    }
+}
+
+// ==================== Tenant Tests ====================
+
+TEST(TenantRegistryTest, ShouldIsolateTenantsAndBoundOpenStores) {
+    const std::vector<std::string> names = {"acme", "globex", "initech", "ghost"};
+    auto removeTenantFiles = [&names]() {
+        for (const auto& name : names) {
+            for (const char* suffix : {"", "-wal", "-shm"}) {
+                std::remove(("./authlib_tenant_" + name + ".db" + suffix).c_str());
+            }
+        }
+    };
+    removeTenantFiles();
+
+    auto base = std::make_shared<Config>();
+    base->DATABASE_URL = "sqlite:///./authlib_tenant_{tenant}.db";
+    EXPECT_THROW(TenantRegistry::templateResolver(std::make_shared<Config>()), ConfigError);
+
+    TenantRegistryOptions options;
+    options.maxOpenTenants = 2;
+    options.idleSeconds = 0;
+    TenantRegistry registry(TenantRegistry::templateResolver(base), options);
+
+    std::shared_ptr<Tenant> acme = registry.get("acme");
+    EXPECT_EQ(registry.get("acme"), acme);
+    auto acmeLogin = acme->auth().registerUser({"same@example.com", "SecurePass123!", "Acme", "User"});
+    TokenPayload payload = registry.verifyToken(acmeLogin.accessToken);
+    EXPECT_EQ(payload.tenantId, "acme");
+    EXPECT_EQ(payload.userId, acmeLogin.user.id);
+
+    // Same email, separate store; each tenant's key only verifies its own tokens
+    std::shared_ptr<Tenant> globex = registry.get("globex");
+    auto globexLogin = globex->auth().registerUser({"same@example.com", "SecurePass123!", "Globex", "User"});
+    EXPECT_EQ(registry.verifyToken(globexLogin.accessToken).tenantId, "globex");
+    EXPECT_THROW(globex->verifyToken(acmeLogin.accessToken), InvalidToken);
+    EXPECT_THROW(acme->auth().verifyToken(globexLogin.accessToken), InvalidToken);
+
+    EXPECT_THROW(registry.get("../etc"), TenantNotFound);
+    EXPECT_EQ(registry.openCount(), 2u);
+
+    // Checking a token against a tenant never opens (or creates) its database
+    EXPECT_THROW(registry.get("ghost")->verifyToken(acmeLogin.accessToken), InvalidToken);
+    EXPECT_FALSE(std::ifstream("./authlib_tenant_ghost.db").good());
+
+    // ghost pushed acme out; the handle we hold still works, and reopening finds its users
+    EXPECT_EQ(registry.openCount(), 2u);
+    EXPECT_EQ(acme->database().findUserById(acmeLogin.user.id).firstName, "Acme");
+    std::shared_ptr<Tenant> reopened = registry.get("acme");
+    EXPECT_NE(reopened, acme);
+    EXPECT_EQ(reopened->auth().login({"same@example.com", "SecurePass123!"}).user.id, acmeLogin.user.id);
+
+    // Racing first requests share one open
+    std::vector<std::shared_ptr<Tenant>> seen(8);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < seen.size(); ++i) {
+        threads.emplace_back([&, i]() { seen[i] = registry.get("initech"); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const auto& tenant : seen) {
+        EXPECT_EQ(tenant, seen[0]);
+    }
+
+    // Forged tenant ids are rejected before they take a slot in the LRU
+    auto forgedConfig = std::make_shared<Config>();
+    forgedConfig->JWT_SECRET_KEY = "not-the-master-key";
+    for (const char* forgedId : {"forged-1", "forged-2", "forged-3"}) {
+        JWTHandler forger(std::make_shared<ConfigStore>(forgedConfig), forgedId);
+        EXPECT_THROW(registry.verifyToken(forger.createAccessToken(1, "x@example.com")), InvalidToken);
+    }
+    EXPECT_EQ(registry.openCount(), 2u);
+    EXPECT_EQ(registry.get("initech"), seen[0]);
+
+    acme.reset();
+    globex.reset();
+    reopened.reset();
+    seen.clear();
+    removeTenantFiles();
+}
+
+// ==================== Metrics Tests ====================
+
+TEST(MetricsTest, ShouldBucketWithinOneEighth) {
+    for (uint64_t value : std::vector<uint64_t>{0, 7, 8, 15, 16, 1000, 123456789, Metrics::MAX_NANOS}) {
+        size_t bucket = Metrics::bucketFor(value);
+        ASSERT_LT(bucket, Metrics::BUCKETS);
+        EXPECT_LE(Metrics::bucketLower(bucket), value);
+        if (bucket + 1 < Metrics::BUCKETS) {
+            EXPECT_GT(Metrics::bucketLower(bucket + 1), value);
+            EXPECT_LE(Metrics::bucketLower(bucket + 1) - Metrics::bucketLower(bucket), std::max<uint64_t>(1, value / 8));
+        }
+    }
+    EXPECT_EQ(Metrics::bucketFor(Metrics::MAX_NANOS * 2), Metrics::BUCKETS - 1);
+}
+
+TEST_F(AuthLibIntegrationTest, ShouldRecordOperationPhasesAndExportPrometheus) {
+    Metrics::reset();
+
+    // 1us..1000us from a thread that exits before the scrape
+    std::thread([]() {
+        for (uint64_t us = 1; us <= 1000; ++us) {
+            Metrics::record(Metric::Sign, us * 1000);
+        }
+    }).join();
+    MetricSnapshot sign = Metrics::snapshot(Metric::Sign);
+    EXPECT_EQ(sign.count, 1000u);
+    EXPECT_EQ(sign.sumNanos, 500500u * 1000);
+    EXPECT_NEAR(static_cast<double>(sign.percentile(0.5)), 500000.0, 500000.0 / 16);
+    EXPECT_NEAR(static_cast<double>(sign.percentile(0.99)), 990000.0, 990000.0 / 16);
+
+    Metrics::reset();
+    AuthService authService(db, config);
+    authService.registerUser({"metrics@example.com", "SecurePass123!", "Metric", "User"});
+    authService.login({"metrics@example.com", "SecurePass123!"});
+    EXPECT_THROW(authService.login({"metrics@example.com", "WrongPass123!"}), InvalidCredentials);
+
+    MetricSnapshot login = Metrics::snapshot(Metric::Login);
+    EXPECT_EQ(login.count, 2u);
+    EXPECT_EQ(login.errors, 1u);
+    EXPECT_EQ(Metrics::snapshot(Metric::Register).count, 1u);
+    EXPECT_EQ(Metrics::snapshot(Metric::Hash).count, 1u);
+    EXPECT_EQ(Metrics::snapshot(Metric::HashVerify).count, 2u);
+    EXPECT_EQ(Metrics::snapshot(Metric::Validate).count, 3u);
+    EXPECT_GE(Metrics::snapshot(Metric::DbWrite).count, 2u);
+    // Registration's "is this email free" check, then each login's read and
+    // the successful one's reload; the registration miss is not an error
+    MetricSnapshot lookup = Metrics::snapshot(Metric::Lookup);
+    EXPECT_EQ(lookup.count, 4u);
+    EXPECT_EQ(lookup.errors, 0u);
+    // Phases fit inside their operation
+    EXPECT_LE(Metrics::snapshot(Metric::HashVerify).sumNanos, login.sumNanos);
+
+    std::string text = Metrics::prometheus();
+    EXPECT_NE(text.find("# TYPE authlib_operation_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("authlib_operation_duration_seconds_bucket{op=\"login\",le=\"+Inf\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("authlib_operation_duration_seconds_count{op=\"hash_verify\"} 2\n"), std::string::npos);
+    EXPECT_NE(text.find("authlib_operation_errors_total{op=\"login\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("le=\"1.024e-06\""), std::string::npos);
+
+    constexpr int ROUNDS = 100000;
+    for (int i = 0; i < ROUNDS; ++i) {
+        Metrics::record(Metric::Verify, static_cast<uint64_t>(i) & 0xfffff);
+    }
+    EXPECT_EQ(Metrics::snapshot(Metric::Verify).count, static_cast<uint64_t>(ROUNDS));
+
+    // Scrapes racing a recording thread stay valid histograms: cumulative
+    // buckets never decrease, and +Inf (the last) equals _count
+    std::atomic<bool> recording{true};
+    std::thread recorder([&recording]() {
+        for (uint64_t i = 0; recording.load(std::memory_order_relaxed); ++i) {
+            Metrics::record(Metric::Sign, i & 0xfffff);
+        }
+    });
+    for (int scrape = 0; scrape < 200; ++scrape) {
+        std::istringstream lines(Metrics::prometheus());
+        uint64_t previous = 0;
+        for (std::string line; std::getline(lines, line);) {
+            if (line.rfind("authlib_operation_duration_seconds_bucket{op=\"sign\"", 0) == 0) {
+                uint64_t value = std::stoull(line.substr(line.rfind(' ') + 1));
+                EXPECT_GE(value, previous) << line;
+                previous = value;
+            } else if (line.rfind("authlib_operation_duration_seconds_count{op=\"sign\"}", 0) == 0) {
+                EXPECT_EQ(std::stoull(line.substr(line.rfind(' ') + 1)), previous) << line;
+            }
+        }
+    }
+    recording = false;
+    recorder.join();
+}
+
+// ==================== Tracing Tests ====================
+
+namespace {
+
+class CollectingSink : public TraceSink {
+public:
+    std::mutex mutex;
+    std::vector<TraceEvent> events;
+
+    void record(const TraceEvent& event) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        events.push_back(event);
+    }
+};
+
+} // namespace
+
+TEST_F(AuthLibIntegrationTest, ShouldTraceLoginPhasesWithRequestContext) {
+    if (!Tracing::compiledIn()) {
+        GTEST_SKIP() << "Built with AUTHLIB_ENABLE_TRACING=OFF";
+    }
+    AuthService authService(db, config);
+    authService.registerUser({"traced@example.com", "SecurePass123!", "Traced", "User"});
+
+    auto sink = std::make_shared<CollectingSink>();
+    Tracing::setSink(sink);
+    {
+        TraceContext context(4242);
+        authService.login({"traced@example.com", "SecurePass123!"});
+    }
+    EXPECT_THROW(authService.login({"traced@example.com", "WrongPass123!"}), InvalidCredentials);
+    Tracing::setSink(nullptr);
+    authService.login({"traced@example.com", "SecurePass123!"});
+
+    // Phases in order, each inside the request, then the request itself
+    std::vector<std::string> names;
+    for (const auto& event : sink->events) {
+        if (event.traceId == 4242) {
+            names.push_back(event.name);
+        }
+    }
+    EXPECT_EQ(names, (std::vector<std::string>{
+        "validate", "lookup_user", "verify_password", "update_last_login", "issue_tokens", "login"
+    }));
+    const TraceEvent& request = sink->events[names.size() - 1];
+    EXPECT_STREQ(request.request, "login");
+    EXPECT_FALSE(request.error);
+    uint64_t phaseTotal = 0;
+    for (size_t i = 0; i + 1 < names.size(); ++i) {
+        const TraceEvent& phase = sink->events[i];
+        EXPECT_STREQ(phase.request, "login");
+        EXPECT_GE(phase.startNanos, request.startNanos);
+        EXPECT_LE(phase.startNanos + phase.durationNanos, request.startNanos + request.durationNanos);
+        phaseTotal += phase.durationNanos;
+    }
+    EXPECT_LE(phaseTotal, request.durationNanos);
+
+    // The failed login got its own id and stops at the phase that threw
+    ASSERT_EQ(sink->events.size(), names.size() + 4);
+    const TraceEvent& failedPhase = sink->events[names.size() + 2];
+    const TraceEvent& failed = sink->events[names.size() + 3];
+    EXPECT_STREQ(failedPhase.name, "verify_password");
+    EXPECT_TRUE(failedPhase.error);
+    EXPECT_TRUE(failed.error);
+    EXPECT_NE(failed.traceId, 4242u);
+    EXPECT_EQ(failedPhase.traceId, failed.traceId);
+
+    const std::string path = "./authlib_test_trace.json";
+    {
+        ChromeTraceWriter writer(path);
+        for (const auto& event : sink->events) {
+            writer.record(event);
+        }
+    }
+    std::ifstream in(path);
+    json trace = json::parse(in);
+    ASSERT_EQ(trace.size(), sink->events.size());
+    EXPECT_EQ(trace[0]["ph"], "X");
+    EXPECT_EQ(trace[0]["name"], "validate");
+    EXPECT_EQ(trace[0]["cat"], "login");
+    EXPECT_EQ(trace[0]["args"]["trace"], 4242);
+    EXPECT_TRUE(trace.back()["args"]["error"].get<bool>());
+    std::remove(path.c_str());
+}
+
+// ==================== Serialization Tests ====================
+
+TEST(JsonWriterTest, ShouldMatchJsonTreeOutput) {
+    User user;
+    user.id = 42;
+    user.email = "quote\"back\\slash@example.com";
+    user.firstName = "Tab\tNew\nline\x01";
+    user.lastName = "Zo\xc3\xab"; // UTF-8 passes through
+    user.lastLogin = 1700000000;
+    AuthResponse response{true, user, "access.token.value", "refresh.token.value"};
+
+    std::string out = "prefix:";
+    response.appendJson(out);
+    ASSERT_EQ(out.compare(0, 7, "prefix:"), 0);
+    EXPECT_EQ(json::parse(out.substr(7)), response.toJson());
+
+    std::string nested;
+    JsonWriter writer(nested);
+    writer.beginObject().key("list").beginArray().number(int64_t(-1)).null().boolean(false);
+    user.writeJson(writer);
+    writer.endArray().key("empty").string("").endObject();
+    json parsed = json::parse(nested);
+    EXPECT_EQ(parsed["list"][0], -1);
+    EXPECT_TRUE(parsed["list"][1].is_null());
+    EXPECT_EQ(parsed["list"][3], user.toJson());
+    EXPECT_EQ(parsed["empty"], "");
+}
+
+// ==================== Validator Tests ====================
+
+TEST(EmailValidatorTest, ShouldMatchReferenceRegex) {
+    // The regex EmailValidator used before the DFA; both must accept the
+    // same language
+    const std::regex reference(R"([a-zA-Z0-9._%+-]+@[a-zA-Z0-9.-]+\.[a-zA-Z]{2,})");
+    const std::string alphabet = "aZ09._%+-@@..-x!\x80 ";
+
+    for (const char* email : {
+        "user@example.com", "a.b+c_d%e-f@sub.example.co", "a@b.cc", "a@.b.cc",
+        "a@b..cc", "a@b.c", "a@b.c1", "a@b-.cc", "@b.cc", "a@@b.cc", "a@b.cc.",
+        "a@bcc", "a@.cc", "a b@c.dd", "a@b.cc\n"
+    }) {
+        EXPECT_EQ(EmailValidator::isValid(email), std::regex_match(email, reference)) << email;
+    }
+
+    // Random mutations of a valid address keep roughly half the inputs near
+    // the accept boundary; fully random strings cover the rest
+    std::mt19937 rng(1234);
+    int accepted = 0;
+    for (int i = 0; i < 20000; ++i) {
+        std::string email;
+        if (i % 2 == 0) {
+            email = "ab.c+d@ex-1.sub.com";
+            for (int m = rng() % 3; m >= 0; --m) {
+                size_t at = rng() % (email.size() + 1);
+                char c = alphabet[rng() % alphabet.size()];
+                switch (rng() % 3) {
+                    case 0: email.insert(at, 1, c); break;
+                    case 1: if (at < email.size()) email[at] = c; break;
+                    default: if (at < email.size()) email.erase(at, 1); break;
+                }
+            }
+        } else {
+            email.assign(1 + rng() % 12, 'a');
+            for (auto& c : email) {
+                c = alphabet[rng() % alphabet.size()];
+            }
+        }
+        bool expected = std::regex_match(email, reference);
+        accepted += expected;
+        ASSERT_EQ(EmailValidator::isValid(email), expected) << email;
+    }
+    EXPECT_GT(accepted, 1000);
+
+    EXPECT_FALSE(EmailValidator::isValid(std::string(250, 'a') + "@b.cc"));
+    EXPECT_THROW(EmailValidator::validate(std::string(250, 'a') + "@b.cc"), ValidationError);
+    EXPECT_THROW(EmailValidator::validate(""), ValidationError);
+    EXPECT_NO_THROW(EmailValidator::validate("user@example.com"));
+}
+
+TEST(EmailCanonicalizerTest, ShouldApplyProviderRulesOnlyWhenEnabled) {
+    EmailCanonicalizer plain;
+    EXPECT_EQ(plain.canonicalize("First.Last+news@GoogleMail.com"), "first.last+news@googlemail.com");
+    EXPECT_EQ(plain.canonicalize("Someone@Example.org"), "someone@example.org");
+
+    EmailCanonicalizerOptions options;
+    options.providerRules = true;
+    EmailCanonicalizer providers(options);
+    EXPECT_EQ(providers.canonicalize("First.Last+news@GoogleMail.com"), "firstlast@gmail.com");
+    EXPECT_EQ(providers.canonicalize("f.i.r.s.t.last@gmail.com"), "firstlast@gmail.com");
+    EXPECT_EQ(providers.canonicalize("someone+tag@outlook.com"), "someone@outlook.com");
+    EXPECT_EQ(providers.canonicalize("some.one+tag@example.org"), "some.one+tag@example.org");
+
+    options.foldLocalPart = false;
+    EmailCanonicalizer caseSensitive(options);
+    EXPECT_EQ(caseSensitive.canonicalize("Some.One@EXAMPLE.org"), "Some.One@example.org");
+
+    // The hash is persisted, so pin its value as well as its consistency
+    EXPECT_NE(EmailCanonicalizer::hash("firstlast@gmail.com"), EmailCanonicalizer::hash("firstlast@gmail.co"));
+    EXPECT_EQ(EmailCanonicalizer::hash("firstlast@gmail.com"), 0xa302cb4e51c84ae6ULL);
+}
+
+TEST(PasswordPolicyTest, ShouldReportEveryViolation) {
+    PasswordPolicyOptions options;
+    options.minLength = 12;
+    options.forbiddenSubstrings = {"acme", "password"};
+    options.dictionary = {"Summer2024!Summer"};
+    PasswordPolicy policy(options);
+
+    auto violations = policy.check("acme");
+    std::vector<PolicyViolation> expected = {
+        PolicyViolation::TooShort,
+        PolicyViolation::MissingUppercase,
+        PolicyViolation::MissingDigit,
+        PolicyViolation::MissingSpecial,
+        PolicyViolation::ForbiddenSubstring
+    };
+    EXPECT_EQ(violations, expected);
+
+    EXPECT_TRUE(policy.check("Correct-Horse-42").empty());
+    EXPECT_EQ(policy.check("My-PassWord-42x").size(), 1u);
+    EXPECT_EQ(policy.check("summer2024!SUMMER"), std::vector<PolicyViolation>{PolicyViolation::DictionaryWord});
+    EXPECT_EQ(
+        policy.check("Jane.Doe-2024!", "jane.doe@example.com"),
+        std::vector<PolicyViolation>{PolicyViolation::ContainsEmail}
+    );
+    EXPECT_TRUE(policy.check("Correct-Horse-42", "jo@example.com").empty());
+
+    try {
+        policy.validate("acme");
+        FAIL() << "expected ValidationError";
+    } catch (const ValidationError& e) {
+        EXPECT_NE(std::string(e.what()).find("at least 12 characters"), std::string::npos);
+        EXPECT_NE(std::string(e.what()).find("special character"), std::string::npos);
+    }
+
+    // The built-in rules behind PasswordValidator are unchanged
+    EXPECT_THROW(PasswordValidator::validate("weak"), ValidationError);
+    EXPECT_NO_THROW(PasswordValidator::validate("SecurePass123!"));
+}
+
+TEST(PasswordPolicyTest, ShouldMatchNaiveSubstringSearch) {
+    // Overlapping and nested patterns exercise the automaton's failure links
+    PasswordPolicyOptions options;
+    options.forbiddenSubstrings = {"abab", "bac", "aa", "cab", "Ba1"};
+    PasswordPolicy policy(options);
+
+    std::mt19937 rng(99);
+    const std::string alphabet = "abcAB1";
+    for (int i = 0; i < 20000; ++i) {
+        std::string password(rng() % 10, 'x');
+        for (auto& c : password) {
+            c = alphabet[rng() % alphabet.size()];
+        }
+
+        std::string folded = password;
+        std::transform(folded.begin(), folded.end(), folded.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+        bool expected = false;
+        for (const auto& pattern : {"abab", "bac", "aa", "cab", "ba1"}) {
+            expected |= folded.find(pattern) != std::string::npos;
+        }
+
+        auto violations = policy.check(password);
+        bool flagged = std::find(violations.begin(), violations.end(), PolicyViolation::ForbiddenSubstring)
+            != violations.end();
+        ASSERT_EQ(flagged, expected) << password;
+    }
+}
+
+TEST(BreachedPasswordIndexTest, ShouldFindBreachedPasswords) {
+    const std::string dumpPath = "authlib_test_breached.txt";
+    const std::string indexPath = "authlib_test_breached.bpi";
+
+    // Known SHA-1s plus random filler so buckets need real searching
+    std::vector<std::string> lines = {
+        "5BAA61E4C9B93F3F0682250B6CF8331B7EE68FD8:9545824", // password
+        "7C4A8D09CA3762AF61E59520943DC26494F8941B:37359195", // 123456
+        "076D3E6C4B9F654B5B220B9045B7458AB6B4CBC6:12"        // P@ssw0rd!
+    };
+    std::mt19937_64 rng(42);
+    for (int i = 0; i < 200000; ++i) {
+        char hex[41];
+        std::snprintf(hex, sizeof(hex), "%016llX%016llX%08X",
+            static_cast<unsigned long long>(rng()), static_cast<unsigned long long>(rng()),
+            static_cast<unsigned>(rng()));
+        lines.push_back(std::string(hex) + ":1");
+    }
+    std::sort(lines.begin(), lines.end());
+    {
+        std::ofstream dump(dumpPath);
+        for (const auto& line : lines) {
+            dump << line << "\r\n";
+        }
+    }
+
+    for (uint32_t bloomBits : {0u, 10u}) {
+        auto stats = BreachedPasswordIndex::build(dumpPath, indexPath, bloomBits);
+        EXPECT_EQ(stats.entries, lines.size());
+
+        BreachedPasswordIndex index(indexPath);
+        EXPECT_EQ(index.size(), lines.size());
+        EXPECT_EQ(index.hasBloomFilter(), bloomBits > 0);
+        EXPECT_TRUE(index.contains("password"));
+        EXPECT_TRUE(index.contains("123456"));
+        EXPECT_FALSE(index.contains("qwerty"));
+        EXPECT_FALSE(index.contains("SecurePass123!"));
+
+        EXPECT_THROW(PasswordValidator::validate("P@ssw0rd!", &index), ValidationError);
+        EXPECT_NO_THROW(PasswordValidator::validate("SecurePass123!", &index));
+        EXPECT_NO_THROW(PasswordValidator::validate("P@ssw0rd!", nullptr));
+    }
+
+    // Dumps must be ordered by hash, and garbage files are rejected
+    std::swap(lines.front(), lines.back());
+    {
+        std::ofstream dump(dumpPath);
+        for (const auto& line : lines) {
+            dump << line << "\n";
+        }
+    }
+    EXPECT_THROW(BreachedPasswordIndex::build(dumpPath, indexPath), std::runtime_error);
+    EXPECT_THROW(BreachedPasswordIndex index(dumpPath), std::runtime_error);
+    EXPECT_THROW(BreachedPasswordIndex index("missing.bpi"), std::runtime_error);
+
+    std::remove(dumpPath.c_str());
+    std::remove(indexPath.c_str());
+}
+
+// ==================== Password Hashing Tests ====================
+
+TEST(PasswordHandlerTest, ShouldProduceSelfDescribingHash) {
+    PasswordHandler handler(12000);
+    std::string hash = handler.hashPassword("SecurePass123!");
+
+    EXPECT_EQ(hash.rfind("$pbkdf2-sha256$i=12000$", 0), 0u);
+    EXPECT_TRUE(handler.verifyPassword("SecurePass123!", hash));
+    EXPECT_FALSE(handler.verifyPassword("WrongPassword123!", hash));
+}
+
+TEST(PasswordHandlerTest, ShouldVerifyWithStoredParameters) {
+    std::string hash = PasswordHandler(11000).hashPassword("SecurePass123!");
+
+    // Verification uses the cost embedded in the hash, not the current policy
+    PasswordHandler current(20000);
+    EXPECT_TRUE(current.verifyPassword("SecurePass123!", hash));
+    EXPECT_TRUE(current.needsRehashing(hash));
+    EXPECT_FALSE(PasswordHandler(11000).needsRehashing(hash));
+}
+
+TEST(PasswordHandlerTest, ShouldRejectMalformedHashes) {
+    PasswordHandler handler;
+
+    EXPECT_FALSE(handler.verifyPassword("SecurePass123!", ""));
+    EXPECT_FALSE(handler.verifyPassword("SecurePass123!", "deadbeef"));
+    EXPECT_FALSE(handler.verifyPassword("SecurePass123!", "$pbkdf2-sha256$i=0$AAAA$AAAA"));
+    EXPECT_FALSE(handler.verifyPassword("SecurePass123!", "$bcrypt$i=10$AAAA$AAAA"));
+    EXPECT_TRUE(handler.needsRehashing("deadbeef"));
+}
+
+TEST(PasswordHandlerTest, ShouldHashWithArgon2id) {
+    if (!PasswordHandler::isAlgorithmAvailable(PasswordAlgorithm::Argon2id)) {
+        GTEST_SKIP() << "built without libargon2";
+    }
+
+    PasswordHashParams params;
+    params.algorithm = PasswordAlgorithm::Argon2id;
+    params.memoryKiB = 4096;
+    params.timeCost = 2;
+    params.parallelism = 1;
+    PasswordHandler handler(params);
+
+    std::string hash = handler.hashPassword("SecurePass123!");
+    EXPECT_EQ(hash.rfind("$argon2id$v=19$m=4096,t=2,p=1$", 0), 0u);
+    EXPECT_TRUE(handler.verifyPassword("SecurePass123!", hash));
+    EXPECT_FALSE(handler.verifyPassword("WrongPassword123!", hash));
+    EXPECT_FALSE(handler.needsRehashing(hash));
+
+    // Scratch memory is reused across hashes on the same thread
+    EXPECT_TRUE(handler.verifyPassword("SecurePass123!", hash));
+    PasswordHandler::releaseScratchMemory();
+
+    // Existing PBKDF2 hashes still verify but are flagged for upgrade
+    std::string legacy = PasswordHandler().hashPassword("SecurePass123!");
+    EXPECT_TRUE(handler.verifyPassword("SecurePass123!", legacy));
+    EXPECT_TRUE(handler.needsRehashing(legacy));
+}
+
+TEST(PasswordHandlerTest, ShouldBatchHashToVerifiableHashes) {
+    PasswordHandler handler(10000);
+
+    // Odd count and lengths either side of the 64-byte HMAC block size
+    // exercise partially filled lanes and long-key pre-hashing
+    std::vector<std::string> passwords;
+    for (size_t i = 0; i < 19; ++i) {
+        passwords.push_back(std::string(i * 7, 'a' + static_cast<char>(i)) + "Pass1!");
+    }
+
+    std::vector<std::string> hashes = handler.hashPasswordBatch(passwords);
+    ASSERT_EQ(hashes.size(), passwords.size());
+    for (size_t i = 0; i < passwords.size(); ++i) {
+        EXPECT_EQ(hashes[i].rfind("$pbkdf2-sha256$i=10000$", 0), 0u) << PasswordHandler::batchBackend();
+        EXPECT_TRUE(handler.verifyPassword(passwords[i], hashes[i])) << PasswordHandler::batchBackend();
+        EXPECT_FALSE(handler.verifyPassword(passwords[(i + 1) % passwords.size()], hashes[i]));
+    }
+    EXPECT_TRUE(handler.hashPasswordBatch({}).empty());
+
+    // Every kernel this CPU runs must match the scalar OpenSSL path bit for
+    // bit, not only the one selected at startup
+    std::vector<detail::Pbkdf2KernelInfo> kernels = detail::pbkdf2SupportedKernels();
+    ASSERT_STREQ(kernels.back().name, "openssl");
+    const detail::Pbkdf2KernelInfo& scalar = kernels.back();
+
+    const unsigned char salt[16] = {0x5a, 0x17, 0x00, 0xff, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    for (uint32_t iterations : {1u, 2u, 1000u}) {
+        std::vector<std::array<unsigned char, 32>> expected(passwords.size());
+        std::vector<detail::Pbkdf2Job> jobs;
+        for (size_t i = 0; i < passwords.size(); ++i) {
+            jobs.push_back({&passwords[i], salt, sizeof(salt), expected[i].data()});
+        }
+        detail::pbkdf2Sha256Batch(scalar, jobs.data(), jobs.size(), iterations);
+
+        for (const auto& kernel : kernels) {
+            std::vector<std::array<unsigned char, 32>> actual(passwords.size());
+            for (size_t i = 0; i < jobs.size(); ++i) {
+                jobs[i].out = actual[i].data();
+            }
+            detail::pbkdf2Sha256Batch(kernel, jobs.data(), jobs.size(), iterations);
+            for (size_t i = 0; i < passwords.size(); ++i) {
+                EXPECT_EQ(actual[i], expected[i]) << kernel.name << " i=" << iterations << " password " << i;
+            }
+        }
+    }
+}
+
+TEST(PasswordHandlerTest, ShouldCalibrateAboveFloor) {
+    uint32_t iterations = PasswordHandler::calibrateIterations(std::chrono::milliseconds(5), 15000);
+    EXPECT_GE(iterations, 15000u);
+    EXPECT_EQ(iterations % 1000, 0u);
+}
+
+// ==================== Password Hash Pool Tests ====================
+
+TEST(PasswordHashPoolTest, ShouldHashOffTheCallingThread) {
+    PasswordHashPool pool(2, 8);
+
+    auto first = pool.hashAsync("SecurePass123!");
+    auto second = pool.hashAsync("SecurePass123!");
+
+    std::string hash = first.get();
+    EXPECT_FALSE(second.get().empty());
+    EXPECT_TRUE(pool.verifyAsync("SecurePass123!", hash).get());
+
+    // Counters are published after the result; drain the workers first
+    pool.shutdown();
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.workers, 2u);
+    EXPECT_EQ(stats.submitted, 3u);
+    EXPECT_EQ(stats.completed, 3u);
+    EXPECT_EQ(stats.rejected, 0u);
+    EXPECT_EQ(stats.queueDepth, 0u);
+}
+
+TEST(PasswordHashPoolTest, ShouldRejectWhenQueueIsFull) {
+    PasswordHashPool pool(1, 1);
+
+    std::promise<void> started;
+    std::promise<void> release;
+    auto releaseSignal = release.get_future().share();
+
+    // Park the only worker inside a callback so the queue cannot drain
+    pool.hashAsync("SecurePass123!", [&](std::string, std::exception_ptr) {
+        started.set_value();
+        releaseSignal.wait();
+    });
+    started.get_future().wait();
+
+    auto queued = pool.hashAsync("SecurePass123!");
+    EXPECT_THROW(pool.hashAsync("SecurePass123!"), HashQueueFull);
+    EXPECT_EQ(pool.stats().queueDepth, 1u);
+    EXPECT_EQ(pool.stats().rejected, 1u);
+
+    release.set_value();
+    EXPECT_FALSE(queued.get().empty());
+}
+
+// ==================== Secure Random Tests ====================
+
+TEST(SecureRandomTest, ShouldProduceDistinctValuesAcrossThreads) {
+    std::set<std::string> tokens;
+    std::mutex tokensMutex;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 500; ++i) {
+                std::string token = SecureRandom::token(16);
+                std::lock_guard<std::mutex> lock(tokensMutex);
+                tokens.insert(token);
+            }
+            SecureRandom::releaseThreadBuffer();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(tokens.size(), 2000u);
+    EXPECT_EQ(SecureRandom::token(32).size(), 43u);
+    EXPECT_EQ(SecureRandom::token(32).find_first_of("+/="), std::string::npos);
+    EXPECT_EQ(SecureRandom::hex(8).size(), 16u);
+    EXPECT_EQ(SecureRandom::bytes(1000).size(), 1000u);
+
+    // Salts come from the same source, so equal passwords hash differently
+    PasswordHandler handler;
+    EXPECT_NE(handler.hashPassword("SecurePass123!"), handler.hashPassword("SecurePass123!"));
+}
+
+#ifndef _WIN32
+TEST(SecureRandomTest, ShouldNotReplayBufferedBytesAfterFork) {
+    SecureRandom::nextU64(); // make sure this thread's buffer is filled
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+        uint64_t value = SecureRandom::nextU64();
+        ssize_t written = write(fds[1], &value, sizeof(value));
+        _exit(written == static_cast<ssize_t>(sizeof(value)) ? 0 : 1);
+    }
+
+    uint64_t parentValue = SecureRandom::nextU64();
+    uint64_t childValue = 0;
+    ASSERT_EQ(read(fds[0], &childValue, sizeof(childValue)), static_cast<ssize_t>(sizeof(childValue)));
+    int status = 0;
+    waitpid(pid, &status, 0);
+    close(fds[0]);
+    close(fds[1]);
+
+    EXPECT_NE(parentValue, childValue);
+}
+#endif
@@ -0,0 +1,85 @@
+/**
+ * authd: AuthService over HTTP
+ *
+ *   authd
+ *
+ * Settings come from the usual layering (defaults, AUTHLIB_CONFIG_FILE,
+ * environment); HTTP_* control the listener. SIGHUP reloads the
+ * configuration, rotating JWT keys with the usual grace window; SIGINT
+ * and SIGTERM shut down. HTTP_TRACE_FILE, if set, receives a Chrome
+ * trace of every request's phases until shutdown.
+ */
+
+#include <authlib/config/ConfigStore.h>
+#include <authlib/database/Database.h>
+#include <authlib/observability/Tracing.h>
+#include <authlib/server/HttpServer.h>
+#include <authlib/services/AuthService.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <csignal>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+int main() {
+    using namespace authlib;
+
+    try {
+        auto configStore = std::make_shared<ConfigStore>();
+        auto config = configStore->snapshot();
+        if (config->isProductionMode()) {
+            config->validate();
+        }
+
+        Database database(config->DATABASE_URL, 5000, config->DATABASE_SHARDS);
+        database.setProfiling(DatabaseProfileOptions::fromConfig(*config));
+        database.initialize();
+        AuthService authService(database, configStore);
+
+        if (!config->HTTP_TRACE_FILE.empty()) {
+            Tracing::setSink(std::make_shared<ChromeTraceWriter>(config->HTTP_TRACE_FILE));
+        }
+
+        HttpServerOptions options = HttpServerOptions::fromConfig(*config);
+        HttpServer server(authService, options);
+        server.start();
+        std::cout << "authd listening on " << options.address << ":" << server.port() << std::endl;
+
+        boost::asio::io_context signals;
+        boost::asio::signal_set set(signals, SIGINT, SIGTERM);
+#ifdef SIGHUP
+        set.add(SIGHUP);
+#endif
+        std::function<void(const boost::system::error_code&, int)> onSignal =
+            [&](const boost::system::error_code& ec, int signal) {
+                if (ec) {
+                    return;
+                }
+#ifdef SIGHUP
+                if (signal == SIGHUP) {
+                    try {
+                        configStore->reload();
+                        std::cout << "authd: configuration reloaded" << std::endl;
+                    } catch (const std::exception& e) {
+                        std::cerr << "authd: reload failed, keeping current settings: " << e.what() << std::endl;
+                    }
+                    set.async_wait(onSignal);
+                    return;
+                }
+#endif
+                (void)signal;
+                std::cout << "authd: shutting down" << std::endl;
+                server.stop();
+            };
+        set.async_wait(onSignal);
+        signals.run();
+        // Drop the writer so it closes the trace's JSON array
+        Tracing::setSink(nullptr);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "authd: " << e.what() << std::endl;
+        return 1;
+    }
+}
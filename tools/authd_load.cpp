@@ -0,0 +1,229 @@
+/**
+ * Closed-loop load test for a running authd
+ *
+ *   authd_load [--host 127.0.0.1] [--port 8080] [--connections 16] [--seconds 5]
+ *
+ * Each endpoint in turn is driven by `connections` keep-alive clients,
+ * one thread each, sending the next request as soon as the previous
+ * response arrives. Prints requests per second and latency percentiles
+ * per endpoint. Logout is left out: every call consumes a token pair.
+ */
+
+#include <boost/asio/connect.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using tcp = asio::ip::tcp;
+using json = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+const char* const PASSWORD = "LoadTest123!";
+
+struct Options {
+    std::string host = "127.0.0.1";
+    std::string port = "8080";
+    int connections = 16;
+    int seconds = 5;
+};
+
+class Client {
+public:
+    explicit Client(const Options& options) : stream(context), host(options.host) {
+        tcp::resolver resolver(context);
+        stream.connect(resolver.resolve(options.host, options.port));
+        stream.socket().set_option(tcp::no_delay(true));
+    }
+
+    http::response<http::string_body> send(
+        http::verb method,
+        const char* target,
+        const json& body = nullptr,
+        const std::string& bearer = ""
+    ) {
+        http::request<http::string_body> request(method, target, 11);
+        request.set(http::field::host, host);
+        request.keep_alive(true);
+        if (!bearer.empty()) {
+            request.set(http::field::authorization, "Bearer " + bearer);
+        }
+        if (!body.is_null()) {
+            request.set(http::field::content_type, "application/json");
+            request.body() = body.dump();
+        }
+        request.prepare_payload();
+        http::write(stream, request);
+
+        http::response<http::string_body> response;
+        http::read(stream, buffer, response);
+        return response;
+    }
+
+private:
+    asio::io_context context;
+    beast::tcp_stream stream;
+    beast::flat_buffer buffer;
+    std::string host;
+};
+
+struct Tokens {
+    std::string accessToken;
+    std::string refreshToken;
+};
+
+std::string uniqueEmail(const std::string& tag) {
+    return "load-" + std::to_string(::getpid()) + "-" + tag + "@example.com";
+}
+
+json credentials(const std::string& email) {
+    return json{{"email", email}, {"password", PASSWORD}, {"firstName", "Load"}, {"lastName", "Test"}};
+}
+
+Tokens setUp(const Options& options, const std::string& email) {
+    Client client(options);
+    auto response = client.send(http::verb::post, "/auth/register", credentials(email));
+    if (response.result() != http::status::created) {
+        throw std::runtime_error("register failed: " + std::to_string(response.result_int()) + " " + response.body());
+    }
+    json body = json::parse(response.body());
+    return {body["accessToken"].get<std::string>(), body["refreshToken"].get<std::string>()};
+}
+
+using Step = http::response<http::string_body> (*)(Client&, const Tokens&, const std::string&, int, uint64_t);
+
+http::response<http::string_body> registerStep(Client& client, const Tokens&, const std::string&, int thread, uint64_t n) {
+    return client.send(
+        http::verb::post, "/auth/register",
+        credentials(uniqueEmail(std::to_string(thread) + "-" + std::to_string(n)))
+    );
+}
+
+http::response<http::string_body> loginStep(Client& client, const Tokens&, const std::string& email, int, uint64_t) {
+    return client.send(http::verb::post, "/auth/login", json{{"email", email}, {"password", PASSWORD}});
+}
+
+http::response<http::string_body> verifyStep(Client& client, const Tokens& tokens, const std::string&, int, uint64_t) {
+    return client.send(http::verb::get, "/auth/verify", nullptr, tokens.accessToken);
+}
+
+http::response<http::string_body> refreshStep(Client& client, const Tokens& tokens, const std::string&, int, uint64_t) {
+    return client.send(http::verb::post, "/auth/refresh", json{{"refreshToken", tokens.refreshToken}});
+}
+
+void run(const Options& options, const char* name, Step step, const Tokens& tokens, const std::string& email) {
+    std::vector<std::vector<uint32_t>> latencies(options.connections); // microseconds, per thread
+    std::atomic<uint64_t> errors{0};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back([&, i]() {
+            try {
+                Client client(options);
+                for (uint64_t n = 0; !stop.load(std::memory_order_relaxed); ++n) {
+                    auto sent = Clock::now();
+                    auto response = step(client, tokens, email, i, n);
+                    latencies[i].push_back(static_cast<uint32_t>(
+                        std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - sent).count()
+                    ));
+                    if (response.result_int() >= 300) {
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            } catch (const std::exception& e) {
+                std::cerr << name << ": connection " << i << ": " << e.what() << std::endl;
+                errors.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(options.seconds));
+    stop = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<uint32_t> all;
+    for (const auto& each : latencies) {
+        all.insert(all.end(), each.begin(), each.end());
+    }
+    std::sort(all.begin(), all.end());
+    auto percentile = [&](double p) {
+        return all.empty() ? 0.0 : all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))] / 1000.0;
+    };
+
+    std::printf(
+        "%-10s %10zu %8llu %12.0f %10.2f %10.2f %10.2f\n",
+        name,
+        all.size(),
+        static_cast<unsigned long long>(errors.load()),
+        all.size() / elapsed,
+        percentile(0.50),
+        percentile(0.99),
+        all.empty() ? 0.0 : all.back() / 1000.0
+    );
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "usage: " << argv[0]
+                      << " [--host 127.0.0.1] [--port 8080] [--connections 16] [--seconds 5]" << std::endl;
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--host") {
+            options.host = value;
+        } else if (arg == "--port") {
+            options.port = value;
+        } else if (arg == "--connections") {
+            options.connections = std::max(1, std::stoi(value));
+        } else if (arg == "--seconds") {
+            options.seconds = std::max(1, std::stoi(value));
+        } else {
+            std::cerr << "unknown option " << arg << std::endl;
+            return 2;
+        }
+    }
+
+    try {
+        const std::string email = uniqueEmail("main");
+        Tokens tokens = setUp(options, email);
+
+        std::printf("%d connections, %d s per endpoint\n", options.connections, options.seconds);
+        std::printf("%-10s %10s %8s %12s %10s %10s %10s\n", "endpoint", "requests", "errors", "req/s", "p50 ms", "p99 ms", "max ms");
+        run(options, "register", registerStep, tokens, email);
+        run(options, "login", loginStep, tokens, email);
+        run(options, "verify", verifyStep, tokens, email);
+        run(options, "refresh", refreshStep, tokens, email);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+}
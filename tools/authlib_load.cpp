@@ -0,0 +1,412 @@
+/**
+ * In-process workload driver for AuthService
+ *
+ *   authlib_load [--users 1000] [--threads 8] [--seconds 10] [--rate 0]
+ *                [--mix register=1,login=4,verify=80,refresh=10,logout=5]
+ *                [--database sqlite:///./authlib_load.db] [--shards 1] [--profile 0]
+ *
+ * Seeds `users` accounts, then `threads` threads share one AuthService and
+ * pick operations at random in proportion to the mix weights. With
+ * --rate 0 each thread runs closed-loop, issuing the next operation as
+ * soon as the last returns. With --rate R the threads together start R
+ * operations per second on a fixed schedule (open-loop), and latency is
+ * counted from when an operation was due, not when a backed-up thread got
+ * to it, so queueing shows up in the tail instead of being hidden.
+ *
+ * Prints throughput and p50/p99/p99.9/max latency per operation, CPU use,
+ * and the library's own phase histograms (Metrics) for the run. Password
+ * hashing follows the usual settings (PASSWORD_HASH_*); the database file
+ * is recreated on every run. --profile 1 adds the per-statement SQLite
+ * profile (Database::setProfiling), seeding included.
+ */
+
+#include <authlib/config/Config.h>
+#include <authlib/database/Database.h>
+#include <authlib/observability/Metrics.h>
+#include <authlib/services/AuthService.h>
+#include <authlib/utils/exceptions.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/resource.h>
+
+namespace {
+
+using namespace authlib;
+using Clock = std::chrono::steady_clock;
+
+const char* const PASSWORD = "LoadTest123!";
+
+enum Operation { REGISTER, LOGIN, VERIFY, REFRESH, LOGOUT, OPERATIONS };
+const char* const OPERATION_NAMES[OPERATIONS] = {"register", "login", "verify", "refresh", "logout"};
+
+struct Options {
+    uint32_t users = 1000;
+    uint32_t threads = std::max(1u, std::thread::hardware_concurrency());
+    uint32_t seconds = 10;
+    double rate = 0; // operations per second across all threads, 0 = closed-loop
+    uint32_t mix[OPERATIONS] = {1, 4, 80, 10, 5};
+    std::string database = "sqlite:///./authlib_load.db";
+    uint32_t shards = 1;
+    bool profile = false;
+};
+
+struct Account {
+    std::string email;
+    std::string accessToken;
+    std::string refreshToken;
+};
+
+struct ThreadResult {
+    std::vector<uint64_t> latencies[OPERATIONS]; // nanoseconds
+    uint64_t errors[OPERATIONS] = {};
+};
+
+std::string emailFor(const std::string& tag) {
+    return "load-" + tag + "@example.com";
+}
+
+// "register=1,login=4" -> weights; names left out keep their default
+bool parseMix(const std::string& text, uint32_t* mix) {
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) {
+            return false;
+        }
+        std::string name = item.substr(0, eq);
+        auto it = std::find_if(std::begin(OPERATION_NAMES), std::end(OPERATION_NAMES),
+            [&](const char* each) { return name == each; });
+        if (it == std::end(OPERATION_NAMES)) {
+            return false;
+        }
+        mix[it - std::begin(OPERATION_NAMES)] = static_cast<uint32_t>(std::stoul(item.substr(eq + 1)));
+    }
+    return true;
+}
+
+// Files behind a sqlite:/// URL, named as Database names its shards
+std::vector<std::string> databaseFiles(const Options& options) {
+    const std::string scheme = "sqlite:///";
+    if (options.database.compare(0, scheme.size(), scheme) != 0 || options.database.size() == scheme.size()) {
+        return {}; // in-memory
+    }
+    const std::string path = options.database.substr(scheme.size());
+    if (options.shards == 1) {
+        return {path};
+    }
+    std::vector<std::string> files;
+    size_t dot = path.find_last_of('.');
+    for (uint32_t shard = 0; shard < options.shards; ++shard) {
+        files.push_back(dot == std::string::npos
+            ? path + ".shard" + std::to_string(shard)
+            : path.substr(0, dot) + ".shard" + std::to_string(shard) + path.substr(dot));
+    }
+    return files;
+}
+
+void removeDatabaseFiles(const Options& options) {
+    for (const auto& file : databaseFiles(options)) {
+        for (const char* suffix : {"", "-wal", "-shm"}) {
+            std::remove((file + suffix).c_str());
+        }
+    }
+}
+
+// Register the seed accounts in parallel; hashing dominates
+std::vector<Account> seed(AuthService& auth, const Options& options) {
+    std::vector<Account> accounts(options.users);
+    std::atomic<uint32_t> next{0};
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < options.threads; ++t) {
+        threads.emplace_back([&]() {
+            for (uint32_t i = next++; i < options.users; i = next++) {
+                Account& account = accounts[i];
+                account.email = emailFor("seed-" + std::to_string(i));
+                AuthResponse response = auth.registerUser({account.email, PASSWORD, "Load", "Test"});
+                account.accessToken = std::move(response.accessToken);
+                account.refreshToken = std::move(response.refreshToken);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return accounts;
+}
+
+// `fresh` is a pair of this thread's own, for logout to revoke
+void runOperation(
+    AuthService& auth,
+    Operation operation,
+    const Account& account,
+    const Account& fresh,
+    uint32_t thread,
+    uint64_t n
+) {
+    switch (operation) {
+        case REGISTER:
+            auth.registerUser({emailFor(std::to_string(thread) + "-" + std::to_string(n)), PASSWORD, "Load", "Test"});
+            break;
+        case LOGIN:
+            auth.login({account.email, PASSWORD});
+            break;
+        case VERIFY:
+            auth.verifyToken(account.accessToken);
+            break;
+        case REFRESH:
+            auth.refreshAccessToken(account.refreshToken);
+            break;
+        case LOGOUT:
+            auth.logout(fresh.accessToken, fresh.refreshToken);
+            break;
+        default:
+            break;
+    }
+}
+
+void worker(
+    AuthService& auth,
+    const Options& options,
+    const std::vector<Account>& accounts,
+    uint32_t index,
+    Clock::time_point start,
+    Clock::time_point end,
+    ThreadResult& result
+) {
+    std::mt19937_64 random(0x9e3779b97f4a7c15ull * (index + 1));
+    std::discrete_distribution<int> pick(std::begin(options.mix), std::end(options.mix));
+    std::uniform_int_distribution<size_t> anyAccount(0, accounts.size() - 1);
+
+    // Open-loop: this thread owns every threads-th slot of the global schedule
+    const bool openLoop = options.rate > 0;
+    const auto interval = openLoop
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.threads / options.rate))
+        : Clock::duration::zero();
+    Clock::time_point due = start + interval * index / options.threads;
+
+    for (uint64_t n = 0;; ++n) {
+        if (openLoop) {
+            if (due >= end) {
+                break;
+            }
+            std::this_thread::sleep_until(due);
+        } else if (Clock::now() >= end) {
+            break;
+        }
+
+        Operation operation = static_cast<Operation>(pick(random));
+        const Account& account = accounts[anyAccount(random)];
+
+        // Logout revokes the pair it is given, so it gets a fresh pair from
+        // an untimed login rather than spending a shared seed account's.
+        // Open-loop, that login still delays the logout past its due time.
+        Account fresh;
+        if (operation == LOGOUT) {
+            try {
+                AuthResponse login = auth.login({account.email, PASSWORD});
+                fresh.accessToken = std::move(login.accessToken);
+                fresh.refreshToken = std::move(login.refreshToken);
+            } catch (const std::exception&) {
+                ++result.errors[LOGOUT];
+                due += interval;
+                continue;
+            }
+        }
+
+        Clock::time_point began = openLoop ? due : Clock::now();
+        try {
+            runOperation(auth, operation, account, fresh, index, n);
+        } catch (const std::exception&) {
+            ++result.errors[operation];
+        }
+        result.latencies[operation].push_back(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - began).count()));
+        due += interval;
+    }
+}
+
+double cpuSeconds() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+        + static_cast<double>(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+double percentileMicros(const std::vector<uint64_t>& sorted, double q) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[index]) / 1000.0;
+}
+
+void usage(const char* program) {
+    std::cerr << "usage: " << program
+              << " [--users 1000] [--threads N] [--seconds 10] [--rate 0]"
+                 " [--mix register=1,login=4,verify=80,refresh=10,logout=5]"
+                 " [--database sqlite:///./authlib_load.db] [--shards 1] [--profile 0]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        std::string value = argv[++i];
+        try {
+            if (arg == "--users") {
+                options.users = std::max(1ul, std::stoul(value));
+            } else if (arg == "--threads") {
+                options.threads = std::max(1ul, std::stoul(value));
+            } else if (arg == "--seconds") {
+                options.seconds = std::max(1ul, std::stoul(value));
+            } else if (arg == "--rate") {
+                options.rate = std::max(0.0, std::stod(value));
+            } else if (arg == "--mix") {
+                if (!parseMix(value, options.mix)) {
+                    std::cerr << "bad --mix " << value << std::endl;
+                    return 2;
+                }
+            } else if (arg == "--database") {
+                options.database = value;
+            } else if (arg == "--shards") {
+                options.shards = std::max(1ul, std::stoul(value));
+            } else if (arg == "--profile") {
+                options.profile = std::stoul(value) != 0;
+            } else {
+                std::cerr << "unknown option " << arg << std::endl;
+                return 2;
+            }
+        } catch (const std::exception&) {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (std::all_of(std::begin(options.mix), std::end(options.mix), [](uint32_t w) { return w == 0; })) {
+        std::cerr << "--mix has no nonzero weight" << std::endl;
+        return 2;
+    }
+
+    try {
+        removeDatabaseFiles(options);
+        Config config;
+        Database database(options.database, 5000, options.shards);
+        if (options.profile) {
+            DatabaseProfileOptions profiling;
+            profiling.enabled = true;
+            database.setProfiling(profiling);
+        }
+        database.initialize();
+        AuthService auth(database, config);
+
+        auto seedStart = Clock::now();
+        std::vector<Account> accounts = seed(auth, options);
+        std::printf("seeded %u users in %.1f s\n", options.users,
+            std::chrono::duration<double>(Clock::now() - seedStart).count());
+
+        Metrics::reset();
+        std::vector<ThreadResult> results(options.threads);
+        std::vector<std::thread> threads;
+        const double cpuBefore = cpuSeconds();
+        const auto start = Clock::now() + std::chrono::milliseconds(10);
+        const auto end = start + std::chrono::seconds(options.seconds);
+        for (uint32_t t = 0; t < options.threads; ++t) {
+            threads.emplace_back(worker, std::ref(auth), std::cref(options), std::cref(accounts), t, start, end, std::ref(results[t]));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        const double cpu = cpuSeconds() - cpuBefore;
+
+        if (options.rate > 0) {
+            std::printf("%u threads, open-loop at %.0f ops/s, %u s\n", options.threads, options.rate, options.seconds);
+        } else {
+            std::printf("%u threads, closed-loop, %u s\n", options.threads, options.seconds);
+        }
+        std::printf("%-10s %10s %8s %10s %10s %10s %10s %10s\n",
+            "operation", "count", "errors", "ops/s", "p50 us", "p99 us", "p99.9 us", "max us");
+        uint64_t total = 0;
+        uint64_t failed = 0;
+        for (int op = 0; op < OPERATIONS; ++op) {
+            std::vector<uint64_t> all;
+            uint64_t errors = 0;
+            for (auto& result : results) {
+                all.insert(all.end(), result.latencies[op].begin(), result.latencies[op].end());
+                errors += result.errors[op];
+            }
+            if (all.empty() && errors == 0) {
+                continue;
+            }
+            std::sort(all.begin(), all.end());
+            total += all.size();
+            failed += errors;
+            std::printf("%-10s %10zu %8llu %10.0f %10.1f %10.1f %10.1f %10.1f\n",
+                OPERATION_NAMES[op],
+                all.size(),
+                static_cast<unsigned long long>(errors),
+                static_cast<double>(all.size()) / elapsed,
+                percentileMicros(all, 0.50),
+                percentileMicros(all, 0.99),
+                percentileMicros(all, 0.999),
+                all.empty() ? 0.0 : static_cast<double>(all.back()) / 1000.0);
+        }
+        std::printf("total      %10llu %8llu %10.0f\n",
+            static_cast<unsigned long long>(total),
+            static_cast<unsigned long long>(failed),
+            static_cast<double>(total) / elapsed);
+        std::printf("cpu: %.2f cores busy of %u hardware threads\n",
+            cpu / elapsed, std::max(1u, std::thread::hardware_concurrency()));
+
+        // Where the time went inside the library, service time only
+        std::printf("\n%-12s %10s %10s %10s\n", "phase", "count", "p50 us", "p99 us");
+        for (size_t m = 0; m < static_cast<size_t>(Metric::COUNT); ++m) {
+            MetricSnapshot snapshot = Metrics::snapshot(static_cast<Metric>(m));
+            if (snapshot.count == 0) {
+                continue;
+            }
+            std::printf("%-12s %10llu %10.1f %10.1f\n",
+                Metrics::name(static_cast<Metric>(m)),
+                static_cast<unsigned long long>(snapshot.count),
+                static_cast<double>(snapshot.percentile(0.50)) / 1000.0,
+                static_cast<double>(snapshot.percentile(0.99)) / 1000.0);
+        }
+
+        if (options.profile) {
+            std::printf("\n%10s %10s %10s %10s %10s %12s  %s\n",
+                "total ms", "count", "p50 us", "p99 us", "rows", "scan steps", "statement");
+            for (const StatementProfile& statement : database.statementProfiles()) {
+                std::printf("%10.1f %10llu %10.1f %10.1f %10llu %12llu  %.60s\n",
+                    static_cast<double>(statement.latency.sumNanos) / 1e6,
+                    static_cast<unsigned long long>(statement.latency.count),
+                    static_cast<double>(statement.latency.percentile(0.50)) / 1000.0,
+                    static_cast<double>(statement.latency.percentile(0.99)) / 1000.0,
+                    static_cast<unsigned long long>(statement.rowsReturned),
+                    static_cast<unsigned long long>(statement.fullScanSteps),
+                    statement.sql.c_str());
+            }
+        }
+
+        removeDatabaseFiles(options);
+        return failed == 0 ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * Print the effective configuration, or why it fails to load
+ *
+ *   authlib_config [config.json] [--show-secrets]
+ *
+ * Applies the same layering as the library: defaults, then the file (or
+ * AUTHLIB_CONFIG_FILE when none is given), then environment variables.
+ */
+
+#include <authlib/config/Config.h>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    bool showSecrets = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--show-secrets") == 0) {
+            showSecrets = true;
+        } else if (!path) {
+            path = argv[i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [config.json] [--show-secrets]" << std::endl;
+            return 2;
+        }
+    }
+
+    try {
+        authlib::Config config = path ? authlib::Config(std::string(path)) : authlib::Config();
+        std::cout << config.toJson(showSecrets).dump(2) << std::endl;
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << std::endl;
+        return 1;
+    }
+}
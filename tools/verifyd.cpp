@@ -0,0 +1,73 @@
+/**
+ * authlib_verifyd: token verification sidecar on a Unix domain socket
+ *
+ *   authlib_verifyd
+ *
+ * Listens on VERIFY_SOCKET_PATH with VERIFY_THREADS workers; clients use
+ * the header-only authlib/sidecar/VerifyClient.h. SIGHUP reloads the
+ * configuration (JWT key rotation); SIGINT and SIGTERM shut down.
+ */
+
+#include <authlib/config/ConfigStore.h>
+#include <authlib/database/Database.h>
+#include <authlib/sidecar/VerifySidecar.h>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <csignal>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <memory>
+
+int main() {
+    using namespace authlib;
+
+    try {
+        auto configStore = std::make_shared<ConfigStore>();
+        auto config = configStore->snapshot();
+        if (config->isProductionMode()) {
+            config->validate();
+        }
+
+        Database database(config->DATABASE_URL, 5000, config->DATABASE_SHARDS);
+        database.setProfiling(DatabaseProfileOptions::fromConfig(*config));
+        database.initialize();
+
+        VerifySidecarOptions options = VerifySidecarOptions::fromConfig(*config);
+        VerifySidecar sidecar(database, configStore, options);
+        sidecar.start();
+        std::cout << "authlib_verifyd listening on " << options.socketPath << std::endl;
+
+        boost::asio::io_context signals;
+        boost::asio::signal_set set(signals, SIGINT, SIGTERM);
+#ifdef SIGHUP
+        set.add(SIGHUP);
+#endif
+        std::function<void(const boost::system::error_code&, int)> onSignal =
+            [&](const boost::system::error_code& ec, int signal) {
+                if (ec) {
+                    return;
+                }
+#ifdef SIGHUP
+                if (signal == SIGHUP) {
+                    try {
+                        configStore->reload();
+                        std::cout << "authlib_verifyd: configuration reloaded" << std::endl;
+                    } catch (const std::exception& e) {
+                        std::cerr << "authlib_verifyd: reload failed, keeping current settings: " << e.what() << std::endl;
+                    }
+                    set.async_wait(onSignal);
+                    return;
+                }
+#endif
+                (void)signal;
+                sidecar.stop();
+            };
+        set.async_wait(onSignal);
+        signals.run();
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "authlib_verifyd: " << e.what() << std::endl;
+        return 1;
+    }
+}